@@ -0,0 +1,76 @@
+/*
+    allocationCounter.cpp
+
+    Counting allocator: replaces the global operator new and delete, so
+    that every heap allocation through new, including those of the standard
+    containers and strings, is counted. The counters are relaxed atomics,
+    since only their totals are used. Aligned new is not replaced, and is
+    not counted.
+
+    Linked into srcfacts with the CMake option COUNT_ALLOCATIONS.
+*/
+
+#include "memoryUsage.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+    std::atomic<long> allocationCount = 0;
+    std::atomic<long> allocatedBytes = 0;
+
+    /*
+        Allocate and count
+
+        @param[in] size Bytes to allocate
+        @return Allocated memory
+    */
+    void* countedAllocate(std::size_t size) {
+
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(static_cast<long>(size), std::memory_order_relaxed);
+        // malloc(0) may return nullptr, but new must return a unique pointer
+        if (void* memory = std::malloc(size ? size : 1))
+            return memory;
+        throw std::bad_alloc();
+    }
+}
+
+/*
+    Counts of the heap allocations so far
+
+    @return Number of allocations and bytes allocated
+*/
+AllocationCounts allocationCounts() {
+
+    AllocationCounts counts;
+    counts.allocations = allocationCount.load(std::memory_order_relaxed);
+    counts.bytes = allocatedBytes.load(std::memory_order_relaxed);
+
+    return counts;
+}
+
+void* operator new(std::size_t size) {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return countedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
@@ -0,0 +1,130 @@
+/*
+    binaryIO.hpp
+
+    Reading and writing for the binary file formats: fixed-size
+    little-endian integers, length-prefixed strings, and Facts.
+*/
+
+#ifndef INCLUDED_BINARYIO_HPP
+#define INCLUDED_BINARYIO_HPP
+
+#include "facts.hpp"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+/*
+    Write an 8-byte little-endian integer
+
+    @param[in, out] out Output stream
+    @param[in] value Value to write
+*/
+inline void writeInteger(std::ostream& out, std::uint64_t value) {
+
+    char bytes[8];
+    for (int i = 0; i < 8; ++i)
+        bytes[i] = static_cast<char>(value >> (i * 8));
+    out.write(bytes, sizeof(bytes));
+}
+
+/*
+    Read an 8-byte little-endian integer
+
+    @param[in, out] in Input stream
+    @param[out] value Value read
+    @return Whether the value was read
+*/
+[[nodiscard]] inline bool readInteger(std::istream& in, std::uint64_t& value) {
+
+    unsigned char bytes[8];
+    if (!in.read(reinterpret_cast<char*>(bytes), sizeof(bytes)))
+        return false;
+    value = 0;
+    for (int i = 0; i < 8; ++i)
+        value |= std::uint64_t(bytes[i]) << (i * 8);
+
+    return true;
+}
+
+/*
+    Read an 8-byte little-endian signed integer
+
+    @param[in, out] in Input stream
+    @param[out] value Value read
+    @return Whether the value was read
+*/
+[[nodiscard]] inline bool readInteger(std::istream& in, long& value) {
+
+    std::uint64_t unsignedValue;
+    if (!readInteger(in, unsignedValue))
+        return false;
+    value = static_cast<long>(unsignedValue);
+
+    return true;
+}
+
+/*
+    Write a length-prefixed string
+
+    @param[in, out] out Output stream
+    @param[in] text String to write
+*/
+inline void writeString(std::ostream& out, std::string_view text) {
+
+    writeInteger(out, text.size());
+    out.write(text.data(), text.size());
+}
+
+/*
+    Read a length-prefixed string
+
+    @param[in, out] in Input stream
+    @param[out] text String read
+    @return Whether the string was read
+*/
+[[nodiscard]] inline bool readString(std::istream& in, std::string& text) {
+
+    std::uint64_t size;
+    // strings are names, filenames, and hashes, so anything longer is a corrupt file
+    if (!readInteger(in, size) || size > (1 << 20))
+        return false;
+    text.resize(size);
+
+    return static_cast<bool>(in.read(text.data(), size));
+}
+
+/*
+    Write facts
+
+    @param[in, out] out Output stream
+    @param[in] facts Facts to write
+*/
+inline void writeFacts(std::ostream& out, const Facts& facts) {
+
+    writeInteger(out, facts.textSize);
+    writeInteger(out, facts.loc);
+    writeInteger(out, facts.exprCount);
+    writeInteger(out, facts.functionCount);
+    writeInteger(out, facts.classCount);
+    writeInteger(out, facts.unitCount);
+    writeInteger(out, facts.declCount);
+    writeInteger(out, facts.commentCount);
+}
+
+/*
+    Read facts
+
+    @param[in, out] in Input stream
+    @param[out] facts Facts read
+    @return Whether the facts were read
+*/
+[[nodiscard]] inline bool readFacts(std::istream& in, Facts& facts) {
+
+    return readInteger(in, facts.textSize) && readInteger(in, facts.loc) && readInteger(in, facts.exprCount) &&
+           readInteger(in, facts.functionCount) && readInteger(in, facts.classCount) && readInteger(in, facts.unitCount) &&
+           readInteger(in, facts.declCount) && readInteger(in, facts.commentCount);
+}
+
+#endif
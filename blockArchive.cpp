@@ -0,0 +1,173 @@
+/*
+    blockArchive.cpp
+
+    Block-compressed srcML archive file of independent gzip members.
+*/
+
+#include "blockArchive.hpp"
+#include <cstdint>
+#include <limits>
+#include <zlib.h>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    // gzip header with only an extra field, which has a single 'SF' subfield of the member size and block length
+    constexpr auto HEADER = "\x1f\x8b\x08\x04\0\0\0\0\0\xff\x0c\0SF\x08\0"sv;
+    const std::size_t HEADER_SIZE = HEADER.size() + 8;
+    // CRC-32 and length
+    const std::size_t TRAILER_SIZE = 8;
+
+    /*
+        Write a 4-byte little-endian integer
+
+        @param[in, out] out Output
+        @param[in] value Value to write
+    */
+    void appendInteger(std::string& out, std::uint32_t value) {
+
+        for (int i = 0; i < 4; ++i)
+            out += static_cast<char>(value >> (i * 8));
+    }
+
+    /*
+        Read a 4-byte little-endian integer
+
+        @param[in] data Data with the integer at the start
+        @return Value read
+    */
+    std::uint32_t readInteger(std::string_view data) {
+
+        std::uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+            value |= std::uint32_t(static_cast<unsigned char>(data[i])) << (i * 8);
+
+        return value;
+    }
+}
+
+/*
+    Blocks of a block-compressed archive file
+
+    @param[in] data Contents of the file
+    @param[out] blocks Blocks in file order, without the end marker
+    @return Whether the file is a complete block-compressed archive
+*/
+bool readBlocks(std::string_view data, std::vector<Block>& blocks) {
+
+    blocks.clear();
+    std::size_t offset = 0;
+    while (data.size() - offset >= HEADER_SIZE + TRAILER_SIZE && data.compare(offset, HEADER.size(), HEADER) == 0) {
+        const std::size_t size = readInteger(data.substr(offset + HEADER.size()));
+        const std::size_t length = readInteger(data.substr(offset + HEADER.size() + 4));
+        if (size < HEADER_SIZE + TRAILER_SIZE || size > data.size() - offset)
+            return false;
+        // end marker
+        if (length == 0)
+            return offset + size == data.size() && !blocks.empty();
+        blocks.push_back({ static_cast<long>(offset), static_cast<long>(size), static_cast<long>(length) });
+        offset += size;
+    }
+
+    return false;
+}
+
+/*
+    Decompress a block
+
+    @param[in] data Contents of the file
+    @param[in] block Block to decompress
+    @param[out] content Uncompressed block
+    @return Whether the block was decompressed and its checksum matches
+*/
+bool inflateBlock(std::string_view data, const Block& block, std::string& content) {
+
+    const std::string_view member(data.substr(block.offset, block.size));
+    const std::string_view compressed(member.substr(HEADER_SIZE, member.size() - HEADER_SIZE - TRAILER_SIZE));
+    content.resize(block.length);
+
+    // raw deflate, as the gzip header and trailer are handled here
+    z_stream stream{};
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+        return false;
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    stream.next_out = reinterpret_cast<Bytef*>(content.data());
+    stream.avail_out = static_cast<uInt>(content.size());
+    const int status = inflate(&stream, Z_FINISH);
+    const bool complete = status == Z_STREAM_END && stream.total_out == content.size();
+    inflateEnd(&stream);
+    if (!complete)
+        return false;
+
+    const std::string_view trailer(member.substr(member.size() - TRAILER_SIZE));
+    const auto checksum = crc32(0, reinterpret_cast<const Bytef*>(content.data()), static_cast<uInt>(content.size()));
+    return readInteger(trailer) == checksum && readInteger(trailer.substr(4)) == content.size();
+}
+
+/*
+    Create a block-compressed archive file
+
+    @param[in] path Filename
+    @return Whether the file was created
+*/
+bool BlockWriter::open(const std::string& path) {
+
+    out.open(path, std::ios::binary | std::ios::trunc);
+
+    return static_cast<bool>(out);
+}
+
+/*
+    Compress and write a block
+
+    @param[in] content Uncompressed block
+    @return Whether the block was written
+*/
+bool BlockWriter::write(std::string_view content) {
+
+    // sizes in the header and trailer are 32 bits, with room for a compressed size larger than the block
+    if (content.size() > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+        return false;
+
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+    member.resize(HEADER_SIZE + deflateBound(&stream, static_cast<uLong>(content.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(content.data()));
+    stream.avail_in = static_cast<uInt>(content.size());
+    stream.next_out = reinterpret_cast<Bytef*>(member.data() + HEADER_SIZE);
+    stream.avail_out = static_cast<uInt>(member.size() - HEADER_SIZE);
+    const int status = deflate(&stream, Z_FINISH);
+    member.resize(HEADER_SIZE + stream.total_out);
+    deflateEnd(&stream);
+    if (status != Z_STREAM_END)
+        return false;
+
+    // header is written last, as it has the compressed size
+    std::string header(HEADER);
+    appendInteger(header, static_cast<std::uint32_t>(member.size() + TRAILER_SIZE));
+    appendInteger(header, static_cast<std::uint32_t>(content.size()));
+    member.replace(0, HEADER_SIZE, header);
+    appendInteger(member, crc32(0, reinterpret_cast<const Bytef*>(content.data()), static_cast<uInt>(content.size())));
+    appendInteger(member, static_cast<std::uint32_t>(content.size()));
+    out.write(member.data(), member.size());
+
+    return static_cast<bool>(out);
+}
+
+/*
+    Write the end marker and close the file
+
+    @return Whether the file is complete
+*/
+bool BlockWriter::close() {
+
+    if (!write(""sv))
+        return false;
+    out.close();
+
+    return static_cast<bool>(out);
+}
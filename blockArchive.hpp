@@ -0,0 +1,83 @@
+/*
+    blockArchive.hpp
+
+    Block-compressed srcML archive file: a sequence of independent gzip
+    members, as in BGZF, so the file is still a valid gzip file. Each block
+    starts at a child unit, and the blocks can be decompressed and parsed
+    in any order or in parallel.
+
+    The first block is the start of the archive through the root unit
+    start tag, and the last block is the root unit end tag. Each gzip
+    header has an extra field with the size of the member and the length of
+    the block, so the blocks are found without decompressing. An empty
+    member marks the end of the file.
+*/
+
+#ifndef INCLUDED_BLOCKARCHIVE_HPP
+#define INCLUDED_BLOCKARCHIVE_HPP
+
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// gzip member of a block
+struct Block {
+    long offset = 0;
+    long size = 0;
+    // uncompressed length
+    long length = 0;
+};
+
+/*
+    Blocks of a block-compressed archive file
+
+    @param[in] data Contents of the file
+    @param[out] blocks Blocks in file order, without the end marker
+    @return Whether the file is a complete block-compressed archive
+*/
+[[nodiscard]] bool readBlocks(std::string_view data, std::vector<Block>& blocks);
+
+/*
+    Decompress a block
+
+    @param[in] data Contents of the file
+    @param[in] block Block to decompress
+    @param[out] content Uncompressed block
+    @return Whether the block was decompressed and its checksum matches
+*/
+[[nodiscard]] bool inflateBlock(std::string_view data, const Block& block, std::string& content);
+
+class BlockWriter {
+public:
+
+    /*
+        Create a block-compressed archive file
+
+        @param[in] path Filename
+        @return Whether the file was created
+    */
+    [[nodiscard]] bool open(const std::string& path);
+
+    /*
+        Compress and write a block
+
+        @param[in] content Uncompressed block
+        @return Whether the block was written
+    */
+    [[nodiscard]] bool write(std::string_view content);
+
+    /*
+        Write the end marker and close the file
+
+        @return Whether the file is complete
+    */
+    [[nodiscard]] bool close();
+
+private:
+    std::ofstream out;
+    // compressed member
+    std::string member;
+};
+
+#endif
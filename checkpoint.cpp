@@ -0,0 +1,122 @@
+/*
+    checkpoint.cpp
+
+    Checkpoints of a long run at child unit boundaries.
+*/
+
+#include "checkpoint.hpp"
+#include "binaryIO.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    constexpr auto MAGIC = "SRCFACTS-CHECKPOINT\n"sv;
+    const std::uint64_t VERSION = 1;
+
+    /*
+        Save a checkpoint, replacing the file
+
+        @param[in] path Checkpoint filename
+        @param[in] checkpoint Checkpoint
+        @return Whether the checkpoint was saved
+    */
+    bool saveCheckpoint(const std::string& path, const Checkpoint& checkpoint) {
+
+        // write to a temporary file so an interrupted save keeps the previous checkpoint
+        const std::string temporaryPath = path + ".tmp";
+        {
+            std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+            out.write(MAGIC.data(), MAGIC.size());
+            writeInteger(out, VERSION);
+            writeInteger(out, checkpoint.stamp.size);
+            writeInteger(out, checkpoint.stamp.modified);
+            writeInteger(out, checkpoint.stamp.sampleHash);
+            writeInteger(out, checkpoint.offset);
+            writeInteger(out, checkpoint.depth);
+            writeString(out, checkpoint.url);
+            writeFacts(out, checkpoint.facts);
+            writeInteger(out, checkpoint.filteredUnits);
+            writeInteger(out, checkpoint.filteredBytes);
+            if (!out)
+                return false;
+        }
+
+        return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+    }
+}
+
+/*
+    Load a checkpoint
+
+    @param[in] path Checkpoint filename
+    @param[out] checkpoint Checkpoint
+    @return Whether a valid checkpoint was loaded
+*/
+bool loadCheckpoint(const std::string& path, Checkpoint& checkpoint) {
+
+    std::ifstream in(path, std::ios::binary);
+    std::string magic(MAGIC.size(), ' ');
+    std::uint64_t version = 0;
+    long depth = 0;
+    if (!in.read(magic.data(), magic.size()) || magic != MAGIC || !readInteger(in, version) || version != VERSION)
+        return false;
+    if (!readInteger(in, checkpoint.stamp.size) || !readInteger(in, checkpoint.stamp.modified) ||
+        !readInteger(in, checkpoint.stamp.sampleHash) || !readInteger(in, checkpoint.offset) || !readInteger(in, depth) ||
+        !readString(in, checkpoint.url) || !readFacts(in, checkpoint.facts) ||
+        !readInteger(in, checkpoint.filteredUnits) || !readInteger(in, checkpoint.filteredBytes))
+        return false;
+    checkpoint.depth = static_cast<int>(depth);
+
+    return checkpoint.offset > 0 && checkpoint.depth == 1;
+}
+
+CheckpointWriter::~CheckpointWriter() {
+
+    [[maybe_unused]] const bool written = stop();
+}
+
+/*
+    Start writing checkpoints
+
+    @param[in] path Checkpoint filename
+*/
+void CheckpointWriter::start(const std::string& path) {
+
+    this->path = path;
+}
+
+/*
+    Write a checkpoint in the background. While the previous checkpoint is
+    still being written, the checkpoint is dropped.
+
+    @param[in] checkpoint Checkpoint
+*/
+void CheckpointWriter::write(const Checkpoint& checkpoint) {
+
+    // the parse never waits for a slow file system, the next checkpoint is only an interval later
+    if (writing.valid()) {
+        if (writing.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+        failed = failed || !writing.get();
+    }
+
+    writing = std::async(std::launch::async, saveCheckpoint, path, checkpoint);
+}
+
+/*
+    Finish writing the last checkpoint
+
+    @return Whether all the checkpoints were written
+*/
+bool CheckpointWriter::stop() {
+
+    if (writing.valid())
+        failed = failed || !writing.get();
+
+    return !failed;
+}
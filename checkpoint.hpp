@@ -0,0 +1,81 @@
+/*
+    checkpoint.hpp
+
+    Checkpoints of a long run at child unit boundaries, so a run that is
+    interrupted can resume from the last checkpoint instead of the start.
+
+    A checkpoint records the byte offset in the uncompressed input just
+    after a child unit, the parser depth there, and the counters collected
+    so far. Checkpoints are written in the background, so the parse only
+    copies the counters. The file is replaced atomically, so it is
+    always a complete checkpoint.
+*/
+
+#ifndef INCLUDED_CHECKPOINT_HPP
+#define INCLUDED_CHECKPOINT_HPP
+
+#include "facts.hpp"
+#include "unitIndex.hpp"
+#include <future>
+#include <string>
+
+struct Checkpoint {
+    // identity of the input file
+    FileStamp stamp;
+    // offset in the uncompressed input just after a child unit, and the parser depth there
+    long offset = 0;
+    int depth = 1;
+    std::string url;
+    Facts facts;
+    long filteredUnits = 0;
+    long filteredBytes = 0;
+};
+
+/*
+    Load a checkpoint
+
+    @param[in] path Checkpoint filename
+    @param[out] checkpoint Checkpoint
+    @return Whether a valid checkpoint was loaded
+*/
+[[nodiscard]] bool loadCheckpoint(const std::string& path, Checkpoint& checkpoint);
+
+class CheckpointWriter {
+public:
+
+    CheckpointWriter() = default;
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+    ~CheckpointWriter();
+
+    /*
+        Start writing checkpoints
+
+        @param[in] path Checkpoint filename
+    */
+    void start(const std::string& path);
+
+    /*
+        Write a checkpoint in the background. While the previous checkpoint is
+        still being written, the checkpoint is dropped.
+
+        @param[in] checkpoint Checkpoint
+    */
+    void write(const Checkpoint& checkpoint);
+
+    /*
+        Finish writing the last checkpoint
+
+        @return Whether all the checkpoints were written
+    */
+    bool stop();
+
+private:
+
+    std::string path;
+    // result of the checkpoint being written
+    std::future<bool> writing;
+    bool failed = false;
+};
+
+#endif
@@ -0,0 +1,487 @@
+/*
+    compareBench.cpp
+
+    Comparison of the srcfacts parser with libxml2 and expat, when they are
+    installed, as a reference for parser optimization. Each parser computes
+    the default facts with a FactsCollector, from the SAX events of libxml2
+    and expat, and the report has the median throughput and the peak RSS of
+    each parser, and whether its facts are the same as from srcfacts.
+
+    Usage: srcfacts_compare [--mix=MIX]... [--size=SIZE] [--repeat=N] [--seed=N] [FILE]...
+
+    The inputs are the synthetic archives of the mixes, as for
+    srcfacts_bench, all predefined mixes by default, and any uncompressed
+    srcML files, e.g., data/demo.xml. Synthetic archives are written to
+    temporary files, so every parser streams its input from a file in
+    blocks. Each run is in its own process, so the peak RSS is of that
+    parser and input only.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <locale>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "options.hpp"
+#include "refillContent.hpp"
+#include "factsCollector.hpp"
+#include "srcMLParser.hpp"
+#include "syntheticArchive.hpp"
+#ifdef SRCFACTS_LIBXML2
+#include <libxml/parser.h>
+#endif
+#ifdef SRCFACTS_EXPAT
+#include <expat.h>
+#endif
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    // parsers compared
+    enum ComparedParser { SRCFACTS_PARSER, LIBXML2_PARSER, EXPAT_PARSER, PARSER_COUNT };
+
+    // names of the parsers
+    constexpr std::string_view PARSER_NAMES[PARSER_COUNT] = { "srcfacts", "libxml2", "expat" };
+
+    // result of a run, passed from the process of the run
+    struct RunResult {
+        Facts facts;
+        double seconds = 0;
+        bool parsed = false;
+    };
+
+    /*
+        @param[in] parser Parser
+        @return Whether the parser is in this build
+    */
+    bool available(ComparedParser parser) {
+
+        switch (parser) {
+#ifdef SRCFACTS_LIBXML2
+        case LIBXML2_PARSER:
+            return true;
+#endif
+#ifdef SRCFACTS_EXPAT
+        case EXPAT_PARSER:
+            return true;
+#endif
+        case SRCFACTS_PARSER:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // SAX events of libxml2 and expat to a FactsCollector, with the same calls as the srcfacts parser
+    class SAXFacts {
+    public:
+
+        /*
+            @param[in, out] collector Collector of the facts
+        */
+        explicit SAXFacts(FactsCollector& collector) : collector(collector) {}
+
+        /*
+            Start tag and its attributes
+
+            @param[in] prefix Element namespace prefix
+            @param[in] localName Element local name
+        */
+        void startElement(std::string_view prefix, std::string_view localName) {
+
+            collector.startElement(depth, prefix, localName);
+        }
+
+        /*
+            @param[in] localName Attribute local name
+            @param[in] value Attribute value
+        */
+        void attribute(std::string_view localName, std::string_view value) {
+
+            collector.attribute(localName, value);
+        }
+
+        /*
+            End of the start tag. The SAX parsers do not report empty elements,
+            which are an end tag, but that makes no difference to the facts.
+        */
+        void endStartTag() {
+
+            [[maybe_unused]] const bool skip = collector.endStartTag();
+            ++depth;
+        }
+
+        /*
+            End tag
+        */
+        void endElement() {
+
+            --depth;
+            collector.endElement(depth);
+        }
+
+        /*
+            @param[in] characters Characters, with entity references already converted
+        */
+        void characters(std::string_view characters) {
+
+            collector.characters(characters);
+        }
+
+    private:
+        FactsCollector& collector;
+        int depth = 0;
+    };
+
+    /*
+        Read the next block of a file
+
+        @param[in] descriptor File descriptor
+        @param[out] buffer Buffer of BUFFER_SIZE bytes
+        @return Number of bytes read, 0 at EOF, or -1 for an error
+    */
+    long readBlock(int descriptor, char* buffer) {
+
+        return static_cast<long>(::read(descriptor, buffer, BUFFER_SIZE));
+    }
+
+#ifdef SRCFACTS_LIBXML2
+    /*
+        Parse with the libxml2 SAX2 push parser
+
+        @param[in] descriptor File descriptor of the input
+        @param[in, out] saxFacts Collector of the SAX events
+        @return Whether the input was parsed
+    */
+    bool parseLibxml2(int descriptor, SAXFacts& saxFacts) {
+
+        xmlSAXHandler handler{};
+        handler.initialized = XML_SAX2_MAGIC;
+        handler.startElementNs = [](void* context, const xmlChar* localName, const xmlChar* prefix, const xmlChar*, int, const xmlChar**,
+                                    int attributeCount, int, const xmlChar** attributes) {
+            SAXFacts& saxFacts = *static_cast<SAXFacts*>(context);
+            saxFacts.startElement(prefix ? reinterpret_cast<const char*>(prefix) : "", reinterpret_cast<const char*>(localName));
+            // each attribute is its local name, prefix, URI, and the start and end of its value
+            for (int i = 0; i < attributeCount; ++i) {
+                const xmlChar** attribute = attributes + i * 5;
+                saxFacts.attribute(reinterpret_cast<const char*>(attribute[0]),
+                                   std::string_view(reinterpret_cast<const char*>(attribute[3]), attribute[4] - attribute[3]));
+            }
+            saxFacts.endStartTag();
+        };
+        handler.endElementNs = [](void* context, const xmlChar*, const xmlChar*, const xmlChar*) {
+            static_cast<SAXFacts*>(context)->endElement();
+        };
+        handler.characters = [](void* context, const xmlChar* characters, int length) {
+            static_cast<SAXFacts*>(context)->characters(std::string_view(reinterpret_cast<const char*>(characters), length));
+        };
+        handler.cdataBlock = handler.characters;
+        handler.ignorableWhitespace = handler.characters;
+
+        std::vector<char> buffer(BUFFER_SIZE);
+        xmlParserCtxtPtr context = xmlCreatePushParserCtxt(&handler, &saxFacts, nullptr, 0, nullptr);
+        if (!context)
+            return false;
+        // srcML archives have text nodes, e.g., of a unit, longer than the default limits
+        xmlCtxtUseOptions(context, XML_PARSE_HUGE);
+        bool parsed = true;
+        long bytesRead = 0;
+        while (parsed && (bytesRead = readBlock(descriptor, buffer.data())) > 0)
+            parsed = xmlParseChunk(context, buffer.data(), static_cast<int>(bytesRead), 0) == 0;
+        parsed = parsed && bytesRead == 0 && xmlParseChunk(context, nullptr, 0, 1) == 0 && context->wellFormed;
+        xmlFreeParserCtxt(context);
+
+        return parsed;
+    }
+#endif
+
+#ifdef SRCFACTS_EXPAT
+    /*
+        Parse with expat, without namespace processing, so qNames are split here
+
+        @param[in] descriptor File descriptor of the input
+        @param[in, out] saxFacts Collector of the SAX events
+        @return Whether the input was parsed
+    */
+    bool parseExpat(int descriptor, SAXFacts& saxFacts) {
+
+        XML_Parser parser = XML_ParserCreate(nullptr);
+        if (!parser)
+            return false;
+        XML_SetUserData(parser, &saxFacts);
+        XML_SetElementHandler(parser,
+            [](void* context, const XML_Char* name, const XML_Char** attributes) {
+                SAXFacts& saxFacts = *static_cast<SAXFacts*>(context);
+                const std::string_view qName(name);
+                const std::size_t colonPosition = qName.find(':');
+                if (colonPosition == qName.npos)
+                    saxFacts.startElement(""sv, qName);
+                else
+                    saxFacts.startElement(qName.substr(0, colonPosition), qName.substr(colonPosition + 1));
+                // attributes are name and value pairs, and include the namespace declarations
+                for (int i = 0; attributes[i]; i += 2) {
+                    const std::string_view attributeName(attributes[i]);
+                    if (attributeName.compare(0, "xmlns"sv.size(), "xmlns"sv) == 0)
+                        continue;
+                    const std::size_t attributeColon = attributeName.find(':');
+                    saxFacts.attribute(attributeColon == attributeName.npos ? attributeName : attributeName.substr(attributeColon + 1), attributes[i + 1]);
+                }
+                saxFacts.endStartTag();
+            },
+            [](void* context, const XML_Char*) {
+                static_cast<SAXFacts*>(context)->endElement();
+            });
+        XML_SetCharacterDataHandler(parser, [](void* context, const XML_Char* characters, int length) {
+            static_cast<SAXFacts*>(context)->characters(std::string_view(characters, length));
+        });
+
+        bool parsed = true;
+        long bytesRead = 0;
+        do {
+            void* buffer = XML_GetBuffer(parser, BUFFER_SIZE);
+            if (!buffer) {
+                parsed = false;
+                break;
+            }
+            bytesRead = readBlock(descriptor, static_cast<char*>(buffer));
+            if (bytesRead < 0) {
+                parsed = false;
+                break;
+            }
+            parsed = XML_ParseBuffer(parser, static_cast<int>(bytesRead), bytesRead == 0) == XML_STATUS_OK;
+        } while (parsed && bytesRead > 0);
+        XML_ParserFree(parser);
+
+        return parsed;
+    }
+#endif
+
+    /*
+        Parse a file for the facts
+
+        @param[in] parser Parser
+        @param[in] filename Input file
+        @return Result of the run
+    */
+    RunResult run(ComparedParser parser, const std::string& filename) {
+
+        RunResult result;
+        FactsCollector collector{Options{}};
+        const auto startTime = std::chrono::steady_clock::now();
+        if (parser == SRCFACTS_PARSER) {
+            InputSource input;
+            result.parsed = input.open(filename) && parseSrcML(input, collector) == 0;
+        } else {
+            const int descriptor = ::open(filename.c_str(), O_RDONLY);
+            if (descriptor == -1)
+                return result;
+            [[maybe_unused]] SAXFacts saxFacts(collector);
+#ifdef SRCFACTS_LIBXML2
+            if (parser == LIBXML2_PARSER)
+                result.parsed = parseLibxml2(descriptor, saxFacts);
+#endif
+#ifdef SRCFACTS_EXPAT
+            if (parser == EXPAT_PARSER)
+                result.parsed = parseExpat(descriptor, saxFacts);
+#endif
+            close(descriptor);
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        result.facts = collector.facts;
+
+        return result;
+    }
+
+    /*
+        Run a parser in its own process
+
+        @param[in] parser Parser
+        @param[in] filename Input file
+        @param[out] result Result of the run
+        @param[out] peakKB Peak RSS of the process in KB
+        @return Whether the process completed
+    */
+    bool runProcess(ComparedParser parser, const std::string& filename, RunResult& result, long& peakKB) {
+
+        int fds[2];
+        if (pipe(fds) != 0)
+            return false;
+        std::cout.flush();
+        const pid_t pid = fork();
+        if (pid == -1)
+            return false;
+        if (pid == 0) {
+            close(fds[0]);
+            const RunResult childResult = run(parser, filename);
+            const bool written = write(fds[1], &childResult, sizeof(childResult)) == static_cast<ssize_t>(sizeof(childResult));
+            _exit(written ? 0 : 1);
+        }
+        close(fds[1]);
+        const bool read = ::read(fds[0], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+        close(fds[0]);
+        int status = 0;
+        rusage usage{};
+        if (wait4(pid, &status, 0, &usage) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || !read)
+            return false;
+        peakKB = usage.ru_maxrss;
+
+        return true;
+    }
+
+    /*
+        Parse a size in bytes with an optional K, M, or G suffix, in powers of 1000
+
+        @param[in] text Size, e.g., "10G"
+        @param[out] size Size in bytes
+        @return Whether the size is valid
+    */
+    bool parseSize(std::string_view text, long& size) {
+
+        const auto result = std::from_chars(text.data(), text.data() + text.size(), size);
+        if (result.ec != std::errc{} || size <= 0)
+            return false;
+        const std::string_view suffix(result.ptr, text.data() + text.size() - result.ptr);
+        if (suffix == "K"sv)
+            size *= 1000;
+        else if (suffix == "M"sv)
+            size *= 1000 * 1000;
+        else if (suffix == "G"sv)
+            size *= 1000 * 1000 * 1000;
+        else if (!suffix.empty())
+            return false;
+
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+
+    std::vector<SyntheticMix> mixes;
+    long size = 16 * 1000 * 1000;
+    int repeat = 5;
+    std::uint64_t seed = 1;
+    std::vector<std::string> filenames;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        if (arg.compare(0, "--mix="sv.size(), "--mix="sv) == 0) {
+            SyntheticMix mix;
+            if (!parseSyntheticMix(arg.substr("--mix="sv.size()), mix)) {
+                std::cerr << "srcfacts_compare: Invalid mix " << arg << '\n';
+                return 1;
+            }
+            mixes.push_back(mix);
+        } else if (arg.compare(0, "--size="sv.size(), "--size="sv) == 0) {
+            if (!parseSize(arg.substr("--size="sv.size()), size)) {
+                std::cerr << "srcfacts_compare: Invalid size " << arg << '\n';
+                return 1;
+            }
+        } else if (arg.compare(0, "--repeat="sv.size(), "--repeat="sv) == 0) {
+            repeat = std::atoi(arg.data() + "--repeat="sv.size());
+            if (repeat <= 0) {
+                std::cerr << "srcfacts_compare: Invalid number of repetitions " << arg << '\n';
+                return 1;
+            }
+        } else if (arg.compare(0, "--seed="sv.size(), "--seed="sv) == 0) {
+            const std::string_view value = arg.substr("--seed="sv.size());
+            const auto result = std::from_chars(value.data(), value.data() + value.size(), seed);
+            if (result.ec != std::errc{} || result.ptr != value.data() + value.size()) {
+                std::cerr << "srcfacts_compare: Invalid seed " << arg << '\n';
+                return 1;
+            }
+        } else if (!arg.empty() && arg[0] != '-') {
+            filenames.emplace_back(arg);
+        } else {
+            std::cerr << "srcfacts_compare: Unknown option " << arg << '\n';
+            return 1;
+        }
+    }
+    if (mixes.empty())
+        mixes = syntheticMixes();
+
+    // inputs are the files, then the synthetic archives written to temporary files
+    std::vector<std::pair<std::string, std::string>> inputs;
+    for (const auto& filename : filenames)
+        inputs.emplace_back(std::filesystem::path(filename).filename().string(), filename);
+    std::vector<std::string> temporaryFiles;
+    for (const auto& mix : mixes) {
+        const std::string filename = (std::filesystem::temp_directory_path() / ("srcfacts_compare_" + std::to_string(getpid()) + "_" + mix.name + ".xml")).string();
+        std::ofstream out(filename, std::ios::binary);
+        temporaryFiles.push_back(filename);
+        if (!out || !writeSyntheticArchive(out, mix, size, seed)) {
+            std::cerr << "srcfacts_compare: Unable to write " << filename << '\n';
+            for (const auto& temporaryFile : temporaryFiles)
+                std::filesystem::remove(temporaryFile);
+            return 1;
+        }
+        inputs.emplace_back(mix.name, filename);
+    }
+
+    std::cout.imbue(std::locale{""});
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "| Input                | Parser   |  Size MB | Median MB/s | Peak RSS MB | Facts     |\n";
+    std::cout << "|:---------------------|:---------|---------:|------------:|------------:|:----------|\n";
+    bool same = true;
+    bool failed = false;
+    for (const auto& [name, filename] : inputs) {
+        Facts expected;
+        for (int parser = 0; parser < PARSER_COUNT; ++parser) {
+            if (!available(static_cast<ComparedParser>(parser)))
+                continue;
+
+            std::vector<double> seconds;
+            long peakKB = 0;
+            RunResult result;
+            for (int i = 0; i < repeat; ++i) {
+                long runPeakKB = 0;
+                if (!runProcess(static_cast<ComparedParser>(parser), filename, result, runPeakKB) || !result.parsed) {
+                    result.parsed = false;
+                    break;
+                }
+                seconds.push_back(result.seconds);
+                peakKB = std::max(peakKB, runPeakKB);
+            }
+            if (!result.parsed) {
+                std::cerr << "srcfacts_compare: " << PARSER_NAMES[parser] << " was unable to parse " << filename << '\n';
+                failed = true;
+                continue;
+            }
+            std::sort(seconds.begin(), seconds.end());
+
+            // the facts of the other parsers are checked against srcfacts
+            std::string_view factsCheck = "reference"sv;
+            if (parser == SRCFACTS_PARSER) {
+                expected = result.facts;
+            } else if (result.facts == expected) {
+                factsCheck = "same"sv;
+            } else {
+                factsCheck = "different"sv;
+                same = false;
+            }
+            const double mb = std::filesystem::file_size(filename) / 1000000.0;
+            std::cout << "| " << std::setw(20) << std::left << name << " | " << std::setw(8) << PARSER_NAMES[parser] << std::right
+                      << " | " << std::setw(8) << mb
+                      << " | " << std::setw(11) << mb / seconds[seconds.size() / 2]
+                      << " | " << std::setw(11) << peakKB / 1024.0
+                      << " | " << std::setw(9) << std::left << factsCheck << std::right << " |\n";
+        }
+    }
+    for (const auto& temporaryFile : temporaryFiles)
+        std::filesystem::remove(temporaryFile);
+
+    if (!same)
+        std::cerr << "srcfacts_compare: Facts are different from srcfacts\n";
+
+    return same && !failed ? 0 : 1;
+}
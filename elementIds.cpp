@@ -0,0 +1,125 @@
+/*
+    elementIds.cpp
+
+    Interned IDs for element local names.
+*/
+
+#include "elementIds.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    // local names of the fixed IDs, in ElementId order
+    constexpr std::string_view KNOWN_NAMES[] = {
+        "unit"sv, "function"sv, "class"sv, "decl"sv, "expr"sv, "comment"sv, "escape"sv,
+        "name"sv, "operator"sv, "if"sv, "while"sv, "for"sv, "case"sv, "ternary"sv,
+        "do"sv, "foreach"sv,
+    };
+    static_assert(std::size(KNOWN_NAMES) == KNOWN_ELEMENTS);
+
+    // characters in an arena block, enough for the local names of all the srcML elements
+    const std::size_t ARENA_BLOCK_SIZE = 4096;
+
+    // FNV-1a hash, local names are short
+    std::size_t hashName(std::string_view localName) {
+        std::size_t hash = 2166136261u;
+        for (const char c : localName) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+}
+
+/*
+    Create the table with the fixed IDs already interned
+*/
+ElementIds::ElementIds() : slots(512, 0) {
+
+    names.reserve(256);
+    arena.reserve(16);
+    arena.emplace_back(new char[ARENA_BLOCK_SIZE]);
+    for (const auto localName : KNOWN_NAMES) {
+        [[maybe_unused]] const int id = intern(localName);
+        assert(id == static_cast<int>(names.size()) - 1);
+    }
+}
+
+/*
+    Slot for the local name, either where it is or where it would go
+
+    @param[in] localName Element local name
+    @return Index into slots
+*/
+std::size_t ElementIds::slot(std::string_view localName) const {
+
+    const std::size_t mask = slots.size() - 1;
+    std::size_t position = hashName(localName) & mask;
+    while (slots[position] && names[slots[position] - 1] != localName)
+        position = (position + 1) & mask;
+
+    return position;
+}
+
+/*
+    ID of the local name without adding it
+
+    @param[in] localName Element local name
+    @return ID of the local name
+    @retval -1 Local name has not been interned
+*/
+int ElementIds::find(std::string_view localName) const {
+
+    return slots[slot(localName)] - 1;
+}
+
+/*
+    ID of the local name, adding it if it is not already present
+
+    @param[in] localName Element local name
+    @return ID of the local name
+*/
+int ElementIds::intern(std::string_view localName) {
+
+    std::size_t position = slot(localName);
+    if (slots[position])
+        return slots[position] - 1;
+
+    // keep the load factor at or below 1/2
+    if ((names.size() + 1) * 2 > slots.size()) {
+        slots.assign(slots.size() * 2, 0);
+        for (int id = 0; id < static_cast<int>(names.size()); ++id)
+            slots[slot(names[id])] = id + 1;
+        position = slot(localName);
+    }
+
+    names.push_back(store(localName));
+    slots[position] = static_cast<int>(names.size());
+
+    return static_cast<int>(names.size()) - 1;
+}
+
+/*
+    Copy the local name into the arena
+
+    @param[in] localName Element local name
+    @return View of the copy in the arena
+*/
+std::string_view ElementIds::store(std::string_view localName) {
+
+    // a name longer than a block has a block of its own
+    if (arenaUsed + localName.size() > ARENA_BLOCK_SIZE) {
+        arena.emplace_back(new char[std::max(ARENA_BLOCK_SIZE, localName.size())]);
+        arenaUsed = 0;
+    }
+    char* const copy = arena.back().get() + arenaUsed;
+    std::copy(localName.cbegin(), localName.cend(), copy);
+    arenaUsed += localName.size();
+
+    return std::string_view(copy, localName.size());
+}
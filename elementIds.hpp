@@ -0,0 +1,96 @@
+/*
+    elementIds.hpp
+
+    Interned IDs for element local names.
+
+    The srcML elements used by the analyses have fixed IDs so they can be
+    used directly in a switch. Any other local name is assigned the next
+    free ID the first time it is seen. The characters of the names are
+    stored in blocks of an arena, so interning a name does not allocate
+    until a block is full.
+*/
+
+#ifndef INCLUDED_ELEMENTIDS_HPP
+#define INCLUDED_ELEMENTIDS_HPP
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// fixed IDs for srcML elements, in the order they are interned
+enum ElementId : int {
+    UNIT,
+    FUNCTION,
+    CLASS,
+    DECL,
+    EXPR,
+    COMMENT,
+    ESCAPE,
+    NAME,
+    OPERATOR,
+    IF,
+    WHILE,
+    FOR,
+    CASE,
+    TERNARY,
+    DO,
+    FOREACH,
+    KNOWN_ELEMENTS
+};
+
+class ElementIds {
+public:
+
+    /*
+        Create the table with the fixed IDs already interned
+    */
+    ElementIds();
+
+    /*
+        ID of the local name, adding it if it is not already present
+
+        @param[in] localName Element local name
+        @return ID of the local name
+    */
+    [[nodiscard]] int intern(std::string_view localName);
+
+    /*
+        ID of the local name without adding it
+
+        @param[in] localName Element local name
+        @return ID of the local name
+        @retval -1 Local name has not been interned
+    */
+    [[nodiscard]] int find(std::string_view localName) const;
+
+    /*
+        Local name for an ID
+
+        @param[in] id Interned ID
+        @return Local name
+    */
+    [[nodiscard]] std::string_view name(int id) const {
+        return names[id];
+    }
+
+    /*
+        @return Number of interned names
+    */
+    [[nodiscard]] int size() const {
+        return static_cast<int>(names.size());
+    }
+
+private:
+    [[nodiscard]] std::size_t slot(std::string_view localName) const;
+    [[nodiscard]] std::string_view store(std::string_view localName);
+
+    // views of the names in the arena blocks, which are never moved
+    std::vector<std::string_view> names;
+    std::vector<std::unique_ptr<char[]>> arena;
+    std::size_t arenaUsed = 0;
+
+    // open-addressing table of ID + 1, with 0 for an empty slot
+    std::vector<int> slots;
+};
+
+#endif
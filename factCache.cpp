@@ -0,0 +1,78 @@
+/*
+    factCache.cpp
+
+    Persistent cache of per-unit facts keyed by the srcML unit hash.
+*/
+
+#include "factCache.hpp"
+#include "binaryIO.hpp"
+#include <cstdio>
+#include <fstream>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    constexpr auto MAGIC = "SRCFACTS-CACHE\n"sv;
+    const std::uint64_t VERSION = 1;
+}
+
+/*
+    Load a cache file. A missing file is an empty cache.
+
+    @param[in] path Cache filename
+    @return Whether the cache is empty or was loaded
+    @retval false Invalid cache file
+*/
+bool FactCache::load(const std::string& path) {
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return true;
+
+    std::string magic(MAGIC.size(), ' ');
+    std::uint64_t version = 0;
+    std::uint64_t count = 0;
+    if (!in.read(magic.data(), magic.size()) || magic != MAGIC || !readInteger(in, version) || version != VERSION || !readInteger(in, count))
+        return false;
+
+    previous.reserve(count);
+    std::string hash;
+    Facts facts;
+    for (std::uint64_t i = 0; i < count; ++i) {
+        if (!readString(in, hash) || !readFacts(in, facts)) {
+            previous.clear();
+            return false;
+        }
+        previous.emplace(hash, facts);
+    }
+
+    return true;
+}
+
+/*
+    Save the units of the current run, replacing the file
+
+    @param[in] path Cache filename
+    @return Whether the cache was saved
+*/
+bool FactCache::save(const std::string& path) const {
+
+    // write to a temporary file so an interrupted save keeps the old cache
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+        out.write(MAGIC.data(), MAGIC.size());
+        writeInteger(out, VERSION);
+        writeInteger(out, current.size());
+        for (const auto& [hash, facts] : current) {
+            writeString(out, hash);
+            writeFacts(out, facts);
+        }
+        if (!out)
+            return false;
+    }
+
+    return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,64 @@
+/*
+    factCache.hpp
+
+    Persistent cache of per-unit facts keyed by the srcML unit hash
+    attribute, a hash of the file contents, for incremental reruns.
+
+    The saved cache contains only the units seen in the current run, so
+    units that are no longer in the input do not accumulate.
+*/
+
+#ifndef INCLUDED_FACTCACHE_HPP
+#define INCLUDED_FACTCACHE_HPP
+
+#include "facts.hpp"
+#include <string>
+#include <unordered_map>
+
+class FactCache {
+public:
+
+    /*
+        Load a cache file. A missing file is an empty cache.
+
+        @param[in] path Cache filename
+        @return Whether the cache is empty or was loaded
+        @retval false Invalid cache file
+    */
+    [[nodiscard]] bool load(const std::string& path);
+
+    /*
+        Save the units of the current run, replacing the file
+
+        @param[in] path Cache filename
+        @return Whether the cache was saved
+    */
+    [[nodiscard]] bool save(const std::string& path) const;
+
+    /*
+        Cached facts of a unit from a previous run
+
+        @param[in] hash Unit hash attribute
+        @return Facts of the unit, or nullptr if not cached
+    */
+    [[nodiscard]] const Facts* find(const std::string& hash) const {
+        const auto found = previous.find(hash);
+        return found != previous.end() ? &found->second : nullptr;
+    }
+
+    /*
+        Record the facts of a unit in the current run
+
+        @param[in] hash Unit hash attribute
+        @param[in] facts Facts of the unit
+    */
+    void insert(const std::string& hash, const Facts& facts) {
+        current[hash] = facts;
+    }
+
+private:
+    std::unordered_map<std::string, Facts> previous;
+    std::unordered_map<std::string, Facts> current;
+};
+
+#endif
@@ -0,0 +1,97 @@
+/*
+    factDiff.cpp
+
+    Per-file fact differences between two srcML archives.
+*/
+
+#include "factDiff.hpp"
+
+/*
+    Start tag of a child unit. Thread-safe.
+
+    @param[in] side Archive of the unit
+    @param[in] filename Unit filename attribute
+    @param[in] hash Unit hash attribute
+    @return Whether the unit is unchanged in the other archive, so can be skipped
+*/
+bool FactDiff::unchanged(DiffSide side, std::string_view filename, std::string_view hash) {
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    std::string name(filename);
+    const long occurrence = occurrences[side][name]++;
+    auto& unit = units[{ std::move(name), occurrence }];
+    unit.seen[side] = true;
+    unit.hash[side] = hash;
+    current[side] = &unit;
+    if (!unit.same())
+        return false;
+    skipped[side].push_back(&unit);
+
+    return true;
+}
+
+/*
+    Facts of the parsed child unit of the last start tag. Thread-safe.
+
+    @param[in] side Archive of the unit
+    @param[in] facts Facts of the unit
+*/
+void FactDiff::add(DiffSide side, const Facts& facts) {
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    current[side]->facts[side] = facts;
+}
+
+/*
+    Files added, removed, or changed, in filename order. Call after both
+    archives are parsed.
+
+    @return File differences
+*/
+std::vector<FileDiff> FactDiff::changes() const {
+
+    std::vector<FileDiff> fileDiffs;
+    for (const auto& [key, unit] : units) {
+        const std::string& filename = key.first;
+        if (unit.same())
+            continue;
+        const Facts delta = unit.facts[NEW_ARCHIVE] - unit.facts[OLD_ARCHIVE];
+        if (!unit.seen[OLD_ARCHIVE]) {
+            fileDiffs.push_back({ filename, FileChange::ADDED, delta });
+        } else if (!unit.seen[NEW_ARCHIVE]) {
+            fileDiffs.push_back({ filename, FileChange::REMOVED, delta });
+        } else {
+            // without hash attributes, a file is changed only if its facts are
+            const bool hashes = !unit.hash[OLD_ARCHIVE].empty() && !unit.hash[NEW_ARCHIVE].empty();
+            if (hashes || unit.facts[OLD_ARCHIVE] != unit.facts[NEW_ARCHIVE])
+                fileDiffs.push_back({ filename, FileChange::CHANGED, delta });
+        }
+    }
+
+    return fileDiffs;
+}
+
+/*
+    @return Number of files unchanged in both archives
+*/
+long FactDiff::unchangedCount() const {
+
+    // the rest are the same in both archives, by hash attribute or by facts
+    return static_cast<long>(units.size() - changes().size());
+}
+
+/*
+    Facts of the units of an archive that were skipped as unchanged, from
+    the other archive. Call after both archives are parsed.
+
+    @param[in] side Archive
+    @return Facts of the skipped units
+*/
+Facts FactDiff::skippedFacts(DiffSide side) const {
+
+    Facts facts;
+    for (const auto unit : skipped[side])
+        facts += unit->facts[side == OLD_ARCHIVE ? NEW_ARCHIVE : OLD_ARCHIVE];
+
+    return facts;
+}
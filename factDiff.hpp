@@ -0,0 +1,107 @@
+/*
+    factDiff.hpp
+
+    Per-file fact differences between two srcML archives, e.g., two
+    releases, pairing the child units by filename. Both archives are
+    parsed at the same time, one per thread, and share the diff. A filename
+    repeated in an archive is paired by its occurrence.
+
+    When a unit reaches its start tag and the other archive already has a
+    unit of the same filename with the same hash attribute, the unit is
+    unchanged and is skipped without parsing. Its facts, for the totals,
+    are the facts from the other archive.
+*/
+
+#ifndef INCLUDED_FACTDIFF_HPP
+#define INCLUDED_FACTDIFF_HPP
+
+#include "facts.hpp"
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// archives of a diff
+enum DiffSide { OLD_ARCHIVE, NEW_ARCHIVE };
+
+// change of a file
+enum class FileChange { ADDED, REMOVED, CHANGED };
+
+// file that is not in both archives with the same contents
+struct FileDiff {
+    std::string filename;
+    FileChange change;
+    // new facts minus old facts
+    Facts delta;
+};
+
+class FactDiff {
+public:
+
+    /*
+        Start tag of a child unit. Thread-safe.
+
+        @param[in] side Archive of the unit
+        @param[in] filename Unit filename attribute
+        @param[in] hash Unit hash attribute
+        @return Whether the unit is unchanged in the other archive, so can be skipped
+    */
+    [[nodiscard]] bool unchanged(DiffSide side, std::string_view filename, std::string_view hash);
+
+    /*
+        Facts of the parsed child unit of the last start tag. Thread-safe.
+
+        @param[in] side Archive of the unit
+        @param[in] facts Facts of the unit
+    */
+    void add(DiffSide side, const Facts& facts);
+
+    /*
+        Files added, removed, or changed, in filename order. Call after both
+        archives are parsed.
+
+        @return File differences
+    */
+    [[nodiscard]] std::vector<FileDiff> changes() const;
+
+    /*
+        @return Number of files unchanged in both archives
+    */
+    [[nodiscard]] long unchangedCount() const;
+
+    /*
+        Facts of the units of an archive that were skipped as unchanged, from
+        the other archive. Call after both archives are parsed.
+
+        @param[in] side Archive
+        @return Facts of the skipped units
+    */
+    [[nodiscard]] Facts skippedFacts(DiffSide side) const;
+
+private:
+    struct Unit {
+        bool seen[2] = { false, false };
+        std::string hash[2];
+        Facts facts[2];
+
+        // same contents in both archives
+        bool same() const {
+            return seen[OLD_ARCHIVE] && seen[NEW_ARCHIVE] && !hash[OLD_ARCHIVE].empty() && hash[OLD_ARCHIVE] == hash[NEW_ARCHIVE];
+        }
+    };
+
+    std::mutex mutex;
+    // units by filename and occurrence of the filename
+    std::map<std::pair<std::string, long>, Unit> units;
+    // number of occurrences of each filename in each archive
+    std::unordered_map<std::string, long> occurrences[2];
+    // unit of the last start tag in each archive
+    Unit* current[2] = { nullptr, nullptr };
+    // units of each archive skipped as unchanged
+    std::vector<const Unit*> skipped[2];
+};
+
+#endif
@@ -0,0 +1,207 @@
+/*
+    factStore.cpp
+
+    Columnar store of the facts of each child unit of an archive.
+
+    Layout, with all integers 8 bytes in native byte order:
+    * magic, byte order mark, version
+    * number of units, number of languages, archive size, string table size
+    * facts outside the child units, one value per measure
+    * url length
+    * one column per measure, one value per unit
+    * filename end offsets, one per unit
+    * language column, one language number per unit
+    * language end offsets, one per language
+    * string table of the url, filenames, and languages
+*/
+
+#include "factStore.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    constexpr auto MAGIC = "SRCFACTS-STORE\n\0"sv;
+    const std::uint64_t BYTE_ORDER_MARK = 0x0102030405060708;
+    const std::uint64_t VERSION = 1;
+    // magic, then byte order, version, counts and sizes, root facts, and url length
+    const std::size_t HEADER_SIZE = MAGIC.size() + (6 + MEASURE_COUNT + 1) * sizeof(std::uint64_t);
+
+    /*
+        Write an array of integers
+
+        @param[in, out] out Output stream
+        @param[in] values Integers
+    */
+    template <class Integer>
+    void writeArray(std::ostream& out, const std::vector<Integer>& values) {
+
+        out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(Integer));
+    }
+}
+
+/*
+    @param[in] name Measure name, e.g., loc
+    @return Column of the measure
+    @retval -1 Unknown measure
+*/
+int measureColumn(std::string_view name) {
+
+    for (int column = 0; column < MEASURE_COUNT; ++column) {
+        if (MEASURE_COLUMNS[column].name == name)
+            return column;
+    }
+
+    return -1;
+}
+
+/*
+    Append the facts of a child unit
+
+    @param[in] filename Unit filename attribute
+    @param[in] language Unit language attribute
+    @param[in] facts Facts of the unit
+*/
+void FactStoreWriter::add(std::string_view filename, std::string_view language, const Facts& facts) {
+
+    for (int column = 0; column < MEASURE_COUNT; ++column)
+        columns[column].push_back(facts.*MEASURE_COLUMNS[column].member);
+    filenames += filename;
+    filenameEnds.push_back(filenames.size());
+
+    // few languages, so a linear search
+    const auto found = std::find(languageNames.cbegin(), languageNames.cend(), language);
+    languageColumn.push_back(std::distance(languageNames.cbegin(), found));
+    if (found == languageNames.cend())
+        languageNames.emplace_back(language);
+}
+
+/*
+    Save the store
+
+    @param[in] path Store filename
+    @param[in] url Archive url attribute
+    @param[in] totalBytes Size of the archive
+    @return Whether the store was saved
+*/
+bool FactStoreWriter::save(const std::string& path, std::string_view url, long totalBytes) const {
+
+    // offsets are into the string table, which starts with the url
+    std::vector<std::uint64_t> header = { BYTE_ORDER_MARK, VERSION, filenameEnds.size(), languageNames.size(),
+                                          static_cast<std::uint64_t>(totalBytes), 0 };
+    for (const auto& column : MEASURE_COLUMNS)
+        header.push_back(rootFacts.*column.member);
+    header.push_back(url.size());
+    std::vector<std::uint64_t> stringEnds(filenameEnds);
+    for (auto& end : stringEnds)
+        end += url.size();
+    std::string strings(url);
+    strings += filenames;
+    for (const auto& language : languageNames) {
+        strings += language;
+        stringEnds.push_back(strings.size());
+    }
+    header[5] = strings.size();
+
+    // write to a temporary file so an interrupted save does not leave a partial store
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+        out.write(MAGIC.data(), MAGIC.size());
+        writeArray(out, header);
+        for (const auto& column : columns)
+            writeArray(out, column);
+        writeArray(out, std::vector<std::uint64_t>(stringEnds.cbegin(), stringEnds.cbegin() + filenameEnds.size()));
+        writeArray(out, languageColumn);
+        writeArray(out, std::vector<std::uint64_t>(stringEnds.cbegin() + filenameEnds.size(), stringEnds.cend()));
+        out.write(strings.data(), strings.size());
+        if (!out)
+            return false;
+    }
+
+    return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
+
+/*
+    Map a store
+
+    @param[in] path Store filename
+    @return Whether a valid store was mapped
+*/
+bool FactStore::open(const std::string& path) {
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    const bool mapped = file.open(fd);
+    ::close(fd);
+    if (!mapped)
+        return false;
+
+    const std::string_view data(file.data());
+    if (data.size() < HEADER_SIZE || data.compare(0, MAGIC.size(), MAGIC) != 0)
+        return false;
+    const auto header = reinterpret_cast<const std::uint64_t*>(data.data() + MAGIC.size());
+    if (header[0] != BYTE_ORDER_MARK || header[1] != VERSION)
+        return false;
+    unitCount = header[2];
+    languageCount = header[3];
+    archiveBytes = static_cast<long>(header[4]);
+    const std::uint64_t stringBytes = header[5];
+    for (int column = 0; column < MEASURE_COUNT; ++column)
+        root.*MEASURE_COLUMNS[column].member = static_cast<long>(header[6 + column]);
+    urlLength = header[6 + MEASURE_COUNT];
+
+    // sections must exactly fill the file
+    const std::uint64_t arrays = (MEASURE_COUNT + 2) * static_cast<std::uint64_t>(unitCount) + languageCount;
+    if (unitCount > data.size() || languageCount > data.size() || stringBytes > data.size() ||
+        HEADER_SIZE + arrays * sizeof(std::uint64_t) + stringBytes != data.size())
+        return false;
+    columns = reinterpret_cast<const std::int64_t*>(data.data() + HEADER_SIZE);
+    filenameEnds = reinterpret_cast<const std::uint64_t*>(columns + MEASURE_COUNT * unitCount);
+    languageColumn = filenameEnds + unitCount;
+    languageEnds = languageColumn + unitCount;
+    strings = data.substr(data.size() - stringBytes);
+
+    // offsets must be in order and within the string table, and languages in the language table
+    std::uint64_t previous = urlLength;
+    for (std::size_t i = 0; i < unitCount + languageCount; ++i) {
+        const std::uint64_t end = i < unitCount ? filenameEnds[i] : languageEnds[i - unitCount];
+        if (end < previous || end > stringBytes)
+            return false;
+        previous = end;
+    }
+    return urlLength <= stringBytes && std::all_of(languageColumn, languageColumn + unitCount, [&](std::uint64_t language) {
+        return language < languageCount;
+    });
+}
+
+/*
+    @param[in] unit Unit number
+    @return Language of the unit
+*/
+std::string_view FactStore::language(std::size_t unit) const {
+
+    const std::uint64_t number = languageColumn[unit];
+    const std::uint64_t start = number ? languageEnds[number - 1] : (unitCount ? filenameEnds[unitCount - 1] : urlLength);
+    return strings.substr(start, languageEnds[number] - start);
+}
+
+/*
+    @param[in] unit Unit number
+    @return Facts of the unit
+*/
+Facts FactStore::facts(std::size_t unit) const {
+
+    Facts unitFacts;
+    for (int column = 0; column < MEASURE_COUNT; ++column)
+        unitFacts.*MEASURE_COLUMNS[column].member = value(column, unit);
+
+    return unitFacts;
+}
@@ -0,0 +1,167 @@
+/*
+    factStore.hpp
+
+    Columnar store of the facts of each child unit of an archive, with one
+    column per measure, a filename string table, and a language column.
+    The facts outside the child units are stored separately, so the facts
+    report of the whole archive can be reproduced from the store.
+
+    The columns are in native byte order and 8-byte aligned, so a query
+    maps the file and reads only the columns it uses.
+*/
+
+#ifndef INCLUDED_FACTSTORE_HPP
+#define INCLUDED_FACTSTORE_HPP
+
+#include "facts.hpp"
+#include "mappedFile.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// measure of a column, in the order of the facts report
+struct MeasureColumn {
+    std::string_view name;
+    std::string_view label;
+    long Facts::* member;
+};
+
+inline constexpr MeasureColumn MEASURE_COLUMNS[] = {
+    { "characters",   "Characters",   &Facts::textSize },
+    { "loc",          "LOC",          &Facts::loc },
+    { "files",        "Files",        &Facts::unitCount },
+    { "classes",      "Classes",      &Facts::classCount },
+    { "functions",    "Functions",    &Facts::functionCount },
+    { "declarations", "Declarations", &Facts::declCount },
+    { "expressions",  "Expressions",  &Facts::exprCount },
+    { "comments",     "Comments",     &Facts::commentCount },
+};
+
+inline constexpr int MEASURE_COUNT = sizeof(MEASURE_COLUMNS) / sizeof(MEASURE_COLUMNS[0]);
+
+/*
+    @param[in] name Measure name, e.g., loc
+    @return Column of the measure
+    @retval -1 Unknown measure
+*/
+[[nodiscard]] int measureColumn(std::string_view name);
+
+class FactStoreWriter {
+public:
+
+    /*
+        Append the facts of a child unit
+
+        @param[in] filename Unit filename attribute
+        @param[in] language Unit language attribute
+        @param[in] facts Facts of the unit
+    */
+    void add(std::string_view filename, std::string_view language, const Facts& facts);
+
+    /*
+        Save the store
+
+        @param[in] path Store filename
+        @param[in] url Archive url attribute
+        @param[in] totalBytes Size of the archive
+        @return Whether the store was saved
+    */
+    [[nodiscard]] bool save(const std::string& path, std::string_view url, long totalBytes) const;
+
+    // facts of the archive outside the child units
+    Facts rootFacts;
+
+private:
+    std::array<std::vector<std::int64_t>, MEASURE_COUNT> columns;
+    std::vector<std::uint64_t> filenameEnds;
+    std::string filenames;
+    std::vector<std::uint64_t> languageColumn;
+    std::vector<std::string> languageNames;
+};
+
+class FactStore {
+public:
+
+    /*
+        Map a store
+
+        @param[in] path Store filename
+        @return Whether a valid store was mapped
+    */
+    [[nodiscard]] bool open(const std::string& path);
+
+    /*
+        @return Number of child units
+    */
+    [[nodiscard]] std::size_t size() const {
+        return unitCount;
+    }
+
+    /*
+        @param[in] column Measure column
+        @param[in] unit Unit number
+        @return Value of the measure for the unit
+    */
+    [[nodiscard]] long value(int column, std::size_t unit) const {
+        return static_cast<long>(columns[column * unitCount + unit]);
+    }
+
+    /*
+        @param[in] unit Unit number
+        @return Filename of the unit
+    */
+    [[nodiscard]] std::string_view filename(std::size_t unit) const {
+        const std::uint64_t start = unit ? filenameEnds[unit - 1] : urlLength;
+        return strings.substr(start, filenameEnds[unit] - start);
+    }
+
+    /*
+        @param[in] unit Unit number
+        @return Language of the unit
+    */
+    [[nodiscard]] std::string_view language(std::size_t unit) const;
+
+    /*
+        @param[in] unit Unit number
+        @return Facts of the unit
+    */
+    [[nodiscard]] Facts facts(std::size_t unit) const;
+
+    /*
+        @return Facts of the archive outside the child units
+    */
+    [[nodiscard]] const Facts& rootFacts() const {
+        return root;
+    }
+
+    /*
+        @return Archive url attribute
+    */
+    [[nodiscard]] std::string_view url() const {
+        return strings.substr(0, urlLength);
+    }
+
+    /*
+        @return Size of the archive
+    */
+    [[nodiscard]] long totalBytes() const {
+        return archiveBytes;
+    }
+
+private:
+    MappedFile file;
+    std::size_t unitCount = 0;
+    std::size_t languageCount = 0;
+    long archiveBytes = 0;
+    Facts root;
+    std::uint64_t urlLength = 0;
+    const std::int64_t* columns = nullptr;
+    const std::uint64_t* filenameEnds = nullptr;
+    const std::uint64_t* languageColumn = nullptr;
+    const std::uint64_t* languageEnds = nullptr;
+    std::string_view strings;
+};
+
+#endif
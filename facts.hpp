@@ -0,0 +1,64 @@
+/*
+    facts.hpp
+
+    Counts that make up the srcfacts report. Facts for separate parts of
+    the input, e.g., units, can be added and subtracted.
+*/
+
+#ifndef INCLUDED_FACTS_HPP
+#define INCLUDED_FACTS_HPP
+
+struct Facts {
+    long textSize = 0;
+    long loc = 0;
+    long exprCount = 0;
+    long functionCount = 0;
+    long classCount = 0;
+    long unitCount = 0;
+    long declCount = 0;
+    long commentCount = 0;
+
+    Facts& operator+=(const Facts& other) {
+        textSize += other.textSize;
+        loc += other.loc;
+        exprCount += other.exprCount;
+        functionCount += other.functionCount;
+        classCount += other.classCount;
+        unitCount += other.unitCount;
+        declCount += other.declCount;
+        commentCount += other.commentCount;
+        return *this;
+    }
+
+    Facts& operator-=(const Facts& other) {
+        textSize -= other.textSize;
+        loc -= other.loc;
+        exprCount -= other.exprCount;
+        functionCount -= other.functionCount;
+        classCount -= other.classCount;
+        unitCount -= other.unitCount;
+        declCount -= other.declCount;
+        commentCount -= other.commentCount;
+        return *this;
+    }
+
+    bool operator==(const Facts& other) const {
+        return textSize == other.textSize && loc == other.loc && exprCount == other.exprCount &&
+               functionCount == other.functionCount && classCount == other.classCount &&
+               unitCount == other.unitCount && declCount == other.declCount && commentCount == other.commentCount;
+    }
+
+    bool operator!=(const Facts& other) const {
+        return !(*this == other);
+    }
+};
+
+inline Facts operator+(Facts lhs, const Facts& rhs) {
+    return lhs += rhs;
+}
+
+inline Facts operator-(Facts lhs, const Facts& rhs) {
+    return lhs -= rhs;
+}
+
+#endif
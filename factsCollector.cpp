@@ -0,0 +1,181 @@
+/*
+    factsCollector.cpp
+
+    Collects the facts, and the analyses selected by the options, from the
+    parse events of a srcML document.
+*/
+
+#include "factsCollector.hpp"
+#include "refillContent.hpp"
+#include <cstdlib>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    constexpr auto WHITESPACE = " \n\t\r"sv;
+}
+
+/*
+    @param[in] options Analyses to collect
+*/
+FactsCollector::FactsCollector(const Options& options)
+    : topKSketch(options.approximateTop ? options.topKCounters : 1),
+      distinctSketch(options.approximateTop ? options.hllPrecision : 4),
+      unitFilter(options.includes, options.excludes, options.languages),
+      unitSample(options.sampleFraction, options.sampleSeed),
+      functionMetrics(options.functionMetrics),
+      queries(!options.queries.empty()),
+      identifiers(options.identifierTop > 0),
+      approximate(options.approximateTop > 0),
+      capturePath(!options.capture.empty()),
+      caching(!options.cachePath.empty()),
+      filtering(!options.includes.empty() || !options.excludes.empty() || !options.languages.empty()),
+      indexing(!options.writeIndexPath.empty() || options.command == "convert"),
+      storing(!options.writeStorePath.empty()),
+      diffing(options.command == "diff"),
+      sampling(options.sampleFraction > 0),
+      unitAttributes(caching || filtering || indexing || storing || diffing || sampling),
+      checkpointInterval(options.checkpointInterval),
+      contextStack(256),
+      nextCheckpoint(options.checkpointInterval) {
+
+    // a parse of srcML does not allocate for the url of the root element
+    url.reserve(BLOCK_SIZE);
+
+    // options are validated, so the queries compile
+    for (const auto& query : options.queries)
+        [[maybe_unused]] const bool valid = pathMatcher.addQuery(query, elementIds);
+    if (capturePath)
+        [[maybe_unused]] const bool valid = captureMatcher.addQuery(options.capture, elementIds);
+    captured.reserve(BLOCK_SIZE);
+}
+
+/*
+    Skipped content and end tag of the current element, a unit rejected by
+    the filter, a unit not in the sample, an unchanged unit of a diff, or a
+    cached unit
+
+    @param[in] skippedBytes Number of bytes skipped
+*/
+void FactsCollector::skippedElement(long skippedBytes) {
+
+    if (!cachedFacts) {
+        ++filteredUnits;
+        filteredBytes += skippedBytes;
+        return;
+    }
+
+    // use the cached facts
+    cacheSkipSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - skipStartTime).count();
+    cacheSkippedBytes += skippedBytes;
+    ++cacheHits;
+    facts = unitStartFacts + *cachedFacts;
+    factCache.insert(unitHash, *cachedFacts);
+}
+
+/*
+    Add the current child unit to the index
+
+    @param[in] offset Byte offset just after the unit end tag in the input
+*/
+void FactsCollector::indexUnit(long offset) {
+
+    unitIndex.add(childOffset, offset - childOffset, unitFilename, unitLanguage, unitHash);
+    unitsFacts += facts - unitStartFacts;
+}
+
+/*
+    Add the facts of the current child unit to the fact store
+*/
+void FactsCollector::storeUnit() {
+
+    const Facts unitFacts = facts - unitStartFacts;
+    factStore.add(unitFilename, unitLanguage, unitFacts);
+    storedFacts += unitFacts;
+}
+
+/*
+    Complete the fact store with the facts outside the child units
+*/
+void FactsCollector::finishStore() {
+
+    factStore.rootFacts = facts - storedFacts;
+}
+
+/*
+    Write a checkpoint of the counters
+
+    @param[in] offset Byte offset just after the end tag of a child of the root element
+*/
+void FactsCollector::checkpoint(long offset) {
+
+    Checkpoint checkpoint;
+    checkpoint.stamp = checkpointStamp;
+    checkpoint.offset = offset;
+    checkpoint.url = url;
+    checkpoint.facts = facts;
+    checkpoint.filteredUnits = filteredUnits;
+    checkpoint.filteredBytes = filteredBytes;
+    checkpointWriter->write(checkpoint);
+    nextCheckpoint = offset + checkpointInterval;
+    if (interruptAfterCheckpoint) {
+        [[maybe_unused]] const bool written = checkpointWriter->stop();
+        std::_Exit(EXIT_FAILURE);
+    }
+}
+
+/*
+    Restore the counters of a checkpoint to resume a run
+
+    @param[in] checkpoint Checkpoint
+*/
+void FactsCollector::restore(const Checkpoint& checkpoint) {
+
+    url = checkpoint.url;
+    facts = checkpoint.facts;
+    filteredUnits = checkpoint.filteredUnits;
+    filteredBytes = checkpoint.filteredBytes;
+    nextCheckpoint = checkpoint.offset + checkpointInterval;
+}
+
+/*
+    Complete the index with the facts outside the child units
+*/
+void FactsCollector::finishIndex() {
+
+    unitIndex.rootFacts = facts - unitsFacts;
+}
+
+/*
+    Start tag of the root unit of an indexed archive, before its child units
+    are parsed. The facts outside the child units are from the index.
+
+    @param[in] index Index of the archive
+*/
+void FactsCollector::replayRoot(const UnitIndex& index) {
+
+    startElement(0, "", index.rootName);
+    for (const auto& [name, value] : index.rootAttributes)
+        attribute(name, value);
+    [[maybe_unused]] const bool skip = endStartTag();
+    facts = Facts();
+}
+
+/*
+    Add the captured text, without leading and trailing whitespace
+*/
+void FactsCollector::addCaptured() {
+
+    const std::size_t first = captured.find_first_not_of(WHITESPACE);
+    if (first == captured.npos)
+        return;
+    const std::string_view text(std::string_view(captured).substr(first, captured.find_last_not_of(WHITESPACE) + 1 - first));
+    if (identifiers)
+        identifierTable.add(text);
+    if (approximate) {
+        topKSketch.add(text);
+        distinctSketch.add(text);
+    }
+}
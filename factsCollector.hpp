@@ -0,0 +1,449 @@
+/*
+    factsCollector.hpp
+
+    Collects the facts, and the analyses selected by the options, from the
+    parse events of a srcML document.
+
+    The handlers for the parse events are inline so that the parser, which
+    calls them for every tag and run of text, can inline them.
+*/
+
+#ifndef INCLUDED_FACTSCOLLECTOR_HPP
+#define INCLUDED_FACTSCOLLECTOR_HPP
+
+#include "facts.hpp"
+#include "options.hpp"
+#include "elementIds.hpp"
+#include "functionMetrics.hpp"
+#include "pathMatcher.hpp"
+#include "identifierTable.hpp"
+#include "sketches.hpp"
+#include "factCache.hpp"
+#include "unitFilter.hpp"
+#include "unitIndex.hpp"
+#include "factStore.hpp"
+#include "factDiff.hpp"
+#include "unitSample.hpp"
+#include "checkpoint.hpp"
+#include "progress.hpp"
+#include "probes.hpp"
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class FactsCollector {
+public:
+
+    /*
+        @param[in] options Analyses to collect
+    */
+    explicit FactsCollector(const Options& options);
+
+    /*
+        Character data, with entity references already converted
+
+        @param[in] characters Characters
+    */
+    void characters(std::string_view characters) {
+
+        this->characters(characters, std::count(characters.cbegin(), characters.cend(), '\n'));
+    }
+
+    /*
+        Character data with the number of newlines already counted, e.g., from a token stream
+
+        @param[in] characters Characters
+        @param[in] newlines Number of newlines in the characters
+    */
+    void characters(std::string_view characters, long newlines) {
+
+        facts.loc += newlines;
+        facts.textSize += characters.size();
+        if (functionMetrics)
+            functionMetricsCollector.characters(characters, newlines);
+        if (inCapture)
+            captured += characters;
+    }
+
+    /*
+        Start tag name, before any attributes
+
+        @param[in] depth Number of open ancestor elements
+        @param[in] prefix Element namespace prefix
+        @param[in] localName Element local name
+    */
+    void startElement(int depth, std::string_view prefix, std::string_view localName) {
+
+        startElement(depth, prefix, localName, elementIds.intern(localName));
+    }
+
+    /*
+        Start tag name with the local name already interned, e.g., from a token stream
+
+        @param[in] depth Number of open ancestor elements
+        @param[in] prefix Element namespace prefix
+        @param[in] localName Element local name
+        @param[in] id ID of the local name from elementIds
+    */
+    void startElement(int depth, std::string_view prefix, std::string_view localName, int id) {
+
+        elementId = id;
+        tagDepth = depth;
+        if (indexing && depth == 0)
+            unitIndex.rootName = localName;
+        childUnit = depth == 1 && elementId == UNIT;
+        if (childUnit && unitAttributesNeeded()) {
+            unitNumber = nextUnitNumber++;
+            unitStartFacts = facts;
+            rejectedUnit = false;
+            unitHash.clear();
+            unitFilename.clear();
+            unitLanguage.clear();
+        }
+        switch (elementId) {
+        case EXPR:
+            ++facts.exprCount;
+            break;
+        case DECL:
+            ++facts.declCount;
+            break;
+        case COMMENT:
+            ++facts.commentCount;
+            break;
+        case FUNCTION:
+            ++facts.functionCount;
+            break;
+        case UNIT:
+            ++facts.unitCount;
+            break;
+        case CLASS:
+            ++facts.classCount;
+            break;
+        }
+        if (functionMetrics)
+            functionMetricsCollector.startElement(elementId, !prefix.empty());
+        if (queries)
+            pathMatcher.startElement(depth, prefix, elementId);
+        if ((identifiers || approximate) && !capturePath) {
+            inCapture = elementId == NAME;
+            captured.clear();
+        }
+        if (capturePath)
+            captureMatcher.startElement(depth, prefix, elementId);
+    }
+
+    /*
+        Attribute of the current start tag
+
+        @param[in] localName Attribute local name
+        @param[in] value Attribute value
+    */
+    void attribute(std::string_view localName, std::string_view value) {
+
+        if (tagDepth == 0 && localName == "url")
+            url = value;
+        if (childUnit && unitAttributesNeeded()) {
+            if (localName == "hash")
+                unitHash = value;
+            else if (localName == "filename")
+                unitFilename = value;
+            else if (localName == "language")
+                unitLanguage = value;
+        }
+        if (indexing && tagDepth == 0)
+            unitIndex.rootAttributes.emplace_back(localName, value);
+        if (queries)
+            pathMatcher.attribute(localName, value);
+        if (capturePath)
+            captureMatcher.attribute(localName, value);
+    }
+
+    /*
+        End of the current start tag, '>'
+
+        @return Whether to skip the content and end tag of the element
+    */
+    [[nodiscard]] bool endStartTag() {
+
+        if (childUnit && SRCFACTS_PROBE_ENABLED(unit__start))
+            SRCFACTS_PROBE2(unit__start, unitFilename.c_str(), childOffset);
+        if (childUnit && filtering && !unitFilter.selected(unitFilename, unitLanguage)) {
+            // a rejected unit is not counted at all
+            facts = unitStartFacts;
+            rejectedUnit = true;
+            cachedFacts = nullptr;
+            return true;
+        }
+        if (sampling && childUnit && !unitSample.selected(unitNumber)) {
+            // a unit not in the sample is estimated from the sampled units
+            unitSample.skip();
+            facts = unitStartFacts;
+            rejectedUnit = true;
+            cachedFacts = nullptr;
+            return true;
+        }
+        if (diffing && childUnit && factDiff->unchanged(diffSide, unitFilename, unitHash)) {
+            // an unchanged unit is counted from the other archive
+            facts = unitStartFacts;
+            rejectedUnit = true;
+            cachedFacts = nullptr;
+            return true;
+        }
+        if (caching && childUnit && !unitHash.empty()) {
+            ++cacheUnits;
+            cachedFacts = factCache.find(unitHash);
+            if (cachedFacts) {
+                skipStartTime = std::chrono::steady_clock::now();
+                return true;
+            }
+        }
+        if (queries)
+            pathMatcher.endStartTag();
+        if (capturePath)
+            captureMatcher.endStartTag();
+        if (capturePath && !inCapture && captureMatcher.matched(0)) {
+            inCapture = true;
+            captureDepth = tagDepth;
+            captured.clear();
+        }
+        if (tagDepth >= static_cast<int>(contextStack.size()))
+            contextStack.resize(contextStack.size() * 2);
+        contextStack[tagDepth] = elementId;
+        return false;
+    }
+
+    /*
+        End of the current start tag of an empty element, '/>'
+    */
+    void endEmptyElement() {
+
+        if (childUnit && SRCFACTS_PROBE_ENABLED(unit__start))
+            SRCFACTS_PROBE2(unit__start, unitFilename.c_str(), childOffset);
+        if (queries)
+            pathMatcher.endStartTag();
+        if (capturePath)
+            captureMatcher.endStartTag();
+        if (functionMetrics)
+            functionMetricsCollector.endElement(elementId);
+        if (!capturePath)
+            inCapture = false;
+    }
+
+    /*
+        Skipped content and end tag of the current element, a unit rejected by
+        the filter, a unit not in the sample, an unchanged unit of a diff, or a
+        cached unit
+
+        @param[in] skippedBytes Number of bytes skipped
+    */
+    void skippedElement(long skippedBytes);
+
+    /*
+        Start tag of a child of the root element, after its name
+
+        @param[in] offset Byte offset of the start tag in the input
+    */
+    void childStart(long offset) {
+
+        childOffset = offset;
+        inChildUnit = childUnit;
+    }
+
+    /*
+        End of a child of the root element
+
+        @param[in] offset Byte offset just after the end tag in the input
+    */
+    void childEnd(long offset) {
+
+        if (indexing && inChildUnit)
+            indexUnit(offset);
+        if (storing && inChildUnit && !rejectedUnit)
+            storeUnit();
+        if (diffing && inChildUnit && !rejectedUnit)
+            factDiff->add(diffSide, facts - unitStartFacts);
+        if (sampling && inChildUnit && !rejectedUnit)
+            unitSample.add(facts - unitStartFacts);
+        if (checkpointWriter && offset >= nextCheckpoint)
+            checkpoint(offset);
+        if (progress && inChildUnit)
+            progress->unitEnd();
+        if (inChildUnit && SRCFACTS_PROBE_ENABLED(unit__end))
+            SRCFACTS_PROBE2(unit__end, unitFilename.c_str(), offset);
+    }
+
+    /*
+        Complete the index with the facts outside the child units
+    */
+    void finishIndex();
+
+    /*
+        Restore the counters of a checkpoint to resume a run
+
+        @param[in] checkpoint Checkpoint
+    */
+    void restore(const Checkpoint& checkpoint);
+
+    /*
+        Complete the fact store with the facts outside the child units
+    */
+    void finishStore();
+
+    /*
+        Start tag of the root unit of an indexed archive, before its child units
+        are parsed. The facts outside the child units are from the index.
+
+        @param[in] index Index of the archive
+    */
+    void replayRoot(const UnitIndex& index);
+
+    /*
+        End tag
+
+        @param[in] depth Number of open ancestor elements
+    */
+    void endElement(int depth) {
+
+        if (caching && depth == 1 && contextStack[depth] == UNIT && !unitHash.empty())
+            factCache.insert(unitHash, facts - unitStartFacts);
+        if (functionMetrics)
+            functionMetricsCollector.endElement(contextStack[depth]);
+        if (inCapture && (!capturePath || depth == captureDepth)) {
+            addCaptured();
+            inCapture = false;
+        }
+    }
+
+    Facts facts;
+    std::string url;
+    ElementIds elementIds;
+
+    // analyses
+    FunctionMetricsCollector functionMetricsCollector;
+    PathMatcher pathMatcher;
+    IdentifierTable identifierTable;
+    SpaceSaving topKSketch;
+    HyperLogLog distinctSketch;
+
+    // cache, and statistics of cached units
+    FactCache factCache;
+    long cacheUnits = 0;
+    long cacheHits = 0;
+    long cacheSkippedBytes = 0;
+    double cacheSkipSeconds = 0;
+
+    // units rejected by the filter, not in the sample, or unchanged in a diff
+    long filteredUnits = 0;
+    long filteredBytes = 0;
+
+    UnitFilter unitFilter;
+
+    // index of the child units, complete after finishIndex()
+    UnitIndex unitIndex;
+
+    // facts of each child unit, complete after finishStore()
+    FactStoreWriter factStore;
+
+    // diff of two archives shared with the collector of the other archive, and the archive of this collector
+    FactDiff* factDiff = nullptr;
+    DiffSide diffSide = OLD_ARCHIVE;
+
+    // sampled child units, and the position in the archive of the next child unit
+    UnitSample unitSample;
+    long nextUnitNumber = 0;
+
+    // writer of checkpoints, and the input identity for them
+    CheckpointWriter* checkpointWriter = nullptr;
+    FileStamp checkpointStamp;
+    // exit after the first checkpoint, as an interrupted run, for tests
+    bool interruptAfterCheckpoint = false;
+    // live progress of the run
+    Progress* progress = nullptr;
+
+private:
+
+    /*
+        @return Whether the attributes of child units are needed, by the analyses or an attached unit probe
+    */
+    [[nodiscard]] bool unitAttributesNeeded() const {
+
+        return unitAttributes || SRCFACTS_PROBE_ENABLED(unit__start) || SRCFACTS_PROBE_ENABLED(unit__end);
+    }
+
+    /*
+        Add the captured text, without leading and trailing whitespace
+    */
+    void addCaptured();
+
+    /*
+        Add the current child unit to the index
+
+        @param[in] offset Byte offset just after the unit end tag in the input
+    */
+    void indexUnit(long offset);
+
+    /*
+        Add the facts of the current child unit to the fact store
+    */
+    void storeUnit();
+
+    /*
+        Write a checkpoint of the counters
+
+        @param[in] offset Byte offset just after the end tag of a child of the root element
+    */
+    void checkpoint(long offset);
+
+    bool functionMetrics;
+    bool queries;
+    bool identifiers;
+    bool approximate;
+    bool capturePath;
+    bool caching;
+    bool filtering;
+    bool indexing;
+    bool storing;
+    bool diffing;
+    bool sampling;
+    // attributes of child units are needed
+    bool unitAttributes;
+    // uncompressed input bytes between checkpoints
+    long checkpointInterval;
+
+    // current start tag
+    int elementId = 0;
+    int tagDepth = 0;
+    bool childUnit = false;
+
+    // element IDs of the open elements, indexed by depth
+    std::vector<int> contextStack;
+
+    // captured text is the text of name elements without child elements, or of elements matching --capture
+    PathMatcher captureMatcher;
+    bool inCapture = false;
+    int captureDepth = 0;
+    std::string captured;
+
+
+    // current child unit
+    Facts unitStartFacts;
+    std::string unitHash;
+    std::string unitFilename;
+    std::string unitLanguage;
+    long childOffset = 0;
+    bool inChildUnit = false;
+    // position of the current child unit in the archive
+    long unitNumber = 0;
+    long nextCheckpoint;
+    // unit rejected by the filter, not in the sample, or unchanged in a diff, so not counted here
+    bool rejectedUnit = false;
+    // facts of all indexed child units, and of all stored child units
+    Facts unitsFacts;
+    Facts storedFacts;
+    const Facts* cachedFacts = nullptr;
+    std::chrono::steady_clock::time_point skipStartTime;
+};
+
+#endif
@@ -0,0 +1,97 @@
+/*
+    functionMetrics.cpp
+
+    Per-function metrics collected while streaming.
+*/
+
+#include "functionMetrics.hpp"
+#include "elementIds.hpp"
+#include <algorithm>
+
+/*
+    Start of an element
+
+    @param[in] id Interned ID of the element local name
+    @param[in] hasPrefix Element has a namespace prefix, e.g., cpp:if
+*/
+void FunctionMetricsCollector::startElement(int id, bool hasPrefix) {
+
+    if (id == FUNCTION) {
+        openFunctions.emplace_back();
+        return;
+    }
+    if (openFunctions.empty())
+        return;
+
+    FunctionMetrics& current = openFunctions.back();
+    switch (id) {
+    case EXPR:
+        ++current.exprCount;
+        break;
+    case DECL:
+        ++current.declCount;
+        break;
+    case IF:
+    case WHILE:
+    case FOR:
+    case CASE:
+    case TERNARY:
+    case DO:
+    case FOREACH:
+        // preprocessor elements, e.g., cpp:if, are not decisions
+        if (!hasPrefix)
+            ++current.decisionCount;
+        break;
+    case OPERATOR:
+        inOperator = true;
+        operatorSize = 0;
+        break;
+    }
+}
+
+/*
+    End of an element, including empty elements
+
+    @param[in] id Interned ID of the element local name
+*/
+void FunctionMetricsCollector::endElement(int id) {
+
+    if (openFunctions.empty())
+        return;
+
+    if (id == OPERATOR) {
+        inOperator = false;
+        if (operatorSize == 2 && operatorText[0] == operatorText[1] && (operatorText[0] == '&' || operatorText[0] == '|'))
+            ++openFunctions.back().decisionCount;
+    } else if (id == FUNCTION) {
+        const FunctionMetrics& function = openFunctions.back();
+        locHistogram.add(function.loc);
+        exprHistogram.add(function.exprCount);
+        declHistogram.add(function.declCount);
+        decisionHistogram.add(function.decisionCount);
+        complexityHistogram.add(function.decisionCount + 1);
+        openFunctions.pop_back();
+    }
+}
+
+/*
+    Character data, with entity references already converted
+
+    @param[in] characters Characters
+    @param[in] newlines Number of newlines in the characters
+*/
+void FunctionMetricsCollector::characters(std::string_view characters, long newlines) {
+
+    if (openFunctions.empty())
+        return;
+
+    openFunctions.back().loc += static_cast<int>(newlines);
+
+    if (inOperator) {
+        for (const char c : characters) {
+            if (operatorSize < 2)
+                operatorText[operatorSize] = c;
+            ++operatorSize;
+        }
+    }
+}
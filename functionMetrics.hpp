@@ -0,0 +1,70 @@
+/*
+    functionMetrics.hpp
+
+    Per-function metrics collected while streaming: LOC, expressions,
+    declarations, and decision points for cyclomatic complexity.
+
+    Metrics are attributed to the innermost enclosing function. Decision
+    points are the srcML elements if, while, for, case, and ternary, and
+    the operators && and ||.
+*/
+
+#ifndef INCLUDED_FUNCTIONMETRICS_HPP
+#define INCLUDED_FUNCTIONMETRICS_HPP
+
+#include "histogram.hpp"
+#include <string_view>
+#include <vector>
+
+struct FunctionMetrics {
+    int loc = 1;
+    int exprCount = 0;
+    int declCount = 0;
+    int decisionCount = 0;
+};
+
+class FunctionMetricsCollector {
+public:
+
+    /*
+        Start of an element
+
+        @param[in] id Interned ID of the element local name
+        @param[in] hasPrefix Element has a namespace prefix, e.g., cpp:if
+    */
+    void startElement(int id, bool hasPrefix);
+
+    /*
+        End of an element, including empty elements
+
+        @param[in] id Interned ID of the element local name
+    */
+    void endElement(int id);
+
+    /*
+        Character data, with entity references already converted
+
+        @param[in] characters Characters
+        @param[in] newlines Number of newlines in the characters
+    */
+    void characters(std::string_view characters, long newlines);
+
+    // histograms over all completed functions
+    Histogram locHistogram;
+    Histogram exprHistogram;
+    Histogram declHistogram;
+    Histogram decisionHistogram;
+    Histogram complexityHistogram;
+
+private:
+
+    // metrics of the currently open functions, innermost last
+    std::vector<FunctionMetrics> openFunctions;
+
+    // leading characters of the current operator, to detect && and ||
+    bool inOperator = false;
+    char operatorText[2] = { 0, 0 };
+    int operatorSize = 0;
+};
+
+#endif
@@ -0,0 +1,51 @@
+/*
+    hashBytes.hpp
+
+    Fast non-cryptographic hash for short byte strings, e.g., identifiers
+    and filenames. Reads eight bytes at a time with a multiply-xorshift mix.
+*/
+
+#ifndef INCLUDED_HASHBYTES_HPP
+#define INCLUDED_HASHBYTES_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/*
+    Hash of a byte string
+
+    @param[in] bytes Bytes to hash
+    @param[in] seed Seed for independent hash functions
+    @return 64-bit hash
+*/
+[[nodiscard]] inline std::uint64_t hashBytes(std::string_view bytes, std::uint64_t seed = 0) {
+
+    const std::uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+    std::uint64_t hash = (seed + bytes.size()) * MULTIPLIER;
+    const char* data = bytes.data();
+    std::size_t size = bytes.size();
+    while (size >= 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data, 8);
+        hash = (hash ^ word) * MULTIPLIER;
+        hash ^= hash >> 29;
+        data += 8;
+        size -= 8;
+    }
+    if (size) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, data, size);
+        hash = (hash ^ word) * MULTIPLIER;
+        hash ^= hash >> 29;
+    }
+
+    // final avalanche
+    hash ^= hash >> 32;
+    hash *= 0xD6E8FEB86659FD93ULL;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*
+    histogram.cpp
+
+    Exact histogram of small non-negative integer values.
+*/
+
+#include "histogram.hpp"
+#include <algorithm>
+#include <cmath>
+
+/*
+    Add the values of another histogram
+
+    @param[in] other Histogram
+    @return This histogram
+*/
+Histogram& Histogram::operator+=(const Histogram& other) {
+
+    if (other.counts.size() > counts.size())
+        counts.resize(other.counts.size(), 0);
+    for (std::size_t value = 0; value < other.counts.size(); ++value)
+        counts[value] += other.counts[value];
+    total += other.total;
+
+    return *this;
+}
+
+/*
+    @return Smallest value, or 0 when empty
+*/
+int Histogram::min() const {
+
+    for (std::size_t value = 0; value < counts.size(); ++value) {
+        if (counts[value])
+            return static_cast<int>(value);
+    }
+
+    return 0;
+}
+
+/*
+    Nearest-rank percentile
+
+    @param[in] percent Percentile in the range (0, 100]
+    @return Smallest value with at least percent of the values at or below it, or 0 when empty
+*/
+int Histogram::percentile(double percent) const {
+
+    const long rank = std::max(1L, static_cast<long>(std::ceil(percent / 100 * total)));
+    long cumulative = 0;
+    for (std::size_t value = 0; value < counts.size(); ++value) {
+        cumulative += counts[value];
+        if (cumulative >= rank)
+            return static_cast<int>(value);
+    }
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+/*
+    histogram.hpp
+
+    Exact histogram of small non-negative integer values, with one count
+    per value. Memory is proportional to the largest value, not to the
+    number of values.
+*/
+
+#ifndef INCLUDED_HISTOGRAM_HPP
+#define INCLUDED_HISTOGRAM_HPP
+
+#include <vector>
+
+class Histogram {
+public:
+
+    /*
+        Add a value
+
+        @param[in] value Non-negative value
+    */
+    void add(int value) {
+        if (value >= static_cast<int>(counts.size()))
+            counts.resize(value + 1, 0);
+        ++counts[value];
+        ++total;
+    }
+
+    /*
+        Add a number of occurrences of a value
+
+        @param[in] value Non-negative value
+        @param[in] count Number of occurrences
+    */
+    void add(int value, long count) {
+        if (value >= static_cast<int>(counts.size()))
+            counts.resize(value + 1, 0);
+        counts[value] += count;
+        total += count;
+    }
+
+    /*
+        Add the values of another histogram
+
+        @param[in] other Histogram
+        @return This histogram
+    */
+    Histogram& operator+=(const Histogram& other);
+
+    /*
+        @return Number of occurrences of each value, from 0 to the largest value
+    */
+    [[nodiscard]] const std::vector<long>& valueCounts() const {
+        return counts;
+    }
+
+    /*
+        @return Number of values
+    */
+    [[nodiscard]] long size() const {
+        return total;
+    }
+
+    /*
+        @return Smallest value, or 0 when empty
+    */
+    [[nodiscard]] int min() const;
+
+    /*
+        @return Largest value, or 0 when empty
+    */
+    [[nodiscard]] int max() const {
+        return total ? static_cast<int>(counts.size()) - 1 : 0;
+    }
+
+    /*
+        Nearest-rank percentile
+
+        @param[in] percent Percentile in the range (0, 100]
+        @return Smallest value with at least percent of the values at or below it, or 0 when empty
+    */
+    [[nodiscard]] int percentile(double percent) const;
+
+private:
+    std::vector<long> counts;
+    long total = 0;
+};
+
+#endif
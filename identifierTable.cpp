@@ -0,0 +1,130 @@
+/*
+    identifierTable.cpp
+
+    Exact frequency table for millions of short strings.
+*/
+
+#include "identifierTable.hpp"
+#include "hashBytes.hpp"
+#include <algorithm>
+
+namespace {
+
+    const std::size_t INITIAL_SLOTS = 1 << 16;
+    const std::size_t CHUNK_SIZE = 1 << 20;
+}
+
+IdentifierTable::IdentifierTable() : slots(INITIAL_SLOTS, 0) {
+
+    entries.reserve(INITIAL_SLOTS / 2);
+}
+
+/*
+    Count an occurrence of a string
+
+    @param[in] text String to count
+*/
+void IdentifierTable::add(std::string_view text) {
+
+    ++totalCount;
+    const std::uint64_t hash = hashBytes(text);
+    const std::uint64_t fingerprint = hash & 0xFFFFFFFF00000000ULL;
+    const std::size_t mask = slots.size() - 1;
+    std::size_t position = hash & mask;
+    while (slots[position]) {
+        if ((slots[position] & 0xFFFFFFFF00000000ULL) == fingerprint) {
+            Entry& entry = entries[(slots[position] & 0xFFFFFFFF) - 1];
+            if (std::string_view(entry.text, entry.size) == text) {
+                ++entry.count;
+                return;
+            }
+        }
+        position = (position + 1) & mask;
+    }
+
+    // new string
+    entries.push_back({ store(text), static_cast<std::uint32_t>(text.size()), 1 });
+    slots[position] = fingerprint | entries.size();
+
+    // keep the load factor at or below 0.7
+    if (entries.size() * 10 > slots.size() * 7)
+        grow();
+}
+
+/*
+    Double the number of slots and reinsert all entries
+*/
+void IdentifierTable::grow() {
+
+    slots.assign(slots.size() * 2, 0);
+    const std::size_t mask = slots.size() - 1;
+    for (std::size_t index = 0; index < entries.size(); ++index) {
+        const std::uint64_t hash = hashBytes(std::string_view(entries[index].text, entries[index].size));
+        std::size_t position = hash & mask;
+        while (slots[position])
+            position = (position + 1) & mask;
+        slots[position] = (hash & 0xFFFFFFFF00000000ULL) | (index + 1);
+    }
+}
+
+/*
+    Copy of the string in the arena
+
+    @param[in] text String to copy
+    @return Pointer to the copy
+*/
+const char* IdentifierTable::store(std::string_view text) {
+
+    if (text.size() > chunkRemaining) {
+        const std::size_t chunkSize = std::max(CHUNK_SIZE, text.size());
+        chunks.emplace_back(new char[chunkSize]);
+        chunkNext = chunks.back().get();
+        chunkRemaining = chunkSize;
+        arenaBytes += chunkSize;
+    }
+    char* copy = chunkNext;
+    std::copy(text.cbegin(), text.cend(), copy);
+    chunkNext += text.size();
+    chunkRemaining -= text.size();
+
+    return copy;
+}
+
+/*
+    @return Bytes used by the slots, entries, and arena
+*/
+std::size_t IdentifierTable::memoryUsage() const {
+
+    return slots.capacity() * sizeof(slots[0]) + entries.capacity() * sizeof(entries[0]) + arenaBytes;
+}
+
+/*
+    Most frequent strings, ties in string order
+
+    @param[in] n Maximum number of strings
+    @return Strings with their counts, most frequent first
+*/
+std::vector<std::pair<std::string_view, long>> IdentifierTable::top(std::size_t n) const {
+
+    std::vector<std::uint32_t> indices(entries.size());
+    for (std::size_t index = 0; index < entries.size(); ++index)
+        indices[index] = static_cast<std::uint32_t>(index);
+
+    n = std::min(n, indices.size());
+    std::partial_sort(indices.begin(), indices.begin() + n, indices.end(), [this](std::uint32_t lhs, std::uint32_t rhs) {
+        const Entry& left = entries[lhs];
+        const Entry& right = entries[rhs];
+        if (left.count != right.count)
+            return left.count > right.count;
+        return std::string_view(left.text, left.size) < std::string_view(right.text, right.size);
+    });
+
+    std::vector<std::pair<std::string_view, long>> result;
+    result.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const Entry& entry = entries[indices[i]];
+        result.emplace_back(std::string_view(entry.text, entry.size), entry.count);
+    }
+
+    return result;
+}
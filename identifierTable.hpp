@@ -0,0 +1,100 @@
+/*
+    identifierTable.hpp
+
+    Exact frequency table for millions of short strings, e.g., identifiers.
+
+    The strings are copied once into an arena of large chunks. The hash
+    table uses open addressing with linear probing over 8-byte slots that
+    hold a 32-bit hash fingerprint and an entry index, so a probe usually
+    touches a single cache line and compares strings only on a fingerprint
+    match.
+*/
+
+#ifndef INCLUDED_IDENTIFIERTABLE_HPP
+#define INCLUDED_IDENTIFIERTABLE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class IdentifierTable {
+public:
+
+    IdentifierTable();
+
+    /*
+        Count an occurrence of a string
+
+        @param[in] text String to count
+    */
+    void add(std::string_view text);
+
+    /*
+        @return Number of distinct strings
+    */
+    [[nodiscard]] std::size_t size() const {
+        return entries.size();
+    }
+
+    /*
+        @return Number of occurrences of all strings
+    */
+    [[nodiscard]] long total() const {
+        return totalCount;
+    }
+
+    /*
+        @return Fraction of hash table slots in use
+    */
+    [[nodiscard]] double load() const {
+        return static_cast<double>(entries.size()) / slots.size();
+    }
+
+    /*
+        @return Bytes used by the slots, entries, and arena
+    */
+    [[nodiscard]] std::size_t memoryUsage() const;
+
+    /*
+        Most frequent strings, ties in string order
+
+        @param[in] n Maximum number of strings
+        @return Strings with their counts, most frequent first
+    */
+    [[nodiscard]] std::vector<std::pair<std::string_view, long>> top(std::size_t n) const;
+
+private:
+
+    /*
+        Copy of the string in the arena
+
+        @param[in] text String to copy
+        @return Pointer to the copy
+    */
+    [[nodiscard]] const char* store(std::string_view text);
+
+    void grow();
+
+    // 16 bytes, since a single string occurs fewer than 2^32 times
+    struct Entry {
+        const char* text;
+        std::uint32_t size;
+        std::uint32_t count;
+    };
+
+    // fingerprint in the high 32 bits, entry index + 1 in the low 32 bits, 0 for empty
+    std::vector<std::uint64_t> slots;
+    std::vector<Entry> entries;
+
+    // arena of string chunks
+    std::vector<std::unique_ptr<char[]>> chunks;
+    char* chunkNext = nullptr;
+    std::size_t chunkRemaining = 0;
+    std::size_t arenaBytes = 0;
+
+    long totalCount = 0;
+};
+
+#endif
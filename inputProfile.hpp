@@ -0,0 +1,127 @@
+/*
+    inputProfile.hpp
+
+    Token mix of the input: the number and bytes of each kind of markup,
+    the distribution of the lengths of runs of character data, and the
+    distribution of the number of attributes of start tags. Collected in
+    the main loop of the parser from the offsets before and after each
+    token, so it costs a few additions per token.
+*/
+
+#ifndef INCLUDED_INPUTPROFILE_HPP
+#define INCLUDED_INPUTPROFILE_HPP
+
+#include "phaseTimes.hpp"
+#include "histogram.hpp"
+#include <algorithm>
+
+// number of power-of-two buckets of text run lengths
+const int TEXT_RUN_BUCKETS = 32;
+
+class InputProfile {
+public:
+
+    /*
+        Add a token
+
+        @param[in] phase Kind of markup, from the phases of the main loop, or PROLOG_PHASE outside the root element
+        @param[in] bytes Size of the token, including any attributes
+    */
+    void add(Phase phase, long bytes) {
+
+        ++tokens[phase];
+        tokenBytes[phase] += bytes;
+        if (phase == CHARACTERS_PHASE) {
+            const int bucket = lengthBucket(bytes);
+            ++textRuns[bucket];
+            textRunTotals[bucket] += bytes;
+        }
+    }
+
+    /*
+        Add the attributes of a start tag
+
+        @param[in] count Number of attributes, including namespace declarations
+        @param[in] bytes Size of the attributes
+    */
+    void addAttributes(int count, long bytes) {
+
+        attributeCounts.add(count);
+        attributeBytes += bytes;
+    }
+
+    /*
+        @param[in] phase Kind of markup
+        @return Number of tokens of the kind
+    */
+    [[nodiscard]] long count(Phase phase) const {
+        return tokens[phase];
+    }
+
+    /*
+        @param[in] phase Kind of markup
+        @return Bytes of the tokens of the kind, for start tags without the attributes
+    */
+    [[nodiscard]] long bytes(Phase phase) const {
+        return tokenBytes[phase] - (phase == START_TAG_PHASE ? attributeBytes : 0);
+    }
+
+    /*
+        @return Bytes of the attributes of start tags
+    */
+    [[nodiscard]] long attributesBytes() const {
+        return attributeBytes;
+    }
+
+    /*
+        @return Number of start tags with each number of attributes
+    */
+    [[nodiscard]] const Histogram& attributesPerTag() const {
+        return attributeCounts;
+    }
+
+    /*
+        @param[in] bucket Bucket of lengths from 2^bucket to 2^(bucket + 1) - 1
+        @return Number of text runs with a length in the bucket
+    */
+    [[nodiscard]] long textRunCount(int bucket) const {
+        return textRuns[bucket];
+    }
+
+    /*
+        @param[in] bucket Bucket of lengths from 2^bucket to 2^(bucket + 1) - 1
+        @return Bytes of the text runs with a length in the bucket
+    */
+    [[nodiscard]] long textRunBytes(int bucket) const {
+        return textRunTotals[bucket];
+    }
+
+private:
+
+    /*
+        @param[in] length Length
+        @return Power-of-two bucket of the length, with 0 in the first bucket
+    */
+    static int lengthBucket(long length) {
+
+        if (length <= 1)
+            return 0;
+#if defined(__GNUC__) || defined(__clang__)
+        return std::min(TEXT_RUN_BUCKETS - 1, 63 - __builtin_clzll(static_cast<unsigned long long>(length)));
+#else
+        int bucket = 0;
+        while (length >>= 1)
+            ++bucket;
+        return std::min(TEXT_RUN_BUCKETS - 1, bucket);
+#endif
+    }
+
+    long tokens[PHASE_COUNT] = {};
+    long tokenBytes[PHASE_COUNT] = {};
+    long attributeBytes = 0;
+    Histogram attributeCounts;
+    long textRuns[TEXT_RUN_BUCKETS] = {};
+    long textRunTotals[TEXT_RUN_BUCKETS] = {};
+};
+
+#endif
@@ -0,0 +1,38 @@
+/*
+    mappedFile.cpp
+
+    Read-only memory mapping of a regular file.
+*/
+
+#include "mappedFile.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile::~MappedFile() {
+
+    if (address)
+        munmap(address, size);
+}
+
+/*
+    Map a file
+
+    @param[in] fd Open file descriptor of a regular file
+    @return Whether the file was mapped
+*/
+bool MappedFile::open(int fd) {
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size == 0)
+        return false;
+
+    void* mapped = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED)
+        return false;
+    address = mapped;
+    size = status.st_size;
+    // units are read in order
+    madvise(address, size, MADV_SEQUENTIAL);
+
+    return true;
+}
@@ -0,0 +1,41 @@
+/*
+    mappedFile.hpp
+
+    Read-only memory mapping of a regular file, e.g., standard input
+    redirected from an uncompressed srcML file.
+*/
+
+#ifndef INCLUDED_MAPPEDFILE_HPP
+#define INCLUDED_MAPPEDFILE_HPP
+
+#include <string_view>
+
+class MappedFile {
+public:
+
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /*
+        Map a file
+
+        @param[in] fd Open file descriptor of a regular file
+        @return Whether the file was mapped
+    */
+    [[nodiscard]] bool open(int fd);
+
+    /*
+        @return Contents of the file
+    */
+    [[nodiscard]] std::string_view data() const {
+        return std::string_view(static_cast<const char*>(address), size);
+    }
+
+private:
+    void* address = nullptr;
+    std::size_t size = 0;
+};
+
+#endif
@@ -0,0 +1,31 @@
+/*
+    memoryUsage.cpp
+
+    Memory used by the process.
+*/
+
+#include "memoryUsage.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+/*
+    @return Peak resident set size of the process in bytes, or 0 where unknown
+*/
+long peakResidentBytes() {
+
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    // bytes on macOS, KB elsewhere
+    return static_cast<long>(usage.ru_maxrss);
+#else
+    return static_cast<long>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,30 @@
+/*
+    memoryUsage.hpp
+
+    Memory used by the process: the peak resident set size, and, when the
+    counting allocator is linked in, the heap allocations through operator
+    new.
+*/
+
+#ifndef INCLUDED_MEMORYUSAGE_HPP
+#define INCLUDED_MEMORYUSAGE_HPP
+
+struct AllocationCounts {
+    long allocations = 0;
+    long bytes = 0;
+};
+
+/*
+    @return Peak resident set size of the process in bytes, or 0 where unknown
+*/
+[[nodiscard]] long peakResidentBytes();
+
+/*
+    Counts of the heap allocations so far, from allocationCounter.cpp, which
+    replaces the global operator new. Only defined when it is linked in.
+
+    @return Number of allocations and bytes allocated
+*/
+[[nodiscard]] AllocationCounts allocationCounts();
+
+#endif
@@ -0,0 +1,288 @@
+/*
+    options.cpp
+
+    Command-line options of srcfacts.
+*/
+
+#include "options.hpp"
+#include "elementIds.hpp"
+#include "pathMatcher.hpp"
+#include "factStore.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <string_view>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    /*
+        @param[in] query Path query
+        @return Whether the query compiles
+    */
+    bool validQuery(std::string_view query) {
+
+        ElementIds elementIds;
+        PathMatcher pathMatcher;
+        return pathMatcher.addQuery(query, elementIds);
+    }
+}
+
+/*
+    Parse the command-line options. Errors are output to standard error.
+
+    @param[in] argc Number of arguments
+    @param[in] argv Arguments
+    @param[out] options Parsed options
+    @return Whether the options are valid
+*/
+bool parseOptions(int argc, char* argv[], Options& options) {
+
+    // convert an archive file to a block-compressed archive file, compile a srcML file to a token stream,
+    // or diff two archive files
+    if (argc > 1 && (argv[1] == "convert"sv || argv[1] == "compile"sv || argv[1] == "diff"sv)) {
+        if (argc != 4) {
+            std::cerr << "srcfacts: Usage: srcfacts " << argv[1] << (argv[1] == "diff"sv ? " OLD NEW\n" : " INPUT OUTPUT\n");
+            return false;
+        }
+        options.command = argv[1];
+        options.files.assign(argv + 2, argv + argc);
+        return true;
+    }
+
+    // merge partial results files
+    if (argc > 1 && argv[1] == "merge"sv) {
+        if (argc < 3) {
+            std::cerr << "srcfacts: Usage: srcfacts merge PARTIAL...\n";
+            return false;
+        }
+        options.command = argv[1];
+        options.files.assign(argv + 2, argv + argc);
+        return true;
+    }
+
+    // query a fact store
+    if (argc > 1 && argv[1] == "query"sv) {
+        if (argc < 3) {
+            std::cerr << "srcfacts: Usage: srcfacts query STORE [--top=N] [--by=MEASURE] [--prefix=PATH]\n";
+            return false;
+        }
+        options.command = argv[1];
+        options.files.assign(argv + 2, argv + 3);
+        for (int i = 3; i < argc; ++i) {
+            const std::string_view arg(argv[i]);
+            if (arg.compare(0, "--top="sv.size(), "--top="sv) == 0) {
+                options.storeTop = std::atoi(arg.data() + "--top="sv.size());
+                if (options.storeTop <= 0) {
+                    std::cerr << "srcfacts: Invalid number of files " << arg << '\n';
+                    return false;
+                }
+            } else if (arg.compare(0, "--by="sv.size(), "--by="sv) == 0) {
+                options.storeMeasure = arg.substr("--by="sv.size());
+                if (measureColumn(options.storeMeasure) < 0) {
+                    std::cerr << "srcfacts: Unknown measure " << options.storeMeasure << '\n';
+                    return false;
+                }
+            } else if (arg.compare(0, "--prefix="sv.size(), "--prefix="sv) == 0) {
+                options.storePrefix = arg.substr("--prefix="sv.size());
+            } else {
+                std::cerr << "srcfacts: Unknown option " << arg << '\n';
+                return false;
+            }
+        }
+        return true;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        if (arg == "--function-metrics"sv) {
+            options.functionMetrics = true;
+        } else if (arg == "--identifiers"sv) {
+            options.identifierTop = 20;
+        } else if (arg.compare(0, "--identifiers="sv.size(), "--identifiers="sv) == 0) {
+            options.identifierTop = std::atoi(arg.data() + "--identifiers="sv.size());
+            if (options.identifierTop <= 0) {
+                std::cerr << "srcfacts: Invalid number of identifiers " << arg << '\n';
+                return false;
+            }
+        } else if (arg == "--approx"sv) {
+            options.approximateTop = 20;
+        } else if (arg.compare(0, "--approx="sv.size(), "--approx="sv) == 0) {
+            options.approximateTop = std::atoi(arg.data() + "--approx="sv.size());
+            if (options.approximateTop <= 0) {
+                std::cerr << "srcfacts: Invalid number of approximate identifiers " << arg << '\n';
+                return false;
+            }
+        } else if (arg.compare(0, "--topk-counters="sv.size(), "--topk-counters="sv) == 0) {
+            options.topKCounters = std::atoi(arg.data() + "--topk-counters="sv.size());
+            if (options.topKCounters <= 0) {
+                std::cerr << "srcfacts: Invalid number of top-k counters " << arg << '\n';
+                return false;
+            }
+        } else if (arg.compare(0, "--hll-precision="sv.size(), "--hll-precision="sv) == 0) {
+            options.hllPrecision = std::atoi(arg.data() + "--hll-precision="sv.size());
+            if (options.hllPrecision < 4 || options.hllPrecision > 18) {
+                std::cerr << "srcfacts: HyperLogLog precision must be from 4 to 18 " << arg << '\n';
+                return false;
+            }
+        } else if (arg.compare(0, "--capture="sv.size(), "--capture="sv) == 0) {
+            const std::string_view query(arg.substr("--capture="sv.size()));
+            if (!options.capture.empty() || !validQuery(query)) {
+                std::cerr << "srcfacts: Invalid capture " << query << '\n';
+                return false;
+            }
+            options.capture = query;
+        } else if (arg.compare(0, "--cache="sv.size(), "--cache="sv) == 0) {
+            options.cachePath = arg.substr("--cache="sv.size());
+        } else if (arg.compare(0, "--include="sv.size(), "--include="sv) == 0) {
+            options.includes.emplace_back(arg.substr("--include="sv.size()));
+        } else if (arg.compare(0, "--exclude="sv.size(), "--exclude="sv) == 0) {
+            options.excludes.emplace_back(arg.substr("--exclude="sv.size()));
+        } else if (arg.compare(0, "--language="sv.size(), "--language="sv) == 0) {
+            options.languages.emplace_back(arg.substr("--language="sv.size()));
+        } else if (arg.compare(0, "--write-index="sv.size(), "--write-index="sv) == 0) {
+            options.writeIndexPath = arg.substr("--write-index="sv.size());
+        } else if (arg.compare(0, "--index="sv.size(), "--index="sv) == 0) {
+            options.indexPath = arg.substr("--index="sv.size());
+        } else if (arg.compare(0, "--write-store="sv.size(), "--write-store="sv) == 0) {
+            options.writeStorePath = arg.substr("--write-store="sv.size());
+        } else if (arg.compare(0, "--write-partial="sv.size(), "--write-partial="sv) == 0) {
+            options.writePartialPath = arg.substr("--write-partial="sv.size());
+        } else if (arg.compare(0, "--checkpoint="sv.size(), "--checkpoint="sv) == 0) {
+            options.checkpointPath = arg.substr("--checkpoint="sv.size());
+        } else if (arg.compare(0, "--checkpoint-interval="sv.size(), "--checkpoint-interval="sv) == 0) {
+            options.checkpointInterval = std::atol(arg.data() + "--checkpoint-interval="sv.size());
+            if (options.checkpointInterval <= 0) {
+                std::cerr << "srcfacts: Invalid checkpoint interval " << arg << '\n';
+                return false;
+            }
+        } else if (arg == "--resume"sv) {
+            options.resume = true;
+        } else if (arg == "--phase-times"sv) {
+            options.phaseTimes = true;
+        } else if (arg == "--perf-counters"sv) {
+            options.perfCounters = true;
+        } else if (arg == "--profile-input"sv) {
+            options.profileInput = true;
+        } else if (arg.compare(0, "--trace="sv.size(), "--trace="sv) == 0) {
+            options.tracePath = arg.substr("--trace="sv.size());
+        } else if (arg == "--memory"sv) {
+            options.memoryUsage = true;
+        } else if (arg == "--check-allocations"sv) {
+            options.checkAllocations = true;
+        } else if (arg == "--progress"sv) {
+            options.progress = true;
+        } else if (arg.compare(0, "--threads="sv.size(), "--threads="sv) == 0) {
+            options.threads = std::atoi(arg.data() + "--threads="sv.size());
+            if (options.threads <= 0) {
+                std::cerr << "srcfacts: Invalid number of threads " << arg << '\n';
+                return false;
+            }
+        } else if (arg.compare(0, "--sample="sv.size(), "--sample="sv) == 0) {
+            options.sampleFraction = std::atof(arg.data() + "--sample="sv.size());
+            if (!(options.sampleFraction > 0 && options.sampleFraction <= 1)) {
+                std::cerr << "srcfacts: Invalid sample fraction " << arg << '\n';
+                return false;
+            }
+        } else if (arg.compare(0, "--seed="sv.size(), "--seed="sv) == 0) {
+            options.sampleSeed = std::strtoul(arg.data() + "--seed="sv.size(), nullptr, 10);
+        } else if (arg.compare(0, "--query="sv.size(), "--query="sv) == 0) {
+            const std::string_view query(arg.substr("--query="sv.size()));
+            if (!validQuery(query)) {
+                std::cerr << "srcfacts: Invalid query " << query << '\n';
+                return false;
+            }
+            options.queries.emplace_back(query);
+        } else {
+            std::cerr << "srcfacts: Unknown option " << arg << '\n';
+            return false;
+        }
+    }
+
+    // cached child units are skipped, so only facts can be cached
+    if (!options.cachePath.empty() && (options.functionMetrics || !options.queries.empty() || options.identifierTop ||
+                                       options.approximateTop || !options.capture.empty())) {
+        std::cerr << "srcfacts: --cache only applies to the facts, and cannot be used with other analyses\n";
+        return false;
+    }
+
+    if (!options.writeIndexPath.empty() && !options.indexPath.empty()) {
+        std::cerr << "srcfacts: --write-index and --index cannot be used together\n";
+        return false;
+    }
+
+    // threads each collect the facts of some of the units, and only facts are combined
+    const bool analyses = options.functionMetrics || !options.queries.empty() || options.identifierTop ||
+                          options.approximateTop || !options.capture.empty();
+    if (options.threads > 1 && (analyses || !options.cachePath.empty() || !options.writeStorePath.empty())) {
+        std::cerr << "srcfacts: --threads only applies to the facts\n";
+        return false;
+    }
+
+    // the estimates are only of the facts, and the sample is of units by their position in the archive
+    if (options.sampleFraction > 0 && (analyses || !options.cachePath.empty() || !options.writeIndexPath.empty() ||
+                                       !options.writeStorePath.empty())) {
+        std::cerr << "srcfacts: --sample only applies to the facts\n";
+        return false;
+    }
+    // checkpoints are of the facts of a single pass over the srcML input
+    if (options.resume && options.checkpointPath.empty()) {
+        std::cerr << "srcfacts: --resume requires --checkpoint\n";
+        return false;
+    }
+    if (!options.checkpointPath.empty() && (analyses || !options.cachePath.empty() || !options.indexPath.empty() ||
+                                            !options.writeIndexPath.empty() || !options.writeStorePath.empty() ||
+                                            options.threads > 1 || options.sampleFraction > 0)) {
+        std::cerr << "srcfacts: --checkpoint only applies to the facts of srcML input\n";
+        return false;
+    }
+    // identifier tables and sketches are not merged, and estimates are not exact
+    if (!options.writePartialPath.empty() && (options.identifierTop || options.approximateTop || options.sampleFraction > 0)) {
+        std::cerr << "srcfacts: --write-partial only applies to the facts, function metrics, and queries\n";
+        return false;
+    }
+    // phases, counters, profiles, traces, and progress are of a single parse of the srcML input
+    const std::string_view instrumentation = instrumentationOption(options);
+    if (!instrumentation.empty() && (!options.indexPath.empty() || options.threads > 1)) {
+        std::cerr << "srcfacts: " << instrumentation << " only applies to a single parse of srcML input\n";
+        return false;
+    }
+    // the other analyses, and the options for units, allocate in the parse
+    if (options.checkAllocations && (analyses || !options.cachePath.empty() || !options.indexPath.empty() || !options.writeIndexPath.empty() ||
+                                     !options.writeStorePath.empty() || !options.writePartialPath.empty() || !options.checkpointPath.empty() ||
+                                     !options.includes.empty() || !options.excludes.empty() || !options.languages.empty() ||
+                                     options.threads > 1 || options.sampleFraction > 0)) {
+        std::cerr << "srcfacts: --check-allocations only applies to the default facts of srcML input\n";
+        return false;
+    }
+    if (options.sampleFraction > 0 && options.threads > 1 && options.indexPath.empty()) {
+        std::cerr << "srcfacts: --sample with --threads requires --index\n";
+        return false;
+    }
+
+    return true;
+}
+
+/*
+    Option that instruments a single parse of srcML input, i.e., the phase
+    times, perf counters, input profile, parse trace, or progress
+
+    @param[in] options Options
+    @return First instrumentation option given, e.g., "--phase-times", or empty for none
+*/
+std::string_view instrumentationOption(const Options& options) {
+
+    if (options.phaseTimes)
+        return "--phase-times"sv;
+    if (options.perfCounters)
+        return "--perf-counters"sv;
+    if (options.profileInput)
+        return "--profile-input"sv;
+    if (!options.tracePath.empty())
+        return "--trace"sv;
+    if (options.progress)
+        return "--progress"sv;
+
+    return ""sv;
+}
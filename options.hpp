@@ -0,0 +1,83 @@
+/*
+    options.hpp
+
+    Command-line options of srcfacts.
+*/
+
+#ifndef INCLUDED_OPTIONS_HPP
+#define INCLUDED_OPTIONS_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct Options {
+    // subcommand, i.e., convert, compile, query, diff, or merge, with its files
+    std::string command;
+    std::vector<std::string> files;
+    bool functionMetrics = false;
+    // path queries to count
+    std::vector<std::string> queries;
+    // path query of the elements to capture text from, empty for identifiers
+    std::string capture;
+    int identifierTop = 0;
+    int approximateTop = 0;
+    int topKCounters = 10000;
+    int hllPrecision = 14;
+    std::string cachePath;
+    // unit filter
+    std::vector<std::string> includes;
+    std::vector<std::string> excludes;
+    std::vector<std::string> languages;
+    // unit index
+    std::string writeIndexPath;
+    std::string indexPath;
+    int threads = 1;
+    // fact store, and its queries
+    std::string writeStorePath;
+    int storeTop = 0;
+    std::string storeMeasure = "loc";
+    std::string storePrefix;
+    // fraction of the child units sampled, 0 for all units
+    double sampleFraction = 0;
+    unsigned long sampleSeed = 1;
+    std::string writePartialPath;
+    // checkpoints, the uncompressed input bytes between them, and whether to resume from the last one
+    std::string checkpointPath;
+    long checkpointInterval = 64 * 1024 * 1024;
+    bool resume = false;
+    // breakdown of the parse time into phases
+    bool phaseTimes = false;
+    // hardware performance counters of the parse
+    bool perfCounters = false;
+    // token mix of the input
+    bool profileInput = false;
+    // binary trace file of the parse events
+    std::string tracePath;
+    // peak RSS and heap allocations, and whether the parse must not allocate
+    bool memoryUsage = false;
+    bool checkAllocations = false;
+    // live progress line on standard error
+    bool progress = false;
+};
+
+/*
+    Parse the command-line options. Errors are output to standard error.
+
+    @param[in] argc Number of arguments
+    @param[in] argv Arguments
+    @param[out] options Parsed options
+    @return Whether the options are valid
+*/
+[[nodiscard]] bool parseOptions(int argc, char* argv[], Options& options);
+
+/*
+    Option that instruments a single parse of srcML input, i.e., the phase
+    times, perf counters, input profile, parse trace, or progress
+
+    @param[in] options Options
+    @return First instrumentation option given, e.g., "--phase-times", or empty for none
+*/
+[[nodiscard]] std::string_view instrumentationOption(const Options& options);
+
+#endif
@@ -0,0 +1,205 @@
+/*
+    parseBench.cpp
+
+    Benchmark suite of the parser on synthetic srcML archives, with no input
+    files needed. For each scenario, a mix of content and an archive size,
+    the archive is generated in memory, then parsed with the default facts
+    for a number of warmup runs, which are not timed, and timed runs. The
+    median and 95th percentile throughput of the timed runs are output,
+    where the 95th percentile is of the run times, i.e., the slow runs.
+
+    Usage: srcfacts_bench [--mix=MIX]... [--size=SIZE]... [--repeat=N] [--warmup=N] [--seed=N]
+           srcfacts_bench --output=FILE [--mix=MIX] [--size=SIZE] [--seed=N]
+
+    A mix is a predefined mix, text, tags, nesting, comments, attributes,
+    cdata, entities, or mixed, or the weights of the kinds of content, e.g.,
+    text:3,entities:1. The default is all predefined mixes. A size is in
+    bytes with an optional K, M, or G suffix, e.g., 1M or 10G. The default
+    is 16M. With --output, the archive, of the mixed mix by default, is
+    written to the file a unit at a time, so it can be larger than memory,
+    e.g., as input for srcfacts itself.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <locale>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <cmath>
+#include <vector>
+#include "options.hpp"
+#include "refillContent.hpp"
+#include "factsCollector.hpp"
+#include "srcMLParser.hpp"
+#include "syntheticArchive.hpp"
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    /*
+        @param[in] arg Command-line argument
+        @param[in] option Option name with '=', e.g., "--size="
+        @return Whether the argument is the option
+    */
+    bool isOption(std::string_view arg, std::string_view option) {
+
+        return arg.compare(0, option.size(), option) == 0;
+    }
+
+    /*
+        Parse a size in bytes with an optional K, M, or G suffix, in powers of 1000
+
+        @param[in] text Size, e.g., "10G"
+        @param[out] size Size in bytes
+        @return Whether the size is valid
+    */
+    bool parseSize(std::string_view text, long& size) {
+
+        const auto result = std::from_chars(text.data(), text.data() + text.size(), size);
+        if (result.ec != std::errc{} || size <= 0)
+            return false;
+        const std::string_view suffix(result.ptr, text.data() + text.size() - result.ptr);
+        if (suffix == "K"sv)
+            size *= 1000;
+        else if (suffix == "M"sv)
+            size *= 1000 * 1000;
+        else if (suffix == "G"sv)
+            size *= 1000 * 1000 * 1000;
+        else if (!suffix.empty())
+            return false;
+
+        return true;
+    }
+
+    /*
+        @param[in] seconds Times of the runs, sorted
+        @param[in] percent Percentile, 0 to 100
+        @return Time at the percentile, nearest rank
+    */
+    double percentile(const std::vector<double>& seconds, int percent) {
+
+        const std::size_t rank = static_cast<std::size_t>(std::ceil(percent / 100.0 * seconds.size()));
+        return seconds[std::max<std::size_t>(rank, 1) - 1];
+    }
+}
+
+int main(int argc, char* argv[]) {
+
+    std::vector<SyntheticMix> mixes;
+    std::vector<long> sizes;
+    int repeat = 10;
+    int warmup = 2;
+    std::uint64_t seed = 1;
+    std::string outputFilename;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        if (isOption(arg, "--mix="sv)) {
+            SyntheticMix mix;
+            if (!parseSyntheticMix(arg.substr("--mix="sv.size()), mix)) {
+                std::cerr << "srcfacts_bench: Invalid mix " << arg << '\n';
+                return 1;
+            }
+            mixes.push_back(mix);
+        } else if (isOption(arg, "--size="sv)) {
+            long size = 0;
+            if (!parseSize(arg.substr("--size="sv.size()), size)) {
+                std::cerr << "srcfacts_bench: Invalid size " << arg << '\n';
+                return 1;
+            }
+            sizes.push_back(size);
+        } else if (isOption(arg, "--repeat="sv)) {
+            repeat = std::atoi(arg.data() + "--repeat="sv.size());
+            if (repeat <= 0) {
+                std::cerr << "srcfacts_bench: Invalid number of repetitions " << arg << '\n';
+                return 1;
+            }
+        } else if (isOption(arg, "--warmup="sv)) {
+            const std::string_view value = arg.substr("--warmup="sv.size());
+            const auto result = std::from_chars(value.data(), value.data() + value.size(), warmup);
+            if (result.ec != std::errc{} || result.ptr != value.data() + value.size() || warmup < 0) {
+                std::cerr << "srcfacts_bench: Invalid number of warmup runs " << arg << '\n';
+                return 1;
+            }
+        } else if (isOption(arg, "--seed="sv)) {
+            const std::string_view value = arg.substr("--seed="sv.size());
+            const auto result = std::from_chars(value.data(), value.data() + value.size(), seed);
+            if (result.ec != std::errc{} || result.ptr != value.data() + value.size()) {
+                std::cerr << "srcfacts_bench: Invalid seed " << arg << '\n';
+                return 1;
+            }
+        } else if (isOption(arg, "--output="sv)) {
+            outputFilename = arg.substr("--output="sv.size());
+        } else {
+            std::cerr << "srcfacts_bench: Unknown option " << arg << '\n';
+            return 1;
+        }
+    }
+    if (mixes.empty() && !outputFilename.empty())
+        mixes.push_back(syntheticMixes().back());
+    else if (mixes.empty())
+        mixes = syntheticMixes();
+    if (sizes.empty())
+        sizes.push_back(16 * 1000 * 1000);
+
+    // write a single archive instead of benchmarking
+    if (!outputFilename.empty()) {
+        if (mixes.size() > 1 || sizes.size() > 1) {
+            std::cerr << "srcfacts_bench: --output is for a single mix and size\n";
+            return 1;
+        }
+        std::ofstream out(outputFilename, std::ios::binary);
+        if (!out || !writeSyntheticArchive(out, mixes.front(), sizes.front(), seed)) {
+            std::cerr << "srcfacts_bench: Unable to write " << outputFilename << '\n';
+            return 1;
+        }
+        return 0;
+    }
+
+    std::cout.imbue(std::locale{""});
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "| Scenario             |  Size MB |    MLOC | Median MB/s | P95 MB/s | Median MLOC/s | P95 MLOC/s |\n";
+    std::cout << "|:---------------------|---------:|--------:|------------:|---------:|--------------:|-----------:|\n";
+    for (const auto& size : sizes) {
+        for (const auto& mix : mixes) {
+
+            const std::string archive = syntheticArchive(mix, size, seed);
+            std::vector<double> seconds;
+            long loc = 0;
+            for (int run = 0; run < warmup + repeat; ++run) {
+                InputSource input;
+                input.openMemory(archive);
+                FactsCollector collector(Options{});
+                const auto startTime = std::chrono::steady_clock::now();
+                if (parseSrcML(input, collector) != 0) {
+                    std::cerr << "srcfacts_bench: Invalid synthetic archive for mix " << mix.name << '\n';
+                    return 1;
+                }
+                const double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+                if (run >= warmup)
+                    seconds.push_back(runSeconds);
+                loc = collector.facts.loc;
+            }
+            std::sort(seconds.begin(), seconds.end());
+
+            const double mb = archive.size() / 1000000.0;
+            const double mloc = loc / 1000000.0;
+            const double medianSeconds = percentile(seconds, 50);
+            const double p95Seconds = percentile(seconds, 95);
+            std::cout << "| " << std::setw(20) << std::left << mix.name << std::right
+                      << " | " << std::setw(8) << mb
+                      << " | " << std::setw(7) << std::setprecision(3) << mloc << std::setprecision(1)
+                      << " | " << std::setw(11) << mb / medianSeconds
+                      << " | " << std::setw(8) << mb / p95Seconds
+                      << " | " << std::setw(13) << std::setprecision(2) << mloc / medianSeconds
+                      << " | " << std::setw(10) << mloc / p95Seconds << std::setprecision(1) << " |\n";
+        }
+    }
+
+    return 0;
+}
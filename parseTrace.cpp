@@ -0,0 +1,149 @@
+/*
+    parseTrace.cpp
+
+    Binary trace of the parse events.
+*/
+
+#include "parseTrace.hpp"
+#include "binaryIO.hpp"
+#include <algorithm>
+#include <chrono>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    // identifies a trace file, and its version
+    constexpr auto TRACE_MAGIC = "SRCFTRC1"sv;
+}
+
+ParseTrace::~ParseTrace() {
+
+    if (writer.joinable()) {
+        stopping.store(true, std::memory_order_release);
+        writer.join();
+    }
+}
+
+/*
+    Create the trace file and start the writer
+
+    @param[in] path Filename
+    @return Whether the file was created
+*/
+bool ParseTrace::start(const std::string& path) {
+
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+    out.write(TRACE_MAGIC.data(), TRACE_MAGIC.size());
+    events = std::make_unique<TraceEvent[]>(CAPACITY);
+    writer = std::thread(&ParseTrace::writeEvents, this);
+
+    return true;
+}
+
+/*
+    Wait until the writer frees space in the buffer
+*/
+void ParseTrace::waitForSpace() {
+
+    while ((cachedTail = consumed.load(std::memory_order_acquire)) == head - CAPACITY)
+        std::this_thread::yield();
+}
+
+/*
+    Write the events until stopped
+*/
+void ParseTrace::writeEvents() {
+
+    std::uint64_t tail = 0;
+    while (true) {
+        // the last check for events is after the stop, so none are left
+        const bool stopped = stopping.load(std::memory_order_acquire);
+        const std::uint64_t available = published.load(std::memory_order_acquire);
+        if (available == tail) {
+            if (stopped)
+                return;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        // the events up to the end of the buffer, and then any that wrapped around
+        const std::uint64_t start = tail & (CAPACITY - 1);
+        const std::uint64_t count = std::min(available - tail, CAPACITY - start);
+        if (!writeError && !out.write(reinterpret_cast<const char*>(&events[start]), count * sizeof(TraceEvent)))
+            writeError = true;
+        tail += count;
+        consumed.store(tail, std::memory_order_release);
+    }
+}
+
+/*
+    Stop the writer, and write the rest of the events and the names
+
+    @return Whether the trace file was written
+*/
+bool ParseTrace::stop() {
+
+    if (!writer.joinable())
+        return false;
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+
+    const std::uint64_t namesOffset = static_cast<std::uint64_t>(out.tellp());
+    writeInteger(out, names.size());
+    for (int id = 0; id < names.size(); ++id)
+        writeString(out, names.name(id));
+    writeInteger(out, namesOffset);
+    out.close();
+
+    return !writeError && static_cast<bool>(out);
+}
+
+/*
+    Open a trace file, and load its names
+
+    @param[in] path Filename
+    @return Whether the file is a complete trace
+*/
+bool TraceReader::open(const std::string& path) {
+
+    in.open(path, std::ios::binary);
+    char magic[TRACE_MAGIC.size()];
+    if (!in.read(magic, sizeof(magic)) || std::string_view(magic, sizeof(magic)) != TRACE_MAGIC)
+        return false;
+
+    // the names are at the end, after the events
+    std::uint64_t namesOffset;
+    if (!in.seekg(-8, std::ios::end) || !readInteger(in, namesOffset) || namesOffset < TRACE_MAGIC.size() ||
+        (namesOffset - TRACE_MAGIC.size()) % sizeof(TraceEvent) != 0)
+        return false;
+    std::uint64_t count;
+    if (!in.seekg(static_cast<std::streamoff>(namesOffset)) || !readInteger(in, count))
+        return false;
+    names.resize(count);
+    for (auto& name : names) {
+        if (!readString(in, name))
+            return false;
+    }
+    remaining = (namesOffset - TRACE_MAGIC.size()) / sizeof(TraceEvent);
+
+    return static_cast<bool>(in.seekg(TRACE_MAGIC.size()));
+}
+
+/*
+    Read the next event
+
+    @param[out] event Event read
+    @return Whether there was another event
+*/
+bool TraceReader::next(TraceEvent& event) {
+
+    if (remaining == 0 || !in.read(reinterpret_cast<char*>(&event), sizeof(event)))
+        return false;
+    --remaining;
+
+    return true;
+}
@@ -0,0 +1,168 @@
+/*
+    parseTrace.hpp
+
+    Binary trace of the parse events. Each event is 16 bytes: its type, the
+    offset of its data in the input, the interned ID of its name, e.g., the
+    qName of a tag, and the length of its data. The text of the events,
+    e.g., character data and attribute values, is not copied, so the decoder
+    reads it from the same input.
+
+    Events are added to a lock-free single-producer, single-consumer ring
+    buffer, and a background thread writes them to the trace file. When
+    the buffer is full, the parser waits for the writer, so no event is
+    lost.
+
+    Trace file: the magic, the events in the byte order of the machine,
+    the interned names as length-prefixed strings, and the offset of the
+    names.
+*/
+
+#ifndef INCLUDED_PARSETRACE_HPP
+#define INCLUDED_PARSETRACE_HPP
+
+#include "elementIds.hpp"
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// types of trace events
+enum TraceEventType : std::uint8_t { START_DOCUMENT_EVENT, XML_DECLARATION_EVENT, DOCTYPE_EVENT, CHARACTERS_EVENT,
+                                     COMMENT_EVENT, CDATA_EVENT, PI_EVENT, END_TAG_EVENT, START_TAG_EVENT, NAMESPACE_EVENT,
+                                     ATTRIBUTE_EVENT, SKIP_ELEMENT_EVENT, END_DOCUMENT_EVENT, TRACE_EVENT_TYPES };
+
+// headers of the events in the text of a trace
+inline constexpr std::string_view TRACE_EVENT_HEADERS[TRACE_EVENT_TYPES] = {
+    "START DOCUMENT", "XML DECLARATION", "DOCTYPE", "CHARACTERS", "COMMENT", "CDATA", "PI", "END TAG", "START TAG",
+    "NAMESPACE", "ATTRIBUTE", "SKIP ELEMENT", "END DOCUMENT"
+};
+
+// name ID of an event without a name
+const std::uint32_t NO_TRACE_NAME = 0xFFFFFFFF;
+
+struct TraceEvent {
+    // offset in the low 56 bits, type in the high 8 bits
+    std::uint64_t offsetType;
+    std::uint32_t name;
+    std::uint32_t length;
+
+    [[nodiscard]] TraceEventType type() const {
+        return static_cast<TraceEventType>(offsetType >> 56);
+    }
+
+    [[nodiscard]] long offset() const {
+        return static_cast<long>(offsetType & ((std::uint64_t(1) << 56) - 1));
+    }
+};
+static_assert(sizeof(TraceEvent) == 16);
+
+class ParseTrace {
+public:
+
+    ParseTrace() = default;
+    ~ParseTrace();
+    ParseTrace(const ParseTrace&) = delete;
+    ParseTrace& operator=(const ParseTrace&) = delete;
+
+    /*
+        Create the trace file and start the writer
+
+        @param[in] path Filename
+        @return Whether the file was created
+    */
+    [[nodiscard]] bool start(const std::string& path);
+
+    /*
+        Add an event, waiting for the writer when the buffer is full
+
+        @param[in] type Type of event
+        @param[in] offset Offset of the data of the event in the input
+        @param[in] length Length of the data
+        @param[in] name Name of the event, or empty for none
+    */
+    void add(TraceEventType type, long offset, std::size_t length, std::string_view name) {
+
+        if (head - cachedTail == CAPACITY)
+            waitForSpace();
+        TraceEvent& event = events[head & (CAPACITY - 1)];
+        event.offsetType = (std::uint64_t(type) << 56) | static_cast<std::uint64_t>(offset);
+        event.name = name.empty() ? NO_TRACE_NAME : static_cast<std::uint32_t>(names.intern(name));
+        event.length = static_cast<std::uint32_t>(length);
+        ++head;
+        published.store(head, std::memory_order_release);
+    }
+
+    /*
+        Stop the writer, and write the rest of the events and the names
+
+        @return Whether the trace file was written
+    */
+    [[nodiscard]] bool stop();
+
+private:
+
+    /*
+        Wait until the writer frees space in the buffer
+    */
+    void waitForSpace();
+
+    /*
+        Write the events until stopped
+    */
+    void writeEvents();
+
+    // number of events in the buffer, a power of two
+    static const std::uint64_t CAPACITY = 1 << 18;
+
+    std::unique_ptr<TraceEvent[]> events;
+    ElementIds names;
+    std::ofstream out;
+    std::thread writer;
+    bool writeError = false;
+    // producer position, and its last view of the consumer position
+    std::uint64_t head = 0;
+    std::uint64_t cachedTail = 0;
+    // on separate cache lines, since one thread writes each
+    alignas(64) std::atomic<std::uint64_t> published = 0;
+    alignas(64) std::atomic<std::uint64_t> consumed = 0;
+    std::atomic<bool> stopping = false;
+};
+
+class TraceReader {
+public:
+
+    /*
+        Open a trace file, and load its names
+
+        @param[in] path Filename
+        @return Whether the file is a complete trace
+    */
+    [[nodiscard]] bool open(const std::string& path);
+
+    /*
+        Read the next event
+
+        @param[out] event Event read
+        @return Whether there was another event
+    */
+    [[nodiscard]] bool next(TraceEvent& event);
+
+    /*
+        @param[in] id Name ID of an event
+        @return Name, or empty for NO_TRACE_NAME
+    */
+    [[nodiscard]] std::string_view name(std::uint32_t id) const {
+        return id < names.size() ? std::string_view(names[id]) : std::string_view();
+    }
+
+private:
+    std::ifstream in;
+    std::vector<std::string> names;
+    std::uint64_t remaining = 0;
+};
+
+#endif
@@ -0,0 +1,250 @@
+/*
+    partialResults.cpp
+
+    Results of a run that can be merged with the results of other runs.
+*/
+
+#include "partialResults.hpp"
+#include "binaryIO.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    constexpr auto MAGIC = "SRCFACTS-PARTIAL\n"sv;
+    const std::uint64_t VERSION = 1;
+
+    // tags of the sections
+    enum Section : std::uint64_t {
+        // url count, urls, total bytes, files, facts
+        FACTS_SECTION = 1,
+        // for each histogram, the number of values and the count of each value
+        FUNCTION_METRICS_SECTION,
+        // number of queries, and the text and count of each
+        QUERIES_SECTION,
+    };
+
+    // sections are whole files at most, so anything longer is a corrupt file
+    const std::uint64_t SECTION_LIMIT = std::uint64_t(1) << 40;
+
+    /*
+        Write a section
+
+        @param[in, out] out Output stream
+        @param[in] tag Section tag
+        @param[in] section Contents of the section
+    */
+    void writeSection(std::ostream& out, Section tag, const std::ostringstream& section) {
+
+        const std::string contents = section.str();
+        writeInteger(out, tag);
+        writeInteger(out, contents.size());
+        out.write(contents.data(), contents.size());
+    }
+
+    /*
+        Read the facts section
+
+        @param[in, out] in Contents of the section
+        @param[out] results Results
+        @return Whether the section was read
+    */
+    bool readFactsSection(std::istream& in, PartialResults& results) {
+
+        std::uint64_t urlCount = 0;
+        if (!readInteger(in, urlCount) || urlCount > (1 << 20))
+            return false;
+        results.urls.resize(urlCount);
+        for (auto& url : results.urls) {
+            if (!readString(in, url))
+                return false;
+        }
+
+        return readInteger(in, results.totalBytes) && readInteger(in, results.files) && readFacts(in, results.facts);
+    }
+
+    /*
+        Read the function metrics section
+
+        @param[in, out] in Contents of the section
+        @param[out] results Results
+        @return Whether the section was read
+    */
+    bool readFunctionMetricsSection(std::istream& in, PartialResults& results) {
+
+        results.functionMetrics = true;
+        for (auto& histogram : results.histograms) {
+            std::uint64_t values = 0;
+            if (!readInteger(in, values) || values > (1 << 30))
+                return false;
+            for (std::uint64_t value = 0; value < values; ++value) {
+                long count = 0;
+                if (!readInteger(in, count) || count < 0)
+                    return false;
+                if (count)
+                    histogram.add(static_cast<int>(value), count);
+            }
+        }
+
+        return true;
+    }
+
+    /*
+        Read the queries section
+
+        @param[in, out] in Contents of the section
+        @param[out] results Results
+        @return Whether the section was read
+    */
+    bool readQueriesSection(std::istream& in, PartialResults& results) {
+
+        std::uint64_t queryCount = 0;
+        if (!readInteger(in, queryCount) || queryCount > (1 << 20))
+            return false;
+        results.queryCounts.resize(queryCount);
+        for (auto& [text, count] : results.queryCounts) {
+            if (!readString(in, text) || !readInteger(in, count))
+                return false;
+        }
+
+        return true;
+    }
+}
+
+/*
+    Merge the results of another run
+
+    @param[in] other Results of another run
+    @return These results
+*/
+PartialResults& PartialResults::operator+=(const PartialResults& other) {
+
+    for (const auto& url : other.urls) {
+        if (std::find(urls.cbegin(), urls.cend(), url) == urls.cend())
+            urls.push_back(url);
+    }
+    totalBytes += other.totalBytes;
+    files += other.files;
+    facts += other.facts;
+    if (other.functionMetrics) {
+        functionMetrics = true;
+        for (int i = 0; i < FUNCTION_METRICS_COUNT; ++i)
+            histograms[i] += other.histograms[i];
+    }
+
+    // queries are matched by their text, and new queries are added in order
+    for (const auto& [text, count] : other.queryCounts) {
+        const auto found = std::find_if(queryCounts.begin(), queryCounts.end(), [&text = text](const auto& queryCount) {
+            return queryCount.first == text;
+        });
+        if (found != queryCounts.end())
+            found->second += count;
+        else
+            queryCounts.emplace_back(text, count);
+    }
+
+    return *this;
+}
+
+/*
+    Save results, replacing the file
+
+    @param[in] path Partial results filename
+    @param[in] results Results
+    @return Whether the results were saved
+*/
+bool savePartialResults(const std::string& path, const PartialResults& results) {
+
+    // write to a temporary file so a job runner never sees a partial file
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+        out.write(MAGIC.data(), MAGIC.size());
+        writeInteger(out, VERSION);
+
+        std::ostringstream factsSection;
+        writeInteger(factsSection, results.urls.size());
+        for (const auto& url : results.urls)
+            writeString(factsSection, url);
+        writeInteger(factsSection, results.totalBytes);
+        writeInteger(factsSection, results.files);
+        writeFacts(factsSection, results.facts);
+        writeSection(out, FACTS_SECTION, factsSection);
+
+        if (results.functionMetrics) {
+            std::ostringstream functionMetricsSection;
+            for (const auto& histogram : results.histograms) {
+                writeInteger(functionMetricsSection, histogram.valueCounts().size());
+                for (const auto count : histogram.valueCounts())
+                    writeInteger(functionMetricsSection, count);
+            }
+            writeSection(out, FUNCTION_METRICS_SECTION, functionMetricsSection);
+        }
+
+        if (!results.queryCounts.empty()) {
+            std::ostringstream queriesSection;
+            writeInteger(queriesSection, results.queryCounts.size());
+            for (const auto& [text, count] : results.queryCounts) {
+                writeString(queriesSection, text);
+                writeInteger(queriesSection, count);
+            }
+            writeSection(out, QUERIES_SECTION, queriesSection);
+        }
+        if (!out)
+            return false;
+    }
+
+    return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
+
+/*
+    Load results
+
+    @param[in] path Partial results filename
+    @param[out] results Results
+    @return Whether valid results were loaded
+*/
+bool loadPartialResults(const std::string& path, PartialResults& results) {
+
+    std::ifstream in(path, std::ios::binary);
+    std::string magic(MAGIC.size(), ' ');
+    std::uint64_t version = 0;
+    if (!in.read(magic.data(), magic.size()) || magic != MAGIC || !readInteger(in, version) || version != VERSION)
+        return false;
+
+    // the facts section is required, and unknown sections are from a later release, so are skipped
+    bool factsRead = false;
+    std::uint64_t tag = 0;
+    std::uint64_t length = 0;
+    std::string contents;
+    while (in.peek() != std::char_traits<char>::eof()) {
+        if (!readInteger(in, tag) || !readInteger(in, length) || length > SECTION_LIMIT)
+            return false;
+        contents.resize(length);
+        if (!in.read(contents.data(), length))
+            return false;
+        std::istringstream section(contents);
+        bool valid = true;
+        switch (tag) {
+        case FACTS_SECTION:
+            valid = readFactsSection(section, results);
+            factsRead = valid;
+            break;
+        case FUNCTION_METRICS_SECTION:
+            valid = readFunctionMetricsSection(section, results);
+            break;
+        case QUERIES_SECTION:
+            valid = readQueriesSection(section, results);
+            break;
+        }
+        if (!valid)
+            return false;
+    }
+
+    return factsRead;
+}
@@ -0,0 +1,65 @@
+/*
+    partialResults.hpp
+
+    Results of a run that can be merged with the results of other runs,
+    e.g., of workers that each process part of a source collection, into
+    the report of the whole collection.
+
+    The file is versioned, and after the header is a sequence of sections,
+    each with a tag and a length, so a reader skips the sections it does
+    not know. Sections are the facts, the function metrics histograms, and
+    the query counts.
+*/
+
+#ifndef INCLUDED_PARTIALRESULTS_HPP
+#define INCLUDED_PARTIALRESULTS_HPP
+
+#include "facts.hpp"
+#include "histogram.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+// number of function metrics histograms: LOC, expressions, declarations, decisions, and complexity
+inline constexpr int FUNCTION_METRICS_COUNT = 5;
+
+struct PartialResults {
+    // archive url attributes, without duplicates
+    std::vector<std::string> urls;
+    long totalBytes = 0;
+    // number of files, i.e., without the root unit of each archive
+    long files = 0;
+    Facts facts;
+    bool functionMetrics = false;
+    Histogram histograms[FUNCTION_METRICS_COUNT];
+    // text and count of each query
+    std::vector<std::pair<std::string, long>> queryCounts;
+
+    /*
+        Merge the results of another run
+
+        @param[in] other Results of another run
+        @return These results
+    */
+    PartialResults& operator+=(const PartialResults& other);
+};
+
+/*
+    Save results, replacing the file
+
+    @param[in] path Partial results filename
+    @param[in] results Results
+    @return Whether the results were saved
+*/
+[[nodiscard]] bool savePartialResults(const std::string& path, const PartialResults& results);
+
+/*
+    Load results
+
+    @param[in] path Partial results filename
+    @param[out] results Results
+    @return Whether valid results were loaded
+*/
+[[nodiscard]] bool loadPartialResults(const std::string& path, PartialResults& results);
+
+#endif
@@ -0,0 +1,214 @@
+/*
+    pathMatcher.cpp
+
+    Streaming evaluation of XPath-like path queries over start and end tags.
+*/
+
+#include "pathMatcher.hpp"
+#include <algorithm>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    // maximum steps in a query, so that the matched state fits in the bitset
+    const std::size_t MAX_STEPS = 63;
+
+    constexpr auto STEPEND = "/[]@=\"' \t\n\r"sv;
+}
+
+/*
+    Compile and add a query
+
+    @param[in] query Path query
+    @param[in, out] elementIds Interned IDs of element local names
+    @return Whether the query is valid
+*/
+bool PathMatcher::addQuery(std::string_view query, ElementIds& elementIds) {
+
+    Query compiled;
+    compiled.text = query;
+
+    // a relative query can start at any depth
+    bool descendant = true;
+    if (query.compare(0, "//"sv.size(), "//"sv) == 0) {
+        query.remove_prefix("//"sv.size());
+    } else if (query.compare(0, "/"sv.size(), "/"sv) == 0) {
+        query.remove_prefix("/"sv.size());
+        descendant = false;
+    }
+    while (true) {
+        // name test
+        const std::size_t nameEndPosition = std::min(query.find_first_of(STEPEND), query.size());
+        const std::string_view name(query.substr(0, nameEndPosition));
+        if (name.empty() || compiled.steps.size() == MAX_STEPS)
+            return false;
+        query.remove_prefix(nameEndPosition);
+        Step step;
+        const std::uint64_t stepBit = std::uint64_t(1) << compiled.steps.size();
+        const std::size_t colonPosition = name.find(':');
+        if (name == "*"sv) {
+            compiled.wildcardMask |= stepBit;
+        } else if (colonPosition == name.npos) {
+            step.id = elementIds.intern(name);
+        } else {
+            if (colonPosition == 0 || colonPosition + 1 == name.size())
+                return false;
+            step.prefix = name.substr(0, colonPosition);
+            step.id = elementIds.intern(name.substr(colonPosition + 1));
+            compiled.prefixMask |= stepBit;
+        }
+        if (descendant)
+            compiled.descendantMask |= stepBit;
+
+        // optional attribute predicate
+        if (!query.empty() && query[0] == '[') {
+            query.remove_prefix("["sv.size());
+            if (query.empty() || query[0] != '@')
+                return false;
+            query.remove_prefix("@"sv.size());
+            const std::size_t attributeEndPosition = std::min(query.find_first_of(STEPEND), query.size());
+            if (attributeEndPosition == 0)
+                return false;
+            step.attributeName = query.substr(0, attributeEndPosition);
+            query.remove_prefix(attributeEndPosition);
+            if (!query.empty() && query[0] == '=') {
+                query.remove_prefix("="sv.size());
+                if (query.empty() || (query[0] != '"' && query[0] != '\''))
+                    return false;
+                const char delimiter = query[0];
+                query.remove_prefix("\""sv.size());
+                const std::size_t valueEndPosition = query.find(delimiter);
+                if (valueEndPosition == query.npos)
+                    return false;
+                step.attributeValue = query.substr(0, valueEndPosition);
+                query.remove_prefix(valueEndPosition + 1);
+            }
+            if (query.empty() || query[0] != ']')
+                return false;
+            query.remove_prefix("]"sv.size());
+            compiled.predicateMask |= stepBit;
+        }
+        compiled.steps.push_back(step);
+
+        // axis of the next step
+        if (query.empty())
+            break;
+        if (query.compare(0, "//"sv.size(), "//"sv) == 0) {
+            query.remove_prefix("//"sv.size());
+            descendant = true;
+        } else if (query[0] == '/') {
+            query.remove_prefix("/"sv.size());
+            descendant = false;
+        } else {
+            return false;
+        }
+    }
+
+    // masks by element ID
+    for (std::size_t i = 0; i < compiled.steps.size(); ++i) {
+        const int id = compiled.steps[i].id;
+        if (id < 0)
+            continue;
+        if (id >= static_cast<int>(compiled.idMasks.size()))
+            compiled.idMasks.resize(id + 1, 0);
+        compiled.idMasks[id] |= std::uint64_t(1) << i;
+    }
+
+    queries.push_back(std::move(compiled));
+
+    // only the document itself is open, with no steps matched
+    states.assign(queries.size(), 1);
+    candidates.assign(queries.size(), 0);
+    satisfied.assign(queries.size(), 0);
+
+    return true;
+}
+
+/*
+    Start tag name, before any attributes
+
+    @param[in] depth Number of open ancestor elements
+    @param[in] prefix Element namespace prefix
+    @param[in] id Interned ID of the element local name
+*/
+void PathMatcher::startElement(int depth, std::string_view prefix, int id) {
+
+    const std::size_t queryCount = queries.size();
+    tagDepth = depth;
+    if (states.size() < (depth + 2) * queryCount)
+        states.resize((depth + 2) * queryCount * 2, 0);
+
+    pendingPredicates = false;
+    const std::uint64_t* parentStates = &states[depth * queryCount];
+    for (std::size_t q = 0; q < queryCount; ++q) {
+        const Query& query = queries[q];
+        std::uint64_t mask = query.wildcardMask;
+        if (id < static_cast<int>(query.idMasks.size()))
+            mask |= query.idMasks[id];
+        // a prefixed step only matches with its prefix
+        for (std::uint64_t prefixed = mask & query.prefixMask; prefixed; prefixed &= prefixed - 1) {
+            const int i = __builtin_ctzll(prefixed);
+            if (query.steps[i].prefix != prefix)
+                mask &= ~(std::uint64_t(1) << i);
+        }
+        candidates[q] = parentStates[q] & mask;
+        satisfied[q] = 0;
+        if (candidates[q] & query.predicateMask)
+            pendingPredicates = true;
+    }
+}
+
+/*
+    Attribute of the current start tag
+
+    @param[in] localName Attribute local name
+    @param[in] value Attribute value
+*/
+void PathMatcher::attribute(std::string_view localName, std::string_view value) {
+
+    if (!pendingPredicates)
+        return;
+
+    for (std::size_t q = 0; q < queries.size(); ++q) {
+        const Query& query = queries[q];
+        std::uint64_t pending = candidates[q] & query.predicateMask & ~satisfied[q];
+        for (std::size_t i = 0; pending; ++i, pending >>= 1) {
+            if (!(pending & 1))
+                continue;
+            const Step& step = query.steps[i];
+            if (*step.attributeName == localName && (!step.attributeValue || *step.attributeValue == value))
+                satisfied[q] |= std::uint64_t(1) << i;
+        }
+    }
+}
+
+/*
+    End of the current start tag, either '>' or '/>'
+*/
+void PathMatcher::endStartTag() {
+
+    const std::size_t queryCount = queries.size();
+    const std::uint64_t* parentStates = &states[tagDepth * queryCount];
+    std::uint64_t* elementStates = &states[(tagDepth + 1) * queryCount];
+    for (std::size_t q = 0; q < queryCount; ++q) {
+        Query& query = queries[q];
+        const std::uint64_t matched = (candidates[q] & ~query.predicateMask) | (candidates[q] & satisfied[q]);
+        const std::uint64_t state = (matched << 1) | (parentStates[q] & query.descendantMask);
+        if ((state >> query.steps.size()) & 1)
+            ++query.count;
+        elementStates[q] = state;
+    }
+}
+
+/*
+    @param[in] query Query index
+    @return Whether the query matched the element of the last start tag
+*/
+bool PathMatcher::matched(int query) const {
+
+    const std::uint64_t state = states[(tagDepth + 1) * queries.size() + query];
+
+    return (state >> queries[query].steps.size()) & 1;
+}
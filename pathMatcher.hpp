@@ -0,0 +1,149 @@
+/*
+    pathMatcher.hpp
+
+    Streaming evaluation of XPath-like path queries over start and end tags.
+
+    Query syntax:
+    * Steps are separated by '/' for a child or '//' for a descendant
+    * A leading '/' anchors the first step at the root element. Otherwise,
+      the first step can match at any depth
+    * A step is an element local name, which matches in any namespace, a
+      prefixed name, e.g., cpp:include, which only matches with that
+      prefix, or '*' for any element
+    * A step can have one attribute predicate, [@name] or [@name="value"],
+      where name is the attribute local name
+
+    Examples:
+    * function/block/call - call directly inside the block of a function
+    * /unit/unit/decl_stmt - declaration statements at the top level of each file
+    * //unit[@language="Java"]//class - classes in Java files
+    * //cpp:include - preprocessor includes
+
+    All queries are compiled into one automaton over interned element IDs.
+    For each query, the state of an element is a bitset of the number of
+    steps matched so far, so updating every query on a start tag takes a
+    few bitwise operations.
+*/
+
+#ifndef INCLUDED_PATHMATCHER_HPP
+#define INCLUDED_PATHMATCHER_HPP
+
+#include "elementIds.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class PathMatcher {
+public:
+
+    /*
+        Compile and add a query
+
+        @param[in] query Path query
+        @param[in, out] elementIds Interned IDs of element local names
+        @return Whether the query is valid
+    */
+    [[nodiscard]] bool addQuery(std::string_view query, ElementIds& elementIds);
+
+    /*
+        @return Whether there are no queries
+    */
+    [[nodiscard]] bool empty() const {
+        return queries.empty();
+    }
+
+    /*
+        @return Number of queries
+    */
+    [[nodiscard]] int size() const {
+        return static_cast<int>(queries.size());
+    }
+
+    /*
+        @param[in] query Query index
+        @return Source text of the query
+    */
+    [[nodiscard]] const std::string& text(int query) const {
+        return queries[query].text;
+    }
+
+    /*
+        @param[in] query Query index
+        @return Number of elements matched by the query
+    */
+    [[nodiscard]] long count(int query) const {
+        return queries[query].count;
+    }
+
+    /*
+        Start tag name, before any attributes
+
+        @param[in] depth Number of open ancestor elements
+        @param[in] prefix Element namespace prefix
+        @param[in] id Interned ID of the element local name
+    */
+    void startElement(int depth, std::string_view prefix, int id);
+
+    /*
+        Attribute of the current start tag
+
+        @param[in] localName Attribute local name
+        @param[in] value Attribute value
+    */
+    void attribute(std::string_view localName, std::string_view value);
+
+    /*
+        End of the current start tag, either '>' or '/>'
+    */
+    void endStartTag();
+
+    /*
+        @param[in] query Query index
+        @return Whether the query matched the element of the last start tag
+    */
+    [[nodiscard]] bool matched(int query) const;
+
+private:
+
+    struct Step {
+        // element ID, or -1 for any element
+        int id = -1;
+        // prefix of a prefixed name
+        std::string prefix;
+        std::optional<std::string> attributeName;
+        std::optional<std::string> attributeValue;
+    };
+
+    struct Query {
+        std::string text;
+        std::vector<Step> steps;
+        // bit i is set when step i is reached by '//'
+        std::uint64_t descendantMask = 0;
+        // bit i is set when step i has an attribute predicate
+        std::uint64_t predicateMask = 0;
+        // bit i is set when step i is '*'
+        std::uint64_t wildcardMask = 0;
+        // bit i is set when step i is a prefixed name
+        std::uint64_t prefixMask = 0;
+        // for each element ID, bit i is set when step i names that element
+        std::vector<std::uint64_t> idMasks;
+        long count = 0;
+    };
+
+    std::vector<Query> queries;
+
+    // for each depth, the state of every query, depth-major
+    std::vector<std::uint64_t> states;
+
+    // current start tag
+    int tagDepth = 0;
+    // for each query, steps that match the tag name, pending predicates
+    std::vector<std::uint64_t> candidates;
+    // for each query, steps with a predicate satisfied by the tag attributes
+    std::vector<std::uint64_t> satisfied;
+    bool pendingPredicates = false;
+};
+
+#endif
@@ -0,0 +1,185 @@
+/*
+    perfCounters.cpp
+
+    Hardware performance counters of the parse through perf_event_open().
+*/
+
+#include "perfCounters.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+namespace {
+
+    /*
+        @param[in] counter Counter
+        @return Event attributes of the counter, disabled, for user mode of this thread
+    */
+    perf_event_attr eventAttributes(Counter counter) {
+
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HARDWARE;
+        switch (counter) {
+        case CYCLES_COUNTER:
+            attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case INSTRUCTIONS_COUNTER:
+            attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case BRANCH_MISSES_COUNTER:
+            attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case L1D_MISSES_COUNTER:
+            attributes.type = PERF_TYPE_HW_CACHE;
+            attributes.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case LLC_MISSES_COUNTER:
+            attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        default:
+            attributes.type = PERF_TYPE_SOFTWARE;
+            attributes.config = PERF_COUNT_SW_TASK_CLOCK;
+            break;
+        }
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        return attributes;
+    }
+
+    /*
+        @param[in] error errno of perf_event_open()
+        @return Reason for the error
+    */
+    std::string errorReason(int error) {
+
+        if (error == EACCES || error == EPERM) {
+            std::string paranoid;
+            std::ifstream("/proc/sys/kernel/perf_event_paranoid") >> paranoid;
+            return "perf events are not permitted" + (paranoid.empty() ? std::string() : " (perf_event_paranoid is " + paranoid + ")");
+        }
+        if (error == ENOSYS)
+            return "perf_event_open() is not available";
+        if (error == ENOENT || error == EOPNOTSUPP || error == EINVAL)
+            return "not supported by this CPU or virtual machine";
+
+        return std::strerror(error);
+    }
+}
+#endif
+
+PerfCounters::~PerfCounters() {
+
+#if defined(__linux__)
+    for (const int descriptor : descriptors) {
+        if (descriptor != -1)
+            close(descriptor);
+    }
+#endif
+}
+
+/*
+    Open the counters of the calling thread, disabled
+
+    @return Whether any counter was opened
+*/
+bool PerfCounters::open() {
+
+#if defined(__linux__)
+    // hardware counters first, so the leader is a hardware counter when there is one
+    int firstError = 0;
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter) {
+        perf_event_attr attributes = eventAttributes(static_cast<Counter>(counter));
+        const int descriptor = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, leader, 0));
+        if (descriptor == -1) {
+            if (!firstError)
+                firstError = errno;
+            continue;
+        }
+        descriptors[counter] = descriptor;
+        positions[counter] = groupSize++;
+        if (leader == -1)
+            leader = descriptor;
+    }
+    if (firstError)
+        openError = errorReason(firstError);
+
+    return leader != -1;
+#else
+    openError = "perf events are only on Linux";
+    return false;
+#endif
+}
+
+/*
+    Start counting the parse
+*/
+void PerfCounters::start() {
+
+#if defined(__linux__)
+    if (leader == -1)
+        return;
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    read(startValues);
+#endif
+}
+
+/*
+    Stop counting the parse
+*/
+void PerfCounters::stop() {
+
+#if defined(__linux__)
+    if (leader == -1)
+        return;
+    std::uint64_t stopValues[COUNTER_COUNT] = {};
+    read(stopValues);
+    ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+        totals[counter] += stopValues[counter] - startValues[counter];
+#endif
+}
+
+/*
+    End of a refill of the input
+*/
+void PerfCounters::stopInput() {
+
+    std::uint64_t stopValues[COUNTER_COUNT] = {};
+    read(stopValues);
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+        inputTotals[counter] += stopValues[counter] - inputStart[counter];
+}
+
+/*
+    Read the counters, scaled for any time not counting when multiplexed
+
+    @param[out] values Current value of each counter
+*/
+void PerfCounters::read(std::uint64_t values[COUNTER_COUNT]) const {
+
+#if defined(__linux__)
+    // number of counters, time enabled, time running, then the value of each counter
+    std::uint64_t group[3 + COUNTER_COUNT] = {};
+    if (leader == -1 || ::read(leader, group, sizeof(group)) <= 0)
+        return;
+    const double scale = group[2] ? static_cast<double>(group[1]) / group[2] : 1.0;
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter) {
+        if (descriptors[counter] != -1)
+            values[counter] = static_cast<std::uint64_t>(group[3 + positions[counter]] * scale);
+    }
+#endif
+}
@@ -0,0 +1,123 @@
+/*
+    perfCounters.hpp
+
+    Hardware performance counters of the parse through perf_event_open() on
+    Linux: cycles, instructions, branch misses, L1 data cache read misses,
+    and last-level cache misses, with the task clock. The counters are a
+    single group, so they are scheduled together, and only count the
+    calling thread in user mode, so they are of the parse, not of other
+    threads or of the kernel.
+
+    Counters that the CPU or the virtual machine does not support are left
+    out, e.g., only the task clock is available without a hardware PMU. When
+    no counter can be opened, e.g., perf events are not permitted, the run
+    continues without counters.
+*/
+
+#ifndef INCLUDED_PERFCOUNTERS_HPP
+#define INCLUDED_PERFCOUNTERS_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// counters of the group
+enum Counter { CYCLES_COUNTER, INSTRUCTIONS_COUNTER, BRANCH_MISSES_COUNTER, L1D_MISSES_COUNTER, LLC_MISSES_COUNTER,
+               TASK_CLOCK_COUNTER, COUNTER_COUNT };
+
+// labels of the counters
+inline constexpr std::string_view COUNTER_LABELS[COUNTER_COUNT] = {
+    "cycles", "instructions", "branch misses", "L1d read misses", "LLC misses", "ns task clock"
+};
+
+class PerfCounters {
+public:
+
+    PerfCounters() = default;
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /*
+        Open the counters of the calling thread, disabled
+
+        @return Whether any counter was opened
+    */
+    [[nodiscard]] bool open();
+
+    /*
+        @return Reason that a counter was not opened
+    */
+    [[nodiscard]] const std::string& error() const {
+        return openError;
+    }
+
+    /*
+        Start counting the parse
+    */
+    void start();
+
+    /*
+        Stop counting the parse
+    */
+    void stop();
+
+    /*
+        Start of a refill of the input, counted separately within the parse
+    */
+    void startInput() {
+        read(inputStart);
+    }
+
+    /*
+        End of a refill of the input
+    */
+    void stopInput();
+
+    /*
+        @param[in] counter Counter
+        @return Whether the counter is supported
+    */
+    [[nodiscard]] bool available(Counter counter) const {
+        return descriptors[counter] != -1;
+    }
+
+    /*
+        @param[in] counter Counter
+        @return Count of the parse, including input
+    */
+    [[nodiscard]] std::uint64_t value(Counter counter) const {
+        return totals[counter];
+    }
+
+    /*
+        @param[in] counter Counter
+        @return Count of the input refills of the parse
+    */
+    [[nodiscard]] std::uint64_t inputValue(Counter counter) const {
+        return inputTotals[counter];
+    }
+
+private:
+
+    /*
+        Read the counters, scaled for any time not counting when multiplexed
+
+        @param[out] values Current value of each counter
+    */
+    void read(std::uint64_t values[COUNTER_COUNT]) const;
+
+    int descriptors[COUNTER_COUNT] = { -1, -1, -1, -1, -1, -1 };
+    // first counter opened, which the others are in the group of
+    int leader = -1;
+    // position of each counter in a read of the group
+    int positions[COUNTER_COUNT] = {};
+    int groupSize = 0;
+    std::string openError;
+    std::uint64_t startValues[COUNTER_COUNT] = {};
+    std::uint64_t totals[COUNTER_COUNT] = {};
+    std::uint64_t inputStart[COUNTER_COUNT] = {};
+    std::uint64_t inputTotals[COUNTER_COUNT] = {};
+};
+
+#endif
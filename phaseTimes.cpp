@@ -0,0 +1,59 @@
+/*
+    phaseTimes.cpp
+
+    Breakdown of the parse time into phases.
+*/
+
+#include "phaseTimes.hpp"
+#include <algorithm>
+
+/*
+    Start of the timed run
+*/
+void PhaseTimes::start() {
+
+    startTime = std::chrono::steady_clock::now();
+    startCycles = readCycles();
+}
+
+/*
+    End of the timed run
+*/
+void PhaseTimes::stop() {
+
+    stopCycles = readCycles();
+    stopTime = std::chrono::steady_clock::now();
+}
+
+/*
+    @param[in] phase Phase
+    @return Estimated seconds of the phase
+*/
+double PhaseTimes::seconds(Phase phase) const {
+
+    if (!samples[phase] || stopCycles <= startCycles)
+        return 0;
+
+    // the mean of the samples for every occurrence, scaled so the sampled phases are the time of the main loop
+    double cycles = static_cast<double>(phaseCycles[phase]);
+    if (isSampled(phase)) {
+        double sampledCycles = 0;
+        for (int other = CHARACTERS_PHASE; other <= START_TAG_PHASE; ++other) {
+            if (samples[other])
+                sampledCycles += static_cast<double>(phaseCycles[other]) * events[other] / samples[other];
+        }
+        const double loopSampledCycles = static_cast<double>(loopCycles) - static_cast<double>(phaseCycles[SKIP_PHASE]);
+        cycles = cycles * events[phase] / samples[phase] * std::max(0.0, loopSampledCycles) / sampledCycles;
+    }
+
+    // converted with the rate of the counter over the run
+    return cycles * totalSeconds() / static_cast<double>(stopCycles - startCycles);
+}
+
+/*
+    @return Seconds of the timed run
+*/
+double PhaseTimes::totalSeconds() const {
+
+    return std::chrono::duration<double>(stopTime - startTime).count();
+}
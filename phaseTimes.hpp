@@ -0,0 +1,203 @@
+/*
+    phaseTimes.hpp
+
+    Breakdown of the parse time into phases: reading the input and copying
+    the unprocessed content in refillContent(), the XML declaration and
+    DOCTYPE, and each kind of markup in the main loop of the parser.
+
+    Times are in cycles of the timestamp counter, converted to seconds with
+    its rate over the run. Refills and the prolog are timed on every call.
+    The main loop only counts each kind of markup, and times a random one
+    in about 64, so the time of a phase is estimated from the mean time of
+    its samples. The estimates are then scaled to the measured time of the
+    main loop, which removes the overhead of taking the samples. Skipped
+    elements are timed on every skip.
+*/
+
+#ifndef INCLUDED_PHASETIMES_HPP
+#define INCLUDED_PHASETIMES_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+// phases of the parse
+enum Phase { READ_PHASE, COPY_PHASE, PROLOG_PHASE, CHARACTERS_PHASE, ENTITY_PHASE, COMMENT_PHASE, CDATA_PHASE,
+             PI_PHASE, END_TAG_PHASE, START_TAG_PHASE, SKIP_PHASE, PHASE_COUNT };
+
+// labels of the phases
+inline constexpr std::string_view PHASE_LABELS[PHASE_COUNT] = {
+    "Read", "Copy", "Prolog", "Characters", "Entity", "XML comment", "CDATA", "PI", "End tag", "Start tag", "Skip"
+};
+
+/*
+    @return Timestamp counter, or a nanosecond clock where there is none
+*/
+[[nodiscard]] inline std::uint64_t readCycles() {
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    std::uint64_t cycles;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(cycles));
+    return cycles;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+class PhaseTimes {
+public:
+
+    /*
+        Start of the timed run
+    */
+    void start();
+
+    /*
+        End of the timed run
+    */
+    void stop();
+
+    /*
+        Start of the main loop of the parser
+    */
+    void startLoop() {
+
+        loopStart = readCycles();
+        loopRefillCycles = refillCycles;
+    }
+
+    /*
+        End of the main loop of the parser
+    */
+    void stopLoop() {
+
+        loopCycles += readCycles() - loopStart - (refillCycles - loopRefillCycles);
+    }
+
+    /*
+        Add a refill phase, timed on every call
+
+        @param[in] phase READ_PHASE or COPY_PHASE
+        @param[in] cycles Cycles of the phase
+    */
+    void addRefill(Phase phase, std::uint64_t cycles) {
+
+        refillCycles += cycles;
+        add(phase, cycles);
+    }
+
+    /*
+        Add a phase timed on every occurrence
+
+        @param[in] phase Phase
+        @param[in] cycles Cycles of the phase, without any refills
+    */
+    void add(Phase phase, std::uint64_t cycles) {
+
+        phaseCycles[phase] += cycles;
+        ++samples[phase];
+        ++events[phase];
+    }
+
+    /*
+        Count an occurrence of a phase of the main loop
+
+        @param[in] phase Phase
+    */
+    void count(Phase phase) {
+
+        ++events[phase];
+    }
+
+    /*
+        @return Whether to sample the next occurrence of the main loop
+    */
+    [[nodiscard]] bool sampleNext() {
+
+        if (--countdown > 0)
+            return false;
+
+        // random period from 32 to 95, so periodic input does not bias the samples
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        countdown = 32 + static_cast<int>(random & 63);
+        return true;
+    }
+
+    /*
+        Start a sample
+    */
+    void startSample() {
+
+        sampleStart = readCycles();
+        sampleRefillCycles = refillCycles;
+    }
+
+    /*
+        End a sample, excluding the refills during it
+
+        @param[in] phase Phase of the sample
+    */
+    void endSample(Phase phase) {
+
+        phaseCycles[phase] += readCycles() - sampleStart - (refillCycles - sampleRefillCycles);
+        ++samples[phase];
+    }
+
+    /*
+        @param[in] phase Phase
+        @return Number of occurrences of the phase
+    */
+    [[nodiscard]] long occurrences(Phase phase) const {
+        return events[phase];
+    }
+
+    /*
+        @param[in] phase Phase
+        @return Estimated seconds of the phase
+    */
+    [[nodiscard]] double seconds(Phase phase) const;
+
+    /*
+        @param[in] phase Phase
+        @return Whether the phase is sampled, instead of timed on every occurrence
+    */
+    [[nodiscard]] static bool isSampled(Phase phase) {
+        return phase >= CHARACTERS_PHASE && phase <= START_TAG_PHASE;
+    }
+
+    /*
+        @return Seconds of the timed run
+    */
+    [[nodiscard]] double totalSeconds() const;
+
+private:
+    std::uint64_t phaseCycles[PHASE_COUNT] = {};
+    long samples[PHASE_COUNT] = {};
+    long events[PHASE_COUNT] = {};
+    std::uint64_t refillCycles = 0;
+    std::uint64_t loopCycles = 0;
+    std::uint64_t loopStart = 0;
+    std::uint64_t loopRefillCycles = 0;
+    std::uint64_t sampleStart = 0;
+    std::uint64_t sampleRefillCycles = 0;
+    int countdown = 1;
+    std::uint64_t random = 0x2545f4914f6cdd1d;
+    std::uint64_t startCycles = 0;
+    std::uint64_t stopCycles = 0;
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point stopTime;
+};
+
+#endif
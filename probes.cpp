@@ -0,0 +1,21 @@
+/*
+    probes.cpp
+
+    Semaphores of the USDT probes.
+*/
+
+#include "probes.hpp"
+
+#ifdef SRCFACTS_USDT
+
+// the semaphores are in the .probes section, where bpftrace and perf find them from the probe notes
+#define SRCFACTS_PROBE_DEFINE(name) SRCFACTS_PROBE_SEMAPHORE(name) __attribute__((section(".probes"))) = 0
+
+SRCFACTS_PROBE_DEFINE(refill__start);
+SRCFACTS_PROBE_DEFINE(refill__done);
+SRCFACTS_PROBE_DEFINE(unit__start);
+SRCFACTS_PROBE_DEFINE(unit__end);
+SRCFACTS_PROBE_DEFINE(parse__error);
+SRCFACTS_PROBE_DEFINE(document__end);
+
+#endif
@@ -0,0 +1,59 @@
+/*
+    probes.hpp
+
+    USDT probes of the srcfacts provider, for bpftrace and perf, e.g.,
+
+        bpftrace -e 'usdt:./srcfacts:srcfacts:unit__end { printf("%s\n", str(arg0)); }'
+
+    Each probe is a nop instruction and a note in the executable. Each
+    has a semaphore that bpftrace and perf increment while it is attached,
+    and the arguments of a probe that costs more than a nop, e.g., the
+    filename of a unit, are only collected when its semaphore is set.
+
+    The probes are in the build when sys/sdt.h is found, e.g., from
+    systemtap-sdt-dev, unless built with -DUSDT_PROBES=OFF. Otherwise,
+    the probes are empty.
+*/
+
+#ifndef INCLUDED_PROBES_HPP
+#define INCLUDED_PROBES_HPP
+
+#ifdef SRCFACTS_USDT
+
+// each probe refers to its semaphore
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define SRCFACTS_PROBE_SEMAPHORE(name) volatile unsigned short srcfacts_##name##_semaphore
+
+#define SRCFACTS_PROBE_ENABLED(name) __builtin_expect(srcfacts_##name##_semaphore != 0, 0)
+#define SRCFACTS_PROBE1(name, arg1) DTRACE_PROBE1(srcfacts, name, arg1)
+#define SRCFACTS_PROBE2(name, arg1, arg2) DTRACE_PROBE2(srcfacts, name, arg1, arg2)
+
+// input refill, with the bytes of input so far, and the bytes of unprocessed content preserved
+extern SRCFACTS_PROBE_SEMAPHORE(refill__start);
+
+// end of an input refill, with the bytes read, 0 at EOF, and the bytes of input so far
+extern SRCFACTS_PROBE_SEMAPHORE(refill__done);
+
+// start of a child unit, after its start tag, with the filename and the offset of the start tag
+extern SRCFACTS_PROBE_SEMAPHORE(unit__start);
+
+// end of a child unit, with the filename and the offset just after the end tag
+extern SRCFACTS_PROBE_SEMAPHORE(unit__end);
+
+// parse error, with the bytes of input read when the error was found
+extern SRCFACTS_PROBE_SEMAPHORE(parse__error);
+
+// end of a document, or of the units parsed from an index or a block, with the bytes of input
+extern SRCFACTS_PROBE_SEMAPHORE(document__end);
+
+#else
+
+#define SRCFACTS_PROBE_ENABLED(name) false
+#define SRCFACTS_PROBE1(name, arg1) do {} while (false)
+#define SRCFACTS_PROBE2(name, arg1, arg2) do {} while (false)
+
+#endif
+
+#endif
@@ -0,0 +1,88 @@
+/*
+    progress.cpp
+
+    Live progress of a long run on standard error.
+*/
+
+#include "progress.hpp"
+#include <cstdio>
+
+namespace {
+
+    // time between updates of the progress line
+    constexpr auto UPDATE_INTERVAL = std::chrono::milliseconds(250);
+}
+
+Progress::~Progress() {
+
+    stop();
+}
+
+/*
+    Start updating the progress line
+
+    @param[in] inputSize Size of the input file, compressed or not, or 0 when unknown, e.g., a pipe
+*/
+void Progress::start(long inputSize) {
+
+    totalSize = inputSize;
+    startTime = std::chrono::steady_clock::now();
+    timer = std::thread(&Progress::update, this);
+}
+
+/*
+    Stop updating, and clear the progress line
+*/
+void Progress::stop() {
+
+    if (!timer.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    stopped.notify_one();
+    timer.join();
+    std::fputs("\r\033[K", stderr);
+    std::fflush(stderr);
+}
+
+/*
+    Update the progress line until stopped
+*/
+void Progress::update() {
+
+    // the current rate is smoothed over the last few updates
+    double rate = 0;
+    long lastBytes = 0;
+    auto lastTime = startTime;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopped.wait_for(lock, UPDATE_INTERVAL, [this]() { return stopping; })) {
+        const auto now = std::chrono::steady_clock::now();
+        const long inputBytes = bytes.load(std::memory_order_relaxed);
+        const long fileBytes = compressedBytes.load(std::memory_order_relaxed);
+        const long unitCount = units.load(std::memory_order_relaxed);
+        const double seconds = std::chrono::duration<double>(now - lastTime).count();
+        const double currentRate = (inputBytes - lastBytes) / seconds;
+        rate = rate == 0 ? currentRate : 0.7 * rate + 0.3 * currentRate;
+        lastBytes = inputBytes;
+        lastTime = now;
+
+        // C stdio, since the locale of the report streams is not set until the end of the run
+        char line[160];
+        int size = std::snprintf(line, sizeof(line), "\r%.1f MB", inputBytes / 1000000.0);
+        if (fileBytes)
+            size += std::snprintf(line + size, sizeof(line) - size, " (%.1f MB compressed)", fileBytes / 1000000.0);
+        size += std::snprintf(line + size, sizeof(line) - size, ", %ld units, %.1f MB/sec", unitCount, rate / 1000000.0);
+        // the ETA is from the average rate of the whole run through the input file
+        const long consumed = fileBytes ? fileBytes : inputBytes;
+        if (totalSize > 0 && consumed > 0 && consumed < totalSize) {
+            const double elapsed = std::chrono::duration<double>(now - startTime).count();
+            const long eta = static_cast<long>(elapsed * (totalSize - consumed) / consumed);
+            size += std::snprintf(line + size, sizeof(line) - size, ", ETA %ld:%02ld", eta / 60, eta % 60);
+        }
+        std::snprintf(line + size, sizeof(line) - size, "\033[K");
+        std::fputs(line, stderr);
+        std::fflush(stderr);
+    }
+}
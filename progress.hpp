@@ -0,0 +1,82 @@
+/*
+    progress.hpp
+
+    Live progress of a long run on standard error: the input bytes, the
+    compressed bytes when the input is compressed, the child units, the
+    current MB/sec, and the ETA when the size of the input is known.
+
+    The parse publishes its progress in relaxed atomics, the bytes at each
+    refill of the input and the units at the end of each child unit, and a
+    timer thread reads them and updates the progress line a few times a
+    second.
+*/
+
+#ifndef INCLUDED_PROGRESS_HPP
+#define INCLUDED_PROGRESS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class Progress {
+public:
+
+    Progress() = default;
+    ~Progress();
+    Progress(const Progress&) = delete;
+    Progress& operator=(const Progress&) = delete;
+
+    /*
+        Start updating the progress line
+
+        @param[in] inputSize Size of the input file, compressed or not, or 0 when unknown, e.g., a pipe
+    */
+    void start(long inputSize);
+
+    /*
+        Stop updating, and clear the progress line
+    */
+    void stop();
+
+    /*
+        Refill of the input
+
+        @param[in] inputBytes Input bytes read, uncompressed
+        @param[in] fileBytes Bytes read from the compressed input file, or 0 when not compressed
+    */
+    void refill(long inputBytes, long fileBytes) {
+
+        bytes.store(inputBytes, std::memory_order_relaxed);
+        compressedBytes.store(fileBytes, std::memory_order_relaxed);
+    }
+
+    /*
+        End of a child unit
+    */
+    void unitEnd() {
+
+        // only the parse writes the count
+        units.store(units.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+private:
+
+    /*
+        Update the progress line until stopped
+    */
+    void update();
+
+    std::atomic<long> bytes = 0;
+    std::atomic<long> compressedBytes = 0;
+    std::atomic<long> units = 0;
+    long totalSize = 0;
+    std::chrono::steady_clock::time_point startTime;
+    std::thread timer;
+    std::mutex mutex;
+    std::condition_variable stopped;
+    bool stopping = false;
+};
+
+#endif
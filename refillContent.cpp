@@ -0,0 +1,162 @@
+/*
+    refillContent.cpp
+
+    Input of the srcML content from standard input, a file, or memory.
+*/
+
+#include "refillContent.hpp"
+#include "phaseTimes.hpp"
+#include "perfCounters.hpp"
+#include "progress.hpp"
+#include "probes.hpp"
+#include <iostream>
+#include <algorithm>
+#include <archive.h>
+#include <archive_entry.h>
+
+InputSource::InputSource() : buffer(new char[BUFFER_SIZE]) {}
+
+InputSource::~InputSource() {
+
+    if (inputArchive)
+        archive_read_free(inputArchive);
+}
+
+/*
+    Open a file through libarchive
+
+    @param[in] filename Name of the file, or empty for standard input
+    @return Whether the input was opened
+*/
+bool InputSource::open(const std::string& filename) {
+
+    // libarchive input setup
+    inputArchive = archive_read_new();
+    archive_read_support_format_all(inputArchive);
+    archive_read_support_filter_all(inputArchive);
+    archive_read_support_format_raw(inputArchive);
+    archive_read_support_format_empty(inputArchive);
+    int status = filename.empty() ? archive_read_open_fd(inputArchive, 0, BUFFER_SIZE)
+                                  : archive_read_open_filename(inputArchive, filename.c_str(), BUFFER_SIZE);
+    if (status != ARCHIVE_OK) {
+        std::cerr << "input error: Invalid data in " << (filename.empty() ? "standard input" : filename) << '\n';
+        return false;
+    }
+    archive_entry* inputEntry = nullptr;
+    status = archive_read_next_header(inputArchive, &inputEntry);
+    if (status != ARCHIVE_OK) {
+        std::cerr << "input error: Invalid data in " << (filename.empty() ? "standard input" : filename) << " header\n";
+        return false;
+    }
+
+    return true;
+}
+
+/*
+    Use content that is already in memory, e.g., a memory-mapped file
+
+    @param[in] data Content
+*/
+void InputSource::openMemory(std::string_view data) {
+
+    memory = data;
+    atEOF = false;
+}
+
+/*
+    Skip the start of the input, e.g., to resume a run. Compressed input
+    is decompressed, but not parsed.
+
+    @param[in] bytes Number of bytes to skip
+    @return Whether the bytes were skipped
+*/
+bool InputSource::skip(long bytes) {
+
+    while (bytesTotal < bytes) {
+        const auto readSize = std::min<long>(BUFFER_SIZE, bytes - bytesTotal);
+        long bytesRead = 0;
+        if (inputArchive) {
+            bytesRead = archive_read_data(inputArchive, buffer.get(), readSize);
+        } else {
+            bytesRead = std::min<long>(readSize, static_cast<long>(memory.size()));
+            memory.remove_prefix(bytesRead);
+        }
+        if (bytesRead <= 0)
+            return false;
+        bytesTotal += bytesRead;
+    }
+
+    return true;
+}
+
+/*
+    Refill the content preserving the existing data.
+
+    @param[in, out] input Input source
+    @param[in, out] content View of the content
+    @return Number of bytes read
+    @retval 0 EOF, including any refill after EOF
+    @retval -1 Read error
+    @retval REFILL_BUFFER_FULL Content fills the buffer, so nothing can be read
+*/
+[[nodiscard]] int refillContent(InputSource& input, std::string_view& content) {
+
+    // input is freed at EOF, so later refills return EOF again
+    if (input.atEOF)
+        return 0;
+
+    // a read of 0 bytes is EOF, so a full buffer is not read at all
+    if (content.size() >= BUFFER_SIZE)
+        return REFILL_BUFFER_FULL;
+
+    SRCFACTS_PROBE2(refill__start, input.bytesTotal, content.size());
+    if (input.perfCounters)
+        input.perfCounters->startInput();
+
+    // preserve prefix of unprocessed characters to start of the buffer
+    PhaseTimes* const phaseTimes = input.phaseTimes;
+    const std::uint64_t copyStart = phaseTimes ? readCycles() : 0;
+    char* buffer = input.buffer.get();
+    std::copy(content.cbegin(), content.cend(), buffer);
+    const std::uint64_t readStart = phaseTimes ? readCycles() : 0;
+
+    // read the next block, without overrunning the buffer when more than a block is preserved
+    const auto readSize = std::min<std::size_t>(BUFFER_SIZE - BLOCK_SIZE, BUFFER_SIZE - content.size());
+    long bytesRead = 0;
+    if (input.inputArchive) {
+        bytesRead = archive_read_data(input.inputArchive, buffer + content.size(), readSize);
+        if (bytesRead < 0) {
+            /* ERROR */
+            return -1;
+        }
+    } else {
+        // memory content is copied so the parser can look ahead past the end of the content
+        bytesRead = static_cast<long>(std::min(readSize, input.memory.size()));
+        std::copy_n(input.memory.data(), bytesRead, buffer + content.size());
+        input.memory.remove_prefix(bytesRead);
+    }
+    if (phaseTimes) {
+        phaseTimes->addRefill(READ_PHASE, readCycles() - readStart);
+        phaseTimes->addRefill(COPY_PHASE, readStart - copyStart);
+    }
+    if (input.perfCounters)
+        input.perfCounters->stopInput();
+    if (input.progress) {
+        const bool compressed = input.inputArchive && archive_filter_code(input.inputArchive, 0) != ARCHIVE_FILTER_NONE;
+        input.progress->refill(input.bytesTotal + bytesRead, compressed ? archive_filter_bytes(input.inputArchive, -1) : 0);
+    }
+    SRCFACTS_PROBE2(refill__done, bytesRead, input.bytesTotal + bytesRead);
+    // EOF
+    if (bytesRead == 0) {
+        if (input.inputArchive)
+            archive_read_free(input.inputArchive);
+        input.inputArchive = nullptr;
+        input.atEOF = true;
+    }
+    input.bytesTotal += bytesRead;
+
+    // set content to the start of the buffer
+    content = std::string_view(buffer, content.size() + bytesRead);
+
+    return static_cast<int>(bytesRead);
+}
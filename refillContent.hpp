@@ -0,0 +1,162 @@
+/*
+    refillContent.hpp
+
+    Input of the srcML content from standard input, a file, or memory.
+    Files and standard input may be compressed and/or an archive. Content
+    is read in blocks into an internal buffer.
+*/
+
+#ifndef INCLUDED_REFILLCONTENT_HPP
+#define INCLUDED_REFILLCONTENT_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+const int BLOCK_SIZE = 4096;
+const int BUFFER_SIZE = 16 * 16 * BLOCK_SIZE;
+
+// refillContent() status when the preserved content already fills the buffer, e.g., a token larger than the buffer
+const int REFILL_BUFFER_FULL = -2;
+
+struct archive;
+class PhaseTimes;
+class PerfCounters;
+class InputProfile;
+class ParseTrace;
+class Progress;
+
+class InputSource {
+public:
+
+    InputSource();
+    ~InputSource();
+    InputSource(const InputSource&) = delete;
+    InputSource& operator=(const InputSource&) = delete;
+
+    /*
+        Open a file through libarchive
+
+        @param[in] filename Name of the file, or empty for standard input
+        @return Whether the input was opened
+    */
+    [[nodiscard]] bool open(const std::string& filename = "");
+
+    /*
+        Use content that is already in memory, e.g., a memory-mapped file.
+        Can be called again for the next content.
+
+        @param[in] data Content
+    */
+    void openMemory(std::string_view data);
+
+    /*
+        Skip the start of the input, e.g., to resume a run. Compressed input
+        is decompressed, but not parsed.
+
+        @param[in] bytes Number of bytes to skip
+        @return Whether the bytes were skipped
+    */
+    [[nodiscard]] bool skip(long bytes);
+
+    /*
+        @return Total bytes read from the input
+    */
+    [[nodiscard]] long totalBytes() const {
+        return bytesTotal;
+    }
+
+    /*
+        Time the phases of refills and of the parse of this input
+
+        @param[in] times Phase times, or nullptr for none
+    */
+    void setPhaseTimes(PhaseTimes* times) {
+        phaseTimes = times;
+    }
+
+    /*
+        @return Phase times, or nullptr when not timed
+    */
+    [[nodiscard]] PhaseTimes* timedPhases() const {
+        return phaseTimes;
+    }
+
+    /*
+        Profile the tokens of the parse of this input
+
+        @param[in] inputProfile Input profile, or nullptr for none
+    */
+    void setProfile(InputProfile* inputProfile) {
+        tokenProfile = inputProfile;
+    }
+
+    /*
+        @return Input profile, or nullptr when not profiled
+    */
+    [[nodiscard]] InputProfile* profile() const {
+        return tokenProfile;
+    }
+
+    /*
+        Trace the parse events of this input
+
+        @param[in] parseTrace Parse trace, or nullptr for none
+    */
+    void setTrace(ParseTrace* parseTrace) {
+        eventTrace = parseTrace;
+    }
+
+    /*
+        @return Parse trace, or nullptr when not traced
+    */
+    [[nodiscard]] ParseTrace* trace() const {
+        return eventTrace;
+    }
+
+    /*
+        Publish the progress of the refills of this input
+
+        @param[in] runProgress Progress, or nullptr for none
+    */
+    void setProgress(Progress* runProgress) {
+        progress = runProgress;
+    }
+
+    /*
+        Count the refills of this input separately with performance counters
+
+        @param[in] counters Performance counters, or nullptr for none
+    */
+    void setPerfCounters(PerfCounters* counters) {
+        perfCounters = counters;
+    }
+
+private:
+    friend int refillContent(InputSource& input, std::string_view& content);
+
+    archive* inputArchive = nullptr;
+    std::string_view memory;
+    std::unique_ptr<char[]> buffer;
+    long bytesTotal = 0;
+    bool atEOF = false;
+    PhaseTimes* phaseTimes = nullptr;
+    PerfCounters* perfCounters = nullptr;
+    InputProfile* tokenProfile = nullptr;
+    ParseTrace* eventTrace = nullptr;
+    Progress* progress = nullptr;
+};
+
+/*
+    Refill the content preserving the existing data.
+
+    @param[in, out] input Input source
+    @param[in, out] content View of the content
+    @return Number of bytes read
+    @retval 0 EOF, including any refill after EOF
+    @retval -1 Read error
+    @retval REFILL_BUFFER_FULL Content fills the buffer, so nothing can be read
+*/
+[[nodiscard]] int refillContent(InputSource& input, std::string_view& content);
+
+#endif
@@ -0,0 +1,263 @@
+/*
+    sketches.cpp
+
+    Fixed-memory approximate counting of strings.
+*/
+
+#include "sketches.hpp"
+#include "hashBytes.hpp"
+#include <algorithm>
+#include <cmath>
+
+/*
+    @param[in] capacity Number of counters
+*/
+SpaceSaving::SpaceSaving(std::size_t capacity) : counters(std::max<std::size_t>(capacity, 1)), heap(counters.size()) {
+
+    std::size_t slotCount = 1;
+    while (slotCount < counters.size() * 2)
+        slotCount *= 2;
+    slots.assign(slotCount, 0);
+}
+
+/*
+    Whether a counter is for a string
+
+    @param[in] counter Counter
+    @param[in] hash Hash of the string
+    @param[in] key String
+    @return Whether the counter is for this string
+*/
+bool SpaceSaving::matches(const Counter& counter, std::uint64_t hash, std::string_view key) const {
+
+    return counter.hash == hash && counter.size == key.size() &&
+           std::string_view(counter.key, std::min<std::size_t>(counter.size, MAX_KEY_SIZE)) == key.substr(0, MAX_KEY_SIZE);
+}
+
+/*
+    Count an occurrence of a string
+
+    @param[in] key String to count
+*/
+void SpaceSaving::add(std::string_view key) {
+
+    ++totalCount;
+    const std::uint64_t hash = hashBytes(key);
+    const std::size_t mask = slots.size() - 1;
+    for (std::size_t position = hash & mask; slots[position]; position = (position + 1) & mask) {
+        Counter& counter = counters[slots[position] - 1];
+        if (matches(counter, hash, key)) {
+            ++counter.count;
+            siftDown(counter.heapIndex);
+            return;
+        }
+    }
+
+    // use a free counter, or replace the counter with the minimum count
+    std::uint32_t counterIndex;
+    long count = 1;
+    long error = 0;
+    if (used < counters.size()) {
+        counterIndex = static_cast<std::uint32_t>(used);
+        heap[used] = counterIndex;
+        counters[counterIndex].heapIndex = static_cast<std::uint32_t>(used);
+        ++used;
+    } else {
+        counterIndex = heap[0];
+        eraseSlot(counterIndex);
+        error = counters[counterIndex].count;
+        count = error + 1;
+    }
+    Counter& counter = counters[counterIndex];
+    counter.hash = hash;
+    counter.count = count;
+    counter.error = error;
+    counter.size = static_cast<std::uint32_t>(key.size());
+    std::copy_n(key.data(), std::min(key.size(), MAX_KEY_SIZE), counter.key);
+    insertSlot(counterIndex);
+    if (error)
+        siftDown(counter.heapIndex);
+    else
+        siftUp(counter.heapIndex);
+}
+
+/*
+    Restore the heap order for a new counter at a heap position
+
+    @param[in] heapIndex Position in the heap
+*/
+void SpaceSaving::siftUp(std::size_t heapIndex) {
+
+    const std::uint32_t counterIndex = heap[heapIndex];
+    const long count = counters[counterIndex].count;
+    while (heapIndex > 0) {
+        const std::size_t parent = (heapIndex - 1) / 2;
+        if (counters[heap[parent]].count <= count)
+            break;
+        heap[heapIndex] = heap[parent];
+        counters[heap[heapIndex]].heapIndex = static_cast<std::uint32_t>(heapIndex);
+        heapIndex = parent;
+    }
+    heap[heapIndex] = counterIndex;
+    counters[counterIndex].heapIndex = static_cast<std::uint32_t>(heapIndex);
+}
+
+/*
+    Restore the heap order after the count at a heap position increased
+
+    @param[in] heapIndex Position in the heap
+*/
+void SpaceSaving::siftDown(std::size_t heapIndex) {
+
+    const std::uint32_t counterIndex = heap[heapIndex];
+    const long count = counters[counterIndex].count;
+    while (true) {
+        std::size_t child = heapIndex * 2 + 1;
+        if (child >= used)
+            break;
+        if (child + 1 < used && counters[heap[child + 1]].count < counters[heap[child]].count)
+            ++child;
+        if (counters[heap[child]].count >= count)
+            break;
+        heap[heapIndex] = heap[child];
+        counters[heap[heapIndex]].heapIndex = static_cast<std::uint32_t>(heapIndex);
+        heapIndex = child;
+    }
+    heap[heapIndex] = counterIndex;
+    counters[counterIndex].heapIndex = static_cast<std::uint32_t>(heapIndex);
+}
+
+/*
+    Add a counter to the hash table
+
+    @param[in] counterIndex Index of the counter
+*/
+void SpaceSaving::insertSlot(std::uint32_t counterIndex) {
+
+    const std::size_t mask = slots.size() - 1;
+    std::size_t position = counters[counterIndex].hash & mask;
+    while (slots[position])
+        position = (position + 1) & mask;
+    slots[position] = counterIndex + 1;
+}
+
+/*
+    Remove a counter from the hash table, shifting back later entries of the probe sequence
+
+    @param[in] counterIndex Index of the counter
+*/
+void SpaceSaving::eraseSlot(std::uint32_t counterIndex) {
+
+    const std::size_t mask = slots.size() - 1;
+    std::size_t hole = counters[counterIndex].hash & mask;
+    while (slots[hole] != counterIndex + 1)
+        hole = (hole + 1) & mask;
+    slots[hole] = 0;
+
+    for (std::size_t position = (hole + 1) & mask; slots[position]; position = (position + 1) & mask) {
+        const std::size_t home = counters[slots[position] - 1].hash & mask;
+        // entry can move to the hole when its home is not cyclically in (hole, position]
+        const bool inRange = hole < position ? (home > hole && home <= position) : (home > hole || home <= position);
+        if (!inRange) {
+            slots[hole] = slots[position];
+            slots[position] = 0;
+            hole = position;
+        }
+    }
+}
+
+/*
+    Items with the highest counts
+
+    @param[in] n Maximum number of items
+    @return Items, highest count first
+*/
+std::vector<SpaceSaving::Item> SpaceSaving::top(std::size_t n) const {
+
+    std::vector<Item> items;
+    items.reserve(used);
+    for (std::size_t index = 0; index < used; ++index) {
+        const Counter& counter = counters[index];
+        items.push_back({ std::string_view(counter.key, std::min<std::size_t>(counter.size, MAX_KEY_SIZE)), counter.count, counter.error });
+    }
+
+    n = std::min(n, items.size());
+    std::partial_sort(items.begin(), items.begin() + n, items.end(), [](const Item& lhs, const Item& rhs) {
+        return lhs.count != rhs.count ? lhs.count > rhs.count : lhs.key < rhs.key;
+    });
+    items.resize(n);
+
+    return items;
+}
+
+/*
+    @return Bytes used, fixed by the capacity
+*/
+std::size_t SpaceSaving::memoryUsage() const {
+
+    return counters.size() * sizeof(Counter) + heap.size() * sizeof(heap[0]) + slots.size() * sizeof(slots[0]);
+}
+
+/*
+    @param[in] precision Number of index bits p, from 4 to 18
+*/
+HyperLogLog::HyperLogLog(int precision) : precision(precision), registers(std::size_t(1) << precision, 0) {}
+
+/*
+    Add a string
+
+    @param[in] key String to add
+*/
+void HyperLogLog::add(std::string_view key) {
+
+    // seeded differently from the SpaceSaving hash
+    const std::uint64_t hash = hashBytes(key, 0x5BD1E995);
+    const std::size_t index = hash >> (64 - precision);
+
+    // rank is the position of the first 1 bit after the index bits, with a sentinel bit to bound it
+    std::uint64_t remaining = (hash << precision) | (std::uint64_t(1) << (precision - 1));
+    std::uint8_t rank = 1;
+    while (!(remaining & (std::uint64_t(1) << 63))) {
+        remaining <<= 1;
+        ++rank;
+    }
+    registers[index] = std::max(registers[index], rank);
+}
+
+/*
+    @return Estimated number of distinct strings
+*/
+double HyperLogLog::estimate() const {
+
+    const double m = static_cast<double>(registers.size());
+    double alpha = 0.7213 / (1 + 1.079 / m);
+    if (registers.size() == 16)
+        alpha = 0.673;
+    else if (registers.size() == 32)
+        alpha = 0.697;
+    else if (registers.size() == 64)
+        alpha = 0.709;
+
+    double sum = 0;
+    int zeros = 0;
+    for (const auto value : registers) {
+        sum += std::ldexp(1.0, -value);
+        if (value == 0)
+            ++zeros;
+    }
+    const double estimate = alpha * m * m / sum;
+
+    // linear counting for small cardinalities
+    if (estimate <= 2.5 * m && zeros)
+        return m * std::log(m / zeros);
+
+    return estimate;
+}
+
+/*
+    @return Relative standard error of the estimate
+*/
+double HyperLogLog::standardError() const {
+
+    return 1.04 / std::sqrt(static_cast<double>(registers.size()));
+}
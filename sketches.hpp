@@ -0,0 +1,139 @@
+/*
+    sketches.hpp
+
+    Fixed-memory approximate counting of strings:
+    * SpaceSaving keeps the top-K heavy hitters. With k counters over N
+      strings, each reported count overestimates the true count by at most
+      its error, and the error is at most N / k
+    * HyperLogLog estimates the number of distinct strings with 2^p one-byte
+      registers and a standard error of 1.04 / sqrt(2^p)
+
+    Memory use depends only on the configuration, not on the input.
+*/
+
+#ifndef INCLUDED_SKETCHES_HPP
+#define INCLUDED_SKETCHES_HPP
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+class SpaceSaving {
+public:
+
+    // longest stored key, longer keys are compared by hash and prefix
+    static const std::size_t MAX_KEY_SIZE = 64;
+
+    struct Item {
+        std::string_view key;
+        long count;
+        long error;
+    };
+
+    /*
+        @param[in] capacity Number of counters
+    */
+    explicit SpaceSaving(std::size_t capacity);
+
+    /*
+        Count an occurrence of a string
+
+        @param[in] key String to count
+    */
+    void add(std::string_view key);
+
+    /*
+        @return Number of strings counted
+    */
+    [[nodiscard]] long total() const {
+        return totalCount;
+    }
+
+    /*
+        @return Maximum error of any count, total / capacity
+    */
+    [[nodiscard]] long errorBound() const {
+        return totalCount / static_cast<long>(counters.size());
+    }
+
+    /*
+        Items with the highest counts
+
+        @param[in] n Maximum number of items
+        @return Items, highest count first
+    */
+    [[nodiscard]] std::vector<Item> top(std::size_t n) const;
+
+    /*
+        @return Bytes used, fixed by the capacity
+    */
+    [[nodiscard]] std::size_t memoryUsage() const;
+
+private:
+
+    struct Counter {
+        std::uint64_t hash = 0;
+        long count = 0;
+        long error = 0;
+        // position in the heap
+        std::uint32_t heapIndex = 0;
+        std::uint32_t size = 0;
+        char key[MAX_KEY_SIZE];
+    };
+
+    [[nodiscard]] bool matches(const Counter& counter, std::uint64_t hash, std::string_view key) const;
+    void siftDown(std::size_t heapIndex);
+    void siftUp(std::size_t heapIndex);
+    void insertSlot(std::uint32_t counterIndex);
+    void eraseSlot(std::uint32_t counterIndex);
+
+    std::vector<Counter> counters;
+    std::size_t used = 0;
+
+    // min-heap of counter indices by count
+    std::vector<std::uint32_t> heap;
+
+    // open-addressing table of counter index + 1, 0 for empty
+    std::vector<std::uint32_t> slots;
+
+    long totalCount = 0;
+};
+
+class HyperLogLog {
+public:
+
+    /*
+        @param[in] precision Number of index bits p, from 4 to 18
+    */
+    explicit HyperLogLog(int precision);
+
+    /*
+        Add a string
+
+        @param[in] key String to add
+    */
+    void add(std::string_view key);
+
+    /*
+        @return Estimated number of distinct strings
+    */
+    [[nodiscard]] double estimate() const;
+
+    /*
+        @return Relative standard error of the estimate
+    */
+    [[nodiscard]] double standardError() const;
+
+    /*
+        @return Bytes used, fixed by the precision
+    */
+    [[nodiscard]] std::size_t memoryUsage() const {
+        return registers.size();
+    }
+
+private:
+    int precision;
+    std::vector<std::uint8_t> registers;
+};
+
+#endif
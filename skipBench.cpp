@@ -0,0 +1,171 @@
+/*
+    skipBench.cpp
+
+    Microbenchmark of skipping an element subtree compared to fully parsing
+    it. The input is read into memory, then the root element is parsed with
+    the default facts, and separately skipped, for a number of repetitions.
+    The median throughput of each is output.
+
+    Usage: srcfacts_skipbench [--repeat=N] [FILE]
+    With no file, the input is standard input.
+*/
+
+#include <iostream>
+#include <locale>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include "options.hpp"
+#include "refillContent.hpp"
+#include "factsCollector.hpp"
+#include "srcMLParser.hpp"
+#include "skipElement.hpp"
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    /*
+        Position after the start tag of the root element
+
+        @param[in] document Complete document
+        @return Position just after the '>' of the root start tag, or npos
+    */
+    std::size_t rootContentStart(std::string_view document) {
+
+        std::size_t position = 0;
+        while ((position = document.find('<', position)) != document.npos) {
+            if (document.compare(position, "<!--"sv.size(), "<!--"sv) == 0) {
+                position = document.find("-->"sv, position);
+            } else if (document.compare(position, "<?"sv.size(), "<?"sv) == 0) {
+                position = document.find("?>"sv, position);
+            } else if (document.compare(position, "<!"sv.size(), "<!"sv) == 0) {
+                position = document.find('>', position);
+            } else {
+                // root start tag, where quoted attribute values may contain '>'
+                char quote = 0;
+                for (++position; position < document.size(); ++position) {
+                    const char c = document[position];
+                    if (quote) {
+                        if (c == quote)
+                            quote = 0;
+                    } else if (c == '"' || c == '\'') {
+                        quote = c;
+                    } else if (c == '>') {
+                        return position + 1;
+                    }
+                }
+                return document.npos;
+            }
+            if (position == document.npos)
+                break;
+            ++position;
+        }
+
+        return document.npos;
+    }
+
+    /*
+        @param[in] seconds Times of the repetitions
+        @return Median time
+    */
+    double median(std::vector<double> seconds) {
+
+        std::sort(seconds.begin(), seconds.end());
+        return seconds[seconds.size() / 2];
+    }
+}
+
+int main(int argc, char* argv[]) {
+
+    int repeat = 5;
+    std::string filename;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        if (arg.compare(0, "--repeat="sv.size(), "--repeat="sv) == 0) {
+            repeat = std::atoi(arg.data() + "--repeat="sv.size());
+            if (repeat <= 0) {
+                std::cerr << "srcfacts_skipbench: Invalid number of repetitions " << arg << '\n';
+                return 1;
+            }
+        } else if (!arg.empty() && arg[0] != '-' && filename.empty()) {
+            filename = arg;
+        } else {
+            std::cerr << "srcfacts_skipbench: Unknown option " << arg << '\n';
+            return 1;
+        }
+    }
+
+    // read the complete input into memory, decompressing if needed
+    std::string document;
+    {
+        InputSource input;
+        if (!input.open(filename))
+            return 1;
+        std::string_view content;
+        int bytesRead = 0;
+        while ((bytesRead = refillContent(input, content)) > 0) {
+            document.append(content);
+            content.remove_prefix(content.size());
+        }
+        if (bytesRead < 0) {
+            std::cerr << "srcfacts_skipbench: File input error\n";
+            return 1;
+        }
+    }
+    const std::size_t contentStart = rootContentStart(document);
+    if (contentStart == document.npos) {
+        std::cerr << "srcfacts_skipbench: No root element\n";
+        return 1;
+    }
+
+    std::vector<double> parseSeconds;
+    std::vector<double> skipSeconds;
+    long loc = 0;
+    long skippedBytes = 0;
+    for (int run = 0; run < repeat; ++run) {
+
+        // full parse of the document
+        {
+            InputSource input;
+            input.openMemory(document);
+            FactsCollector collector(Options{});
+            const auto startTime = std::chrono::steady_clock::now();
+            if (parseSrcML(input, collector) != 0)
+                return 1;
+            parseSeconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+            loc = collector.facts.loc;
+        }
+
+        // skip of the root element content
+        {
+            InputSource input;
+            input.openMemory(std::string_view(document).substr(contentStart));
+            std::string_view content;
+            const auto startTime = std::chrono::steady_clock::now();
+            skippedBytes = skipElement(input, content);
+            skipSeconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+            if (skippedBytes < 0) {
+                std::cerr << "srcfacts_skipbench: Incomplete root element\n";
+                return 1;
+            }
+        }
+    }
+
+    const double parseMBPerSecond = document.size() / median(parseSeconds) / 1000000;
+    const double skipMBPerSecond = skippedBytes / median(skipSeconds) / 1000000;
+    std::cout.imbue(std::locale{""});
+    std::cout.precision(3);
+    std::cout << document.size() << " bytes\n";
+    std::cout << loc << " LOC\n";
+    std::cout << skippedBytes << " bytes skipped\n";
+    std::cout << parseMBPerSecond << " MB/sec parse\n";
+    std::cout << skipMBPerSecond << " MB/sec skip\n";
+    std::cout << skipMBPerSecond / parseMBPerSecond << "x skip speedup\n";
+
+    return 0;
+}
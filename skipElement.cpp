@@ -0,0 +1,238 @@
+/*
+    skipElement.cpp
+
+    Fast skipping of an element subtree without tokenizing it.
+*/
+
+#include "skipElement.hpp"
+#include "refillContent.hpp"
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SKIP_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SKIP_NEON
+#endif
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    // longest markup prefix that must be visible to classify a '<', "<![CDATA["
+    const std::size_t LOOKAHEAD = 9;
+
+    const std::size_t SCAN_BLOCK = 64;
+
+    /*
+        @param[in] mask Nonzero bitmask
+        @return Position of the lowest set bit
+    */
+    inline int firstBit(std::uint64_t mask) {
+
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(mask);
+#else
+        int position = 0;
+        while (!(mask & 1)) {
+            mask >>= 1;
+            ++position;
+        }
+        return position;
+#endif
+    }
+
+    /*
+        Positions of the characters that change the scan state: '<', '>', '"', and '\''
+
+        @param[in] data Start of a block of SCAN_BLOCK characters
+        @return Bitmask with bit i set when data[i] is one of the characters
+    */
+    inline std::uint64_t markupMask(const char* data) {
+
+#if defined(SKIP_SSE2)
+        const __m128i lt = _mm_set1_epi8('<');
+        const __m128i gt = _mm_set1_epi8('>');
+        const __m128i doubleQuote = _mm_set1_epi8('"');
+        const __m128i singleQuote = _mm_set1_epi8('\'');
+        std::uint64_t mask = 0;
+        for (std::size_t offset = 0; offset < SCAN_BLOCK; offset += 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+            const __m128i matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, lt), _mm_cmpeq_epi8(chunk, gt)),
+                                                 _mm_or_si128(_mm_cmpeq_epi8(chunk, doubleQuote), _mm_cmpeq_epi8(chunk, singleQuote)));
+            mask |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(matches))) << offset;
+        }
+        return mask;
+#elif defined(SKIP_NEON)
+        static const std::uint8_t bitWeights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+        const uint8x16_t weights = vld1q_u8(bitWeights);
+        std::uint64_t mask = 0;
+        for (std::size_t offset = 0; offset < SCAN_BLOCK; offset += 16) {
+            const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const std::uint8_t*>(data + offset));
+            const uint8x16_t matches = vorrq_u8(vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('<')), vceqq_u8(chunk, vdupq_n_u8('>'))),
+                                                vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('"')), vceqq_u8(chunk, vdupq_n_u8('\''))));
+            const uint8x16_t bits = vandq_u8(matches, weights);
+            const std::uint64_t chunkMask = vaddv_u8(vget_low_u8(bits)) | (static_cast<std::uint64_t>(vaddv_u8(vget_high_u8(bits))) << 8);
+            mask |= chunkMask << offset;
+        }
+        return mask;
+#else
+        std::uint64_t mask = 0;
+        for (std::size_t offset = 0; offset < SCAN_BLOCK; ++offset) {
+            const char c = data[offset];
+            if (c == '<' || c == '>' || c == '"' || c == '\'')
+                mask |= std::uint64_t(1) << offset;
+        }
+        return mask;
+#endif
+    }
+
+    /*
+        Positions of the characters that change the scan state in a partial block
+
+        @param[in] data Start of the block
+        @param[in] size Number of characters, less than SCAN_BLOCK
+        @return Bitmask with bit i set when data[i] is one of the characters
+    */
+    std::uint64_t partialMarkupMask(const char* data, std::size_t size) {
+
+        std::uint64_t mask = 0;
+        for (std::size_t offset = 0; offset < size; ++offset) {
+            const char c = data[offset];
+            if (c == '<' || c == '>' || c == '"' || c == '\'')
+                mask |= std::uint64_t(1) << offset;
+        }
+        return mask;
+    }
+
+    /*
+        End of a comment, CDATA, processing instruction, or other declaration
+
+        @param[in] content View of the content
+        @param[in] position Position of the '<'
+        @return Position just after the markup, or npos if the markup is incomplete
+    */
+    std::size_t declarationEnd(std::string_view content, std::size_t position) {
+
+        const std::string_view markup(content.substr(position));
+        std::size_t end = content.npos;
+        if (markup.compare(0, "<!--"sv.size(), "<!--"sv) == 0) {
+            end = content.find("-->"sv, position + "<!--"sv.size());
+            return end == content.npos ? end : end + "-->"sv.size();
+        } else if (markup.compare(0, "<![CDATA["sv.size(), "<![CDATA["sv) == 0) {
+            end = content.find("]]>"sv, position + "<![CDATA["sv.size());
+            return end == content.npos ? end : end + "]]>"sv.size();
+        } else if (markup[1] == '?') {
+            end = content.find("?>"sv, position + "<?"sv.size());
+            return end == content.npos ? end : end + "?>"sv.size();
+        }
+
+        // other declarations
+        end = content.find('>', position);
+        return end == content.npos ? end : end + ">"sv.size();
+    }
+
+    enum ScanState { IN_TEXT, IN_START_TAG, IN_END_TAG, IN_QUOTE };
+}
+
+/*
+    Skip the content of the current element and its end tag
+
+    The content starts just after the '>' of the element start tag. Comments,
+    CDATA, processing instructions, and quoted attribute values are skipped
+    whole, so a '<' or '>' inside them does not change the depth.
+
+    @param[in, out] input Input source
+    @param[in, out] content View of the content
+    @return Number of bytes skipped
+    @retval -1 Input error or incomplete element
+*/
+long skipElement(InputSource& input, std::string_view& content) {
+
+    long skipped = 0;
+    int depth = 1;
+    ScanState state = IN_TEXT;
+    char quote = 0;
+    // start of the current tag, kept on a refill so the tag is scanned again
+    std::size_t markupStart = 0;
+    std::size_t position = 0;
+    bool atEOF = false;
+    while (true) {
+        bool needInput = false;
+        while (!needInput && position < content.size()) {
+            const std::size_t blockSize = std::min(SCAN_BLOCK, content.size() - position);
+            std::uint64_t mask = blockSize == SCAN_BLOCK ? markupMask(content.data() + position)
+                                                         : partialMarkupMask(content.data() + position, blockSize);
+            std::size_t nextPosition = position + blockSize;
+            while (mask) {
+                const std::size_t current = position + firstBit(mask);
+                mask &= mask - 1;
+                const char c = content[current];
+                if (state == IN_TEXT) {
+                    if (c != '<')
+                        continue;
+                    markupStart = current;
+                    if (content.size() - current < (atEOF ? "<>"sv.size() : LOOKAHEAD)) {
+                        needInput = true;
+                        break;
+                    }
+                    const char next = content[current + 1];
+                    if (next == '/') {
+                        state = IN_END_TAG;
+                    } else if (next == '!' || next == '?') {
+                        // markup without tags, so continue the scan after it
+                        const std::size_t end = declarationEnd(content, current);
+                        if (end == content.npos) {
+                            needInput = true;
+                            break;
+                        }
+                        nextPosition = end;
+                        break;
+                    } else {
+                        state = IN_START_TAG;
+                    }
+                } else if (state == IN_START_TAG) {
+                    if (c == '>') {
+                        state = IN_TEXT;
+                        if (content[current - 1] != '/')
+                            ++depth;
+                    } else if (c == '"' || c == '\'') {
+                        state = IN_QUOTE;
+                        quote = c;
+                    }
+                } else if (state == IN_QUOTE) {
+                    if (c == quote)
+                        state = IN_START_TAG;
+                } else if (c == '>') {
+                    // end of end tag
+                    state = IN_TEXT;
+                    --depth;
+                    if (depth == 0) {
+                        content.remove_prefix(current + ">"sv.size());
+                        skipped += static_cast<long>(current + ">"sv.size());
+                        return skipped;
+                    }
+                }
+            }
+            if (!needInput)
+                position = nextPosition;
+        }
+
+        // refill content preserving any incomplete markup
+        if (atEOF)
+            return -1;
+        const std::size_t consumed = needInput || state != IN_TEXT ? markupStart : content.size();
+        content.remove_prefix(consumed);
+        skipped += static_cast<long>(consumed);
+        state = IN_TEXT;
+        position = 0;
+        const int bytesRead = refillContent(input, content);
+        if (bytesRead < 0)
+            return -1;
+        if (bytesRead == 0)
+            atEOF = true;
+    }
+}
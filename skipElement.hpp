@@ -0,0 +1,35 @@
+/*
+    skipElement.hpp
+
+    Fast skipping of an element subtree without tokenizing it. Only the
+    element depth is tracked, by classifying each '<' as a start tag, an
+    end tag, or markup that does not change the depth.
+
+    The content is scanned in blocks of 64 bytes. A bitmask of the
+    positions of '<', '>', '"', and '\'' in each block is computed with
+    SSE2 on x86-64 or NEON on AArch64, with a portable fallback, and only
+    those positions are visited.
+*/
+
+#ifndef INCLUDED_SKIPELEMENT_HPP
+#define INCLUDED_SKIPELEMENT_HPP
+
+#include <string_view>
+
+class InputSource;
+
+/*
+    Skip the content of the current element and its end tag
+
+    The content starts just after the '>' of the element start tag. Comments,
+    CDATA, processing instructions, and quoted attribute values are skipped
+    whole, so a '<' or '>' inside them does not change the depth.
+
+    @param[in, out] input Input source
+    @param[in, out] content View of the content
+    @return Number of bytes skipped
+    @retval -1 Input error or incomplete element
+*/
+[[nodiscard]] long skipElement(InputSource& input, std::string_view& content);
+
+#endif
@@ -0,0 +1,691 @@
+/*
+    srcMLParser.cpp
+
+    Streaming XML parser for srcML.
+
+    The parser is a complete XML parser:
+    * Characters and content from XML is in UTF-8
+    * DTD declarations are allowed, but not fine-grained parsed
+    * No checking for well-formedness
+*/
+
+#include "srcMLParser.hpp"
+#include "refillContent.hpp"
+#include "factsCollector.hpp"
+#include "tokenStream.hpp"
+#include "skipElement.hpp"
+#include "phaseTimes.hpp"
+#include "inputProfile.hpp"
+#include "parseTrace.hpp"
+#include "probes.hpp"
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <bitset>
+#include <cassert>
+#include <cstdlib>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+const std::bitset<128> xmlNameMask("00000111111111111111111111111110100001111111111111111111111111100000001111111111011000000000000000000000000000000000000000000000");
+
+constexpr auto WHITESPACE = " \n\t\r"sv;
+constexpr auto NAMEEND = "> /\":=\n\t\r"sv;
+
+/*
+    Output the error of a failed refill
+
+    @param[in] status Status of refillContent()
+*/
+static void refillError(int status) {
+
+    if (status == REFILL_BUFFER_FULL)
+        std::cerr << "parser error : Token larger than the input buffer\n";
+    else
+        std::cerr << "parser error : File input error\n";
+}
+
+/*
+    Parse a srcML document, with or without instrumentation, i.e., timing
+    the phases of the parse, profiling the tokens of the input, or tracing
+    the parse events
+
+    @tparam instrumented Whether the input has phase times, an input profile, or a parse trace
+    @param[in, out] input Input source
+    @param[in, out] collector Collector of the parse events
+    @param[in] baseDepth Depth of the first element, 1 for child units of an archive
+    @return Status
+    @retval 0 Success
+    @retval -1 Input error or invalid XML
+*/
+template <bool instrumented, class Collector>
+static int parseDocument(InputSource& input, Collector& collector, int baseDepth) {
+
+    [[maybe_unused]] PhaseTimes* const phaseTimes = input.timedPhases();
+    [[maybe_unused]] InputProfile* const inputProfile = input.profile();
+    [[maybe_unused]] ParseTrace* const trace = input.trace();
+    std::string_view content;
+    // trace an event with data in the content, which the offset of the data is found from
+    [[maybe_unused]] const auto traceEvent = [&](TraceEventType type, std::string_view data, std::string_view name = ""sv) {
+        if constexpr (instrumented) {
+            if (trace)
+                trace->add(type, input.totalBytes() - (content.data() + content.size() - data.data()), data.size(), name);
+        }
+    };
+    traceEvent(START_DOCUMENT_EVENT, content);
+    int bytesRead = refillContent(input, content);
+    if (bytesRead < 0) {
+        refillError(bytesRead);
+        return -1;
+    }
+    if (bytesRead == 0) {
+        std::cerr << "parser error : Empty file\n";
+        return -1;
+    }
+    [[maybe_unused]] const std::uint64_t prologStart = instrumented && phaseTimes ? readCycles() : 0;
+    [[maybe_unused]] const long prologOffset = input.totalBytes() - static_cast<long>(content.size());
+    // inside the root element, e.g., resuming after a child unit, whitespace is content
+    if (baseDepth == 0)
+        content.remove_prefix(content.find_first_not_of(WHITESPACE));
+    if (content[0] == '<' && content[1] == '?' && content[2] == 'x' && content[3] == 'm' && content[4] == 'l' && content[5] == ' ') {
+        // parse XML declaration
+        [[maybe_unused]] const char* const declarationStart = content.data();
+        assert(content.compare(0, "<?xml "sv.size(), "<?xml "sv) == 0);
+        content.remove_prefix("<?xml"sv.size());
+        content.remove_prefix(content.find_first_not_of(WHITESPACE));
+        // parse required version
+        std::size_t nameEndPosition = content.find_first_of("= ");
+        const std::string_view attr(content.substr(0, nameEndPosition));
+        content.remove_prefix(nameEndPosition);
+        content.remove_prefix(content.find_first_not_of(WHITESPACE));
+        content.remove_prefix("="sv.size());
+        content.remove_prefix(content.find_first_not_of(WHITESPACE));
+        const char delimiter = content[0];
+        if (delimiter != '"' && delimiter != '\'') {
+            std::cerr << "parser error: Invalid start delimiter for version in XML declaration\n";
+            return -1;
+        }
+        content.remove_prefix("\""sv.size());
+        std::size_t valueEndPosition = content.find(delimiter);
+        if (valueEndPosition == content.npos) {
+            std::cerr << "parser error: Invalid end delimiter for version in XML declaration\n";
+            return -1;
+        }
+        if (attr != "version"sv) {
+            std::cerr << "parser error: Missing required first attribute version in XML declaration\n";
+            return -1;
+        }
+        [[maybe_unused]] const std::string_view version(content.substr(0, valueEndPosition));
+        content.remove_prefix(valueEndPosition);
+        content.remove_prefix("\""sv.size());
+        content.remove_prefix(content.find_first_not_of(WHITESPACE));
+        // parse optional encoding and standalone attributes
+        std::optional<std::string_view> encoding;
+        std::optional<std::string_view> standalone;
+        if (content[0] != '?') {
+            std::size_t nameEndPosition = content.find_first_of("= ");
+            if (nameEndPosition == content.npos) {
+                std::cerr << "parser error: Incomplete attribute in XML declaration\n";
+                return -1;
+            }
+            const std::string_view attr2(content.substr(0, nameEndPosition));
+            content.remove_prefix(nameEndPosition);
+            content.remove_prefix(content.find_first_not_of(WHITESPACE));
+            assert(content.compare(0, "="sv.size(), "="sv) == 0);
+            content.remove_prefix("="sv.size());
+            content.remove_prefix(content.find_first_not_of(WHITESPACE));
+            char delimiter2 = content[0];
+            if (delimiter2 != '"' && delimiter2 != '\'') {
+                std::cerr << "parser error: Invalid end delimiter for attribute " << attr2 << " in XML declaration\n";
+                return -1;
+            }
+            content.remove_prefix("\""sv.size());
+            std::size_t valueEndPosition = content.find(delimiter2);
+            if (valueEndPosition == content.npos) {
+                std::cerr << "parser error: Incomplete attribute " << attr2 << " in XML declaration\n";
+                return -1;
+            }
+            if (attr2 == "encoding"sv) {
+                encoding = content.substr(0, valueEndPosition);
+            } else if (attr2 == "standalone"sv) {
+                standalone = content.substr(0, valueEndPosition);
+            } else {
+                std::cerr << "parser error: Invalid attribute " << attr2 << " in XML declaration\n";
+                return -1;
+            }
+            content.remove_prefix(valueEndPosition + 1);
+            content.remove_prefix(content.find_first_not_of(WHITESPACE));
+        }
+        if (content[0] != '?') {
+            std::size_t nameEndPosition = content.find_first_of("= ");
+            if (nameEndPosition == content.npos) {
+                std::cerr << "parser error: Incomplete attribute in XML declaration\n";
+                return -1;
+            }
+            const std::string_view attr2(content.substr(0, nameEndPosition));
+            content.remove_prefix(nameEndPosition);
+            content.remove_prefix(content.find_first_not_of(WHITESPACE));
+            content.remove_prefix("="sv.size());
+            content.remove_prefix(content.find_first_not_of(WHITESPACE));
+            const char delimiter2 = content[0];
+            if (delimiter2 != '"' && delimiter2 != '\'') {
+                std::cerr << "parser error: Invalid end delimiter for attribute " << attr2 << " in XML declaration\n";
+                return -1;
+            }
+            content.remove_prefix("\""sv.size());
+            std::size_t valueEndPosition = content.find(delimiter2);
+            if (valueEndPosition == content.npos) {
+                std::cerr << "parser error: Incomplete attribute " << attr2 << " in XML declaration\n";
+                return -1;
+            }
+            if (!standalone && attr2 == "standalone"sv) {
+                standalone = content.substr(0, valueEndPosition);
+            } else {
+                std::cerr << "parser error: Invalid attribute " << attr2 << " in XML declaration\n";
+                return -1;
+            }
+            // assert(content[valueEndPosition + 1] == '"');
+            content.remove_prefix(valueEndPosition + 1);
+            content.remove_prefix(content.find_first_not_of(WHITESPACE));
+        }
+        traceEvent(XML_DECLARATION_EVENT, std::string_view(declarationStart, content.data() - declarationStart));
+        assert(content.compare(0, "?>"sv.size(), "?>"sv) == 0);
+        content.remove_prefix("?>"sv.size());
+        content.remove_prefix(content.find_first_not_of(WHITESPACE));
+    }
+    if (content[1] == '!' && content[0] == '<' && content[2] == 'D' && content[3] == 'O' && content[4] == 'C' && content[5] == 'T' && content[6] == 'Y' && content[7] == 'P' && content[8] == 'E' && content[9] == ' ') {
+        // parse DOCTYPE
+        assert(content.compare(0, "<!DOCTYPE "sv.size(), "<!DOCTYPE "sv) == 0);
+        content.remove_prefix("<!DOCTYPE"sv.size());
+        int depthAngleBrackets = 1;
+        bool inSingleQuote = false;
+        bool inDoubleQuote = false;
+        bool inComment = false;
+        std::size_t p = 0;
+        while ((p = content.find_first_of("<>'\"-"sv, p)) != content.npos) {
+            if (content.compare(p, "<!--"sv.size(), "<!--"sv) == 0) {
+                inComment = true;
+                p += "<!--"sv.size();
+                continue;
+            } else if (content.compare(p, "-->"sv.size(), "-->"sv) == 0) {
+                inComment = false;
+                p += "-->"sv.size();
+                continue;
+            }
+            if (inComment) {
+                ++p;
+                continue;
+            }
+            if (content[p] == '<' && !inSingleQuote && !inDoubleQuote) {
+                ++depthAngleBrackets;
+            } else if (content[p] == '>' && !inSingleQuote && !inDoubleQuote) {
+                --depthAngleBrackets;
+            } else if (content[p] == '\'') {
+                inSingleQuote = !inSingleQuote;
+            } else if (content[p] == '"') {
+                inDoubleQuote = !inDoubleQuote;
+            }
+            if (depthAngleBrackets == 0)
+                break;
+            ++p;
+        }
+        [[maybe_unused]] const std::string_view contents(content.substr(0, p));
+        traceEvent(DOCTYPE_EVENT, contents);
+        content.remove_prefix(p);
+        assert(content[0] == '>');
+        content.remove_prefix(">"sv.size());
+        content.remove_prefix(content.find_first_not_of(WHITESPACE));
+    }
+    if constexpr (instrumented) {
+        if (phaseTimes)
+            phaseTimes->add(PROLOG_PHASE, readCycles() - prologStart);
+        if (inputProfile)
+            inputProfile->add(PROLOG_PHASE, input.totalBytes() - static_cast<long>(content.size()) - prologOffset);
+    }
+    int depth = baseDepth;
+    bool doneReading = false;
+    // phase of the current iteration of the loop, whether it is sampled, and its offset
+    [[maybe_unused]] Phase phase = PHASE_COUNT;
+    [[maybe_unused]] bool sampled = false;
+    [[maybe_unused]] long phaseOffset = 0;
+    [[maybe_unused]] const auto endPhase = [&]() {
+        if (phase == PHASE_COUNT)
+            return;
+        if (phaseTimes) {
+            phaseTimes->count(phase);
+            if (sampled)
+                phaseTimes->endSample(phase);
+        }
+        if (inputProfile)
+            inputProfile->add(phase, input.totalBytes() - static_cast<long>(content.size()) - phaseOffset);
+        phase = PHASE_COUNT;
+    };
+    if constexpr (instrumented) {
+        if (phaseTimes)
+            phaseTimes->startLoop();
+    }
+    while (true) {
+        if constexpr (instrumented)
+            endPhase();
+        if (doneReading) {
+            if (content.empty())
+                break;
+        } else if (content.size() < BLOCK_SIZE || (content[0] == '<' && content.find('>') == content.npos)) {
+            // refill content preserving unprocessed, until it has a block and any tag at the start is complete
+            do {
+                const int bytesRead = refillContent(input, content);
+                if (bytesRead < 0) {
+                    refillError(bytesRead);
+                    return -1;
+                }
+                if (bytesRead == 0)
+                    doneReading = true;
+            } while (!doneReading && (content.size() < BLOCK_SIZE || (content[0] == '<' && content.find('>') == content.npos)));
+            // end of a fragment of child units
+            if (content.empty())
+                break;
+        }
+        if constexpr (instrumented) {
+            if (phaseTimes) {
+                sampled = phaseTimes->sampleNext();
+                if (sampled)
+                    phaseTimes->startSample();
+            }
+            phaseOffset = input.totalBytes() - static_cast<long>(content.size());
+        }
+        if (content[0] == '&') {
+            // parse character entity references
+            phase = ENTITY_PHASE;
+            std::string_view unescapedCharacter;
+            std::string_view escapedCharacter;
+            if (content[1] == 'l' && content[2] == 't' && content[3] == ';') {
+                unescapedCharacter = "<";
+                escapedCharacter = "&lt;"sv;
+            } else if (content[1] == 'g' && content[2] == 't' && content[3] == ';') {
+                unescapedCharacter = ">";
+                escapedCharacter = "&gt;"sv;
+            } else if (content[1] == 'a' && content[2] == 'm' && content[3] == 'p' && content[4] == ';') {
+                unescapedCharacter = "&";
+                escapedCharacter = "&amp;"sv;
+            } else {
+                unescapedCharacter = "&";
+                escapedCharacter = "&"sv;
+            }
+            assert(content.compare(0, escapedCharacter.size(), escapedCharacter) == 0);
+            // the trace has the reference, which the decoder converts
+            traceEvent(CHARACTERS_EVENT, content.substr(0, escapedCharacter.size()));
+            content.remove_prefix(escapedCharacter.size());
+            [[maybe_unused]] const std::string_view characters(unescapedCharacter);
+            collector.characters(characters);
+        } else if (content[0] != '<') {
+            // parse character non-entity references
+            phase = CHARACTERS_PHASE;
+            assert(content[0] != '<' && content[0] != '&');
+            std::size_t characterEndPosition = content.find_first_of("<&");
+            const std::string_view characters(content.substr(0, characterEndPosition));
+            traceEvent(CHARACTERS_EVENT, characters);
+            collector.characters(characters);
+            content.remove_prefix(characters.size());
+        } else if (content[1] == '!' /* && content[0] == '<' */ && content[2] == '-' && content[3] == '-') {
+            // parse XML comment
+            phase = COMMENT_PHASE;
+            assert(content.compare(0, "<!--"sv.size(), "<!--"sv) == 0);
+            content.remove_prefix("<!--"sv.size());
+            std::size_t tagEndPosition = content.find("-->"sv);
+            while (tagEndPosition == content.npos && !doneReading) {
+                // refill content preserving unprocessed
+                const int bytesRead = refillContent(input, content);
+                if (bytesRead < 0) {
+                    refillError(bytesRead);
+                    return -1;
+                }
+                if (bytesRead == 0)
+                    doneReading = true;
+                tagEndPosition = content.find("-->"sv);
+            }
+            if (tagEndPosition == content.npos) {
+                std::cerr << "parser error : Unterminated XML comment\n";
+                return -1;
+            }
+            [[maybe_unused]] const std::string_view comment(content.substr(0, tagEndPosition));
+            traceEvent(COMMENT_EVENT, comment);
+            content.remove_prefix(tagEndPosition);
+            content.remove_prefix("-->"sv.size());
+        } else if (content[1] == '!' /* && content[0] == '<' */ && content[2] == '[' && content[3] == 'C' && content[4] == 'D' &&
+                   content[5] == 'A' && content[6] == 'T' && content[7] == 'A' && content[8] == '[') {
+            // parse CDATA
+            phase = CDATA_PHASE;
+            content.remove_prefix("<![CDATA["sv.size());
+            std::size_t tagEndPosition = content.find("]]>"sv);
+            while (tagEndPosition == content.npos && !doneReading) {
+                // refill content preserving unprocessed
+                const int bytesRead = refillContent(input, content);
+                if (bytesRead < 0) {
+                    refillError(bytesRead);
+                    return -1;
+                }
+                if (bytesRead == 0)
+                    doneReading = true;
+                tagEndPosition = content.find("]]>"sv);
+            }
+            if (tagEndPosition == content.npos) {
+                std::cerr << "parser error : Unterminated CDATA\n";
+                return -1;
+            }
+            const std::string_view characters(content.substr(0, tagEndPosition));
+            traceEvent(CDATA_EVENT, characters);
+            collector.characters(characters);
+            content.remove_prefix(tagEndPosition);
+            content.remove_prefix("]]>"sv.size());
+        } else if (content[1] == '?' /* && content[0] == '<' */) {
+            // parse processing instruction
+            phase = PI_PHASE;
+            assert(content.compare(0, "<?"sv.size(), "<?"sv) == 0);
+            content.remove_prefix("<?"sv.size());
+            std::size_t tagEndPosition = content.find("?>"sv);
+            if (tagEndPosition == content.npos) {
+                std::cerr << "parser error: Incomplete XML declaration\n";
+                return -1;
+            }
+            std::size_t nameEndPosition = content.find_first_of(NAMEEND);
+            if (nameEndPosition == content.npos) {
+                std::cerr << "parser error : Unterminated processing instruction\n";
+                return -1;
+            }
+            [[maybe_unused]] const std::string_view target(content.substr(0, nameEndPosition));
+            [[maybe_unused]] const std::string_view data(content.substr(nameEndPosition, tagEndPosition - nameEndPosition));
+            traceEvent(PI_EVENT, content.substr(0, tagEndPosition));
+            content.remove_prefix(tagEndPosition);
+            assert(content.compare(0, "?>"sv.size(), "?>"sv) == 0);
+            content.remove_prefix("?>"sv.size());
+        } else if (content[1] == '/' /* && content[0] == '<' */) {
+            // parse end tag
+            phase = END_TAG_PHASE;
+            assert(content.compare(0, "</"sv.size(), "</"sv) == 0);
+            content.remove_prefix("</"sv.size());
+            if (content[0] == ':') {
+                std::cerr << "parser error : Invalid end tag name\n";
+                return -1;
+            }
+            std::size_t nameEndPosition = content.find_first_of(NAMEEND);
+            if (nameEndPosition == content.size()) {
+                std::cerr << "parser error : Unterminated end tag '" << content.substr(0, nameEndPosition) << "'\n";
+                return -1;
+            }
+            size_t colonPosition = 0;
+            if (content[nameEndPosition] == ':') {
+                colonPosition = nameEndPosition;
+                nameEndPosition = content.find_first_of(NAMEEND, nameEndPosition + 1);
+            }
+            const std::string_view qName(content.substr(0, nameEndPosition));
+            if (qName.empty()) {
+                std::cerr << "parser error: EndTag: invalid element name\n";
+                return -1;
+            }
+            [[maybe_unused]] const std::string_view prefix(qName.substr(0, colonPosition));
+            [[maybe_unused]] const std::string_view localName(qName.substr(colonPosition ? colonPosition + 1 : 0));
+            traceEvent(END_TAG_EVENT, qName, qName);
+            content.remove_prefix(nameEndPosition);
+            content.remove_prefix(content.find_first_not_of(WHITESPACE));
+            assert(content.compare(0, ">"sv.size(), ">"sv) == 0);
+            content.remove_prefix(">"sv.size());
+            --depth;
+            collector.endElement(depth);
+            if (depth == 1)
+                collector.childEnd(input.totalBytes() - static_cast<long>(content.size()));
+            if (depth == 0)
+                break;
+        } else if (content[0] == '<') {
+            // parse start tag
+            phase = START_TAG_PHASE;
+            const long tagOffset = input.totalBytes() - static_cast<long>(content.size());
+            assert(content.compare(0, "<"sv.size(), "<"sv) == 0);
+            content.remove_prefix("<"sv.size());
+            if (content[0] == ':') {
+                std::cerr << "parser error : Invalid start tag name\n";
+                return -1;
+            }
+            std::size_t nameEndPosition = content.find_first_of(NAMEEND);
+            if (nameEndPosition == content.size()) {
+                std::cerr << "parser error : Unterminated start tag '" << content.substr(0, nameEndPosition) << "'\n";
+                return -1;
+            }
+            size_t colonPosition = 0;
+            if (content[nameEndPosition] == ':') {
+                colonPosition = nameEndPosition;
+                nameEndPosition = content.find_first_of(NAMEEND, nameEndPosition + 1);
+            }
+            const std::string_view qName(content.substr(0, nameEndPosition));
+            if (qName.empty()) {
+                std::cerr << "parser error: StartTag: invalid element name\n";
+                return -1;
+            }
+            [[maybe_unused]] const std::string_view prefix(qName.substr(0, colonPosition));
+            const std::string_view localName(qName.substr(colonPosition ? colonPosition + 1 : 0, nameEndPosition));
+            traceEvent(START_TAG_EVENT, qName, qName);
+            const bool inEscape = localName == "escape"sv;
+            collector.startElement(depth, prefix, localName);
+            if (depth == 1)
+                collector.childStart(tagOffset);
+            content.remove_prefix(nameEndPosition);
+            content.remove_prefix(content.find_first_not_of(WHITESPACE));
+            [[maybe_unused]] const std::size_t attributesSize = content.size();
+            [[maybe_unused]] int attributeCount = 0;
+            while (xmlNameMask[content[0]]) {
+                if constexpr (instrumented)
+                    ++attributeCount;
+                if (content[0] == 'x' && content[1] == 'm' && content[2] == 'l' && content[3] == 'n' && content[4] == 's' && (content[5] == ':' || content[5] == '=')) {
+                    // parse XML namespace
+                    assert(content.compare(0, "xmlns"sv.size(), "xmlns"sv) == 0);
+                    content.remove_prefix("xmlns"sv.size());
+                    std::size_t nameEndPosition = content.find('=');
+                    if (nameEndPosition == content.npos) {
+                        std::cerr << "parser error : incomplete namespace\n";
+                        return -1;
+                    }
+                    std::size_t prefixSize = 0;
+                    if (content[0] == ':') {
+                        content.remove_prefix(":"sv.size());
+                        --nameEndPosition;
+                        prefixSize = nameEndPosition;
+                    }
+                    [[maybe_unused]] const std::string_view prefix(content.substr(0, prefixSize));
+                    content.remove_prefix(nameEndPosition);
+                    content.remove_prefix("="sv.size());
+                    content.remove_prefix(content.find_first_not_of(WHITESPACE));
+                    if (content.empty()) {
+                        std::cerr << "parser error : incomplete namespace\n";
+                        return -1;
+                    }
+                    const char delimiter = content[0];
+                    if (delimiter != '"' && delimiter != '\'') {
+                        std::cerr << "parser error : incomplete namespace\n";
+                        return -1;
+                    }
+                    content.remove_prefix("\""sv.size());
+                    std::size_t valueEndPosition = content.find(delimiter);
+                    if (valueEndPosition == content.npos) {
+                        std::cerr << "parser error : incomplete namespace\n";
+                        return -1;
+                    }
+                    [[maybe_unused]] const std::string_view uri(content.substr(0, valueEndPosition));
+                    traceEvent(NAMESPACE_EVENT, uri, prefix);
+                    content.remove_prefix(valueEndPosition);
+                    assert(content.compare(0, "\""sv.size(), "\""sv) == 0);
+                    content.remove_prefix("\""sv.size());
+                    content.remove_prefix(content.find_first_not_of(WHITESPACE));
+                } else {
+                    // parse attribute
+                    std::size_t nameEndPosition = content.find_first_of(NAMEEND);
+                    if (nameEndPosition == content.size()) {
+                        std::cerr << "parser error : Empty attribute name" << '\n';
+                        return -1;
+                    }
+                    size_t colonPosition = 0;
+                    if (content[nameEndPosition] == ':') {
+                        colonPosition = nameEndPosition;
+                        nameEndPosition = content.find_first_of(NAMEEND, nameEndPosition + 1);
+                    }
+                    const std::string_view qName(content.substr(0, nameEndPosition));
+                    [[maybe_unused]] const std::string_view prefix(qName.substr(0, colonPosition));
+                    const std::string_view localName(qName.substr(colonPosition ? colonPosition + 1 : 0));
+                    content.remove_prefix(nameEndPosition);
+                    content.remove_prefix(content.find_first_not_of(WHITESPACE));
+                    if (content.empty()) {
+                        std::cerr << "parser error : attribute " << qName << " incomplete attribute\n";
+                        return -1;
+                    }
+                    if (content[0] != '=') {
+                        std::cerr << "parser error : attribute " << qName << " missing =\n";
+                        return -1;
+                    }
+                    content.remove_prefix("="sv.size());
+                    content.remove_prefix(content.find_first_not_of(WHITESPACE));
+                    const char delimiter = content[0];
+                    if (delimiter != '"' && delimiter != '\'') {
+                        std::cerr << "parser error : attribute " << qName << " missing delimiter\n";
+                        return -1;
+                    }
+                    content.remove_prefix("\""sv.size());
+                    std::size_t valueEndPosition = content.find(delimiter);
+                    if (valueEndPosition == content.npos) {
+                        std::cerr << "parser error : attribute " << qName << " missing delimiter\n";
+                        return -1;
+                    }
+                    const std::string_view value(content.substr(0, valueEndPosition));
+                    collector.attribute(localName, value);
+                    traceEvent(ATTRIBUTE_EVENT, value, qName);
+                    // convert special srcML escaped element to characters
+                    if (inEscape && localName == "char"sv /* && inUnit */) {
+                        // use strtol() instead of atoi() since strtol() understands hex encoding of '0x0?'
+                        [[maybe_unused]] char escapeValue = (char)strtol(value.data(), NULL, 0);
+                    }
+                    content.remove_prefix(valueEndPosition);
+                    content.remove_prefix("\""sv.size());
+                    content.remove_prefix(content.find_first_not_of(WHITESPACE));
+                }
+            }
+            if constexpr (instrumented) {
+                if (inputProfile)
+                    inputProfile->addAttributes(attributeCount, static_cast<long>(attributesSize - content.size()));
+            }
+            if (content[0] == '>') {
+                content.remove_prefix(">"sv.size());
+                if (collector.endStartTag()) {
+                    traceEvent(SKIP_ELEMENT_EVENT, content.substr(0, 0), qName);
+                    // skips are few and long, so each is timed
+                    phase = SKIP_PHASE;
+                    if constexpr (instrumented) {
+                        if (phaseTimes && !sampled)
+                            phaseTimes->startSample();
+                        sampled = true;
+                    }
+                    // the skip refills the buffer that qName is in
+                    const std::string skippedName(qName);
+                    const long skippedBytes = skipElement(input, content);
+                    if (skippedBytes < 0) {
+                        std::cerr << "parser error : Incomplete element '" << skippedName << "'\n";
+                        return -1;
+                    }
+                    collector.skippedElement(skippedBytes);
+                    if (depth == 1)
+                        collector.childEnd(input.totalBytes() - static_cast<long>(content.size()));
+                    if (depth == 0)
+                        break;
+                    continue;
+                }
+                ++depth;
+            } else if (content[0] == '/' && content[1] == '>') {
+                assert(content.compare(0, "/>"sv.size(), "/>") == 0);
+                content.remove_prefix("/>"sv.size());
+                // at the end of the start tag, since the events are in the order of the input
+                traceEvent(END_TAG_EVENT, content.substr(0, 0), qName);
+                collector.endEmptyElement();
+                if (depth == 1)
+                    collector.childEnd(input.totalBytes() - static_cast<long>(content.size()));
+                if (depth == 0)
+                    break;
+            }
+        } else {
+            std::cerr << "parser error : invalid XML document\n";
+            return -1;
+        }
+    }
+    if constexpr (instrumented) {
+        endPhase();
+        if (phaseTimes)
+            phaseTimes->stopLoop();
+    }
+    [[maybe_unused]] const long epilogOffset = input.totalBytes() - static_cast<long>(content.size());
+    content.remove_prefix(content.find_first_not_of(WHITESPACE) == content.npos ? content.size() : content.find_first_not_of(WHITESPACE));
+    while (!content.empty() && content[0] == '<' && content[1] == '!' && content[2] == '-' && content[3] == '-') {
+        // parse XML comment
+        assert(content.compare(0, "<!--"sv.size(), "<!--"sv) == 0);
+        content.remove_prefix("<!--"sv.size());
+        std::size_t tagEndPosition = content.find("-->"sv);
+        while (tagEndPosition == content.npos && !doneReading) {
+            // refill content preserving unprocessed
+            const int bytesRead = refillContent(input, content);
+            if (bytesRead < 0) {
+                refillError(bytesRead);
+                return -1;
+            }
+            if (bytesRead == 0)
+                doneReading = true;
+            tagEndPosition = content.find("-->"sv);
+        }
+        if (tagEndPosition == content.npos) {
+            std::cerr << "parser error : Unterminated XML comment\n";
+            return -1;
+        }
+        [[maybe_unused]] const std::string_view comment(content.substr(0, tagEndPosition));
+        traceEvent(COMMENT_EVENT, comment);
+        content.remove_prefix(tagEndPosition);
+        assert(content.compare(0, "-->"sv.size(), "-->"sv) == 0);
+        content.remove_prefix("-->"sv.size());
+        content.remove_prefix(content.find_first_not_of(WHITESPACE) == content.npos ? content.size() : content.find_first_not_of(WHITESPACE));
+    }
+    if (!content.empty()) {
+        std::cerr << "parser error : extra content at end of document\n";
+        return -1;
+    }
+    if constexpr (instrumented) {
+        if (inputProfile)
+            inputProfile->add(PROLOG_PHASE, input.totalBytes() - epilogOffset);
+    }
+    traceEvent(END_DOCUMENT_EVENT, content);
+
+    return 0;
+}
+
+/*
+    Parse a srcML document, passing the parse events to the collector,
+    e.g., a FactsCollector or a TokenWriter. Errors are output to standard
+    error.
+
+    @param[in, out] input Input source
+    @param[in, out] collector Collector of the parse events
+    @param[in] baseDepth Depth of the first element, 1 for child units of an archive
+    @return Status
+    @retval 0 Success
+    @retval -1 Input error or invalid XML
+*/
+template <class Collector>
+int parseSrcML(InputSource& input, Collector& collector, int baseDepth) {
+
+    // instrumentation is in its own instantiation of the parser, so a parse without it has no instrumentation code at all
+    const int status = input.timedPhases() || input.profile() || input.trace() ?
+        parseDocument<true>(input, collector, baseDepth) : parseDocument<false>(input, collector, baseDepth);
+    if (status != 0)
+        SRCFACTS_PROBE1(parse__error, input.totalBytes());
+    else
+        SRCFACTS_PROBE1(document__end, input.totalBytes());
+
+    return status;
+}
+
+// parse for the facts, and to compile to a token stream
+template int parseSrcML(InputSource& input, FactsCollector& collector, int baseDepth);
+template int parseSrcML(InputSource& input, TokenWriter& collector, int baseDepth);
@@ -0,0 +1,37 @@
+/*
+    srcMLParser.hpp
+
+    Streaming XML parser for srcML. Parse events are passed to a
+    FactsCollector, which can request that an element is skipped, or to a
+    TokenWriter to compile the document to a token stream.
+
+    The input can also be a fragment of one or more child units of an
+    archive, e.g., from a unit index or a compressed block, parsed at a
+    base depth of 1.
+
+    When the input has phase times, the phases of the parse are timed, when
+    it has an input profile, the tokens of the input are profiled, and when
+    it has a parse trace, the parse events are traced.
+*/
+
+#ifndef INCLUDED_SRCMLPARSER_HPP
+#define INCLUDED_SRCMLPARSER_HPP
+
+class InputSource;
+
+/*
+    Parse a srcML document, passing the parse events to the collector,
+    e.g., a FactsCollector or a TokenWriter. Errors are output to standard
+    error.
+
+    @param[in, out] input Input source
+    @param[in, out] collector Collector of the parse events
+    @param[in] baseDepth Depth of the first element, 1 for child units of an archive
+    @return Status
+    @retval 0 Success
+    @retval -1 Input error or invalid XML
+*/
+template <class Collector>
+[[nodiscard]] int parseSrcML(InputSource& input, Collector& collector, int baseDepth = 0);
+
+#endif
@@ -6,641 +6,1066 @@
     and output is a markdown table with the measures. Performance statistics
     are output to standard error.
 
-    The code includes a complete XML parser:
-    * Characters and content from XML is in UTF-8
-    * DTD declarations are allowed, but not fine-grained parsed
-    * No checking for well-formedness
+    The XML parser is in srcMLParser.cpp, and the measures are collected
+    from its parse events by a FactsCollector.
 */
 
 #include <iostream>
 #include <locale>
-#include <iterator>
 #include <string>
 #include <algorithm>
 #include <string_view>
-#include <optional>
 #include <iomanip>
 #include <cmath>
-#include <algorithm>
 #include <chrono>
 #include <memory>
-#include <bitset>
-#include <cassert>
-#include <archive.h>
-#include <archive_entry.h>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include "options.hpp"
+#include "refillContent.hpp"
+#include "factsCollector.hpp"
+#include "srcMLParser.hpp"
+#include "unitIndex.hpp"
+#include "mappedFile.hpp"
+#include "blockArchive.hpp"
+#include "tokenStream.hpp"
+#include "factStore.hpp"
+#include "factDiff.hpp"
+#include "unitSample.hpp"
+#include "partialResults.hpp"
+#include "checkpoint.hpp"
+#include "phaseTimes.hpp"
+#include "perfCounters.hpp"
+#include "inputProfile.hpp"
+#include "parseTrace.hpp"
+#include "memoryUsage.hpp"
 
 // provides literal string operator""sv
 using namespace std::literals::string_view_literals;
 
-const int BLOCK_SIZE = 4096;
-const int BUFFER_SIZE = 16 * 16 * BLOCK_SIZE;
+namespace {
 
-const std::bitset<128> xmlNameMask("00000111111111111111111111111110100001111111111111111111111111100000001111111111011000000000000000000000000000000000000000000000");
+    /*
+        @param[in] totalBytes Size of the input
+        @return Width of the values in the report tables
+    */
+    int reportValueWidth(long totalBytes) {
 
-constexpr auto WHITESPACE = " \n\t\r"sv;
-constexpr auto NAMEEND = "> /\":=\n\t\r"sv;
+        return std::max(5, static_cast<int>(log10(totalBytes) * 1.3 + 1));
+    }
 
-/*
-    Refill the content preserving the existing data.
+    /*
+        Output the title and the facts table of the report
 
-    @param[in, out] content View of the content
-    @return Number of bytes read
-    @retval 0 EOF
-    @retval -1 Read error
-*/
-[[nodiscard]] int refillContent(std::string_view& content) {
-
-    // libarchive input setup
-    static archive *inputArchive = nullptr;
-    if (!inputArchive) {
-        inputArchive = archive_read_new();
-        archive_read_support_format_all(inputArchive);
-        archive_read_support_filter_all(inputArchive);
-        archive_read_support_format_raw(inputArchive);
-        archive_read_support_format_empty(inputArchive);
-        int status = archive_read_open_fd(inputArchive, 0, BUFFER_SIZE);
-        if (status != ARCHIVE_OK) {
-            std::cerr << "input error: Invalid data in standard input\n";
-            return -1;
-        }
-        archive_entry* inputEntry = nullptr;
-        status = archive_read_next_header(inputArchive, &inputEntry);
-        if (status != ARCHIVE_OK) {
-            std::cerr << "input error: Invalid data in standard input header\n";
-            return -1;
+        @param[in] title Title, e.g., the archive url
+        @param[in] facts Facts
+        @param[in] files Number of files, i.e., without the root unit of an archive
+        @param[in] valueWidth Width of the values
+    */
+    void reportFacts(std::string_view title, const Facts& facts, long files, int valueWidth) {
+
+        std::cout << "# srcfacts: " << title << '\n';
+        std::cout << "| Measure      | " << std::setw(valueWidth + 3) << "Value |\n";
+        std::cout << "|:-------------|-" << std::setw(valueWidth + 3) << std::setfill('-') << ":|\n" << std::setfill(' ');
+        for (const auto& column : MEASURE_COLUMNS) {
+            const long value = column.member == &Facts::unitCount ? files : facts.*column.member;
+            std::cout << "| " << std::setw(12) << std::left << column.label << std::right << " | " << std::setw(valueWidth) << value << " |\n";
         }
     }
 
-    // internal buffer for reading from the input archive
-    static char buffer[BUFFER_SIZE];
+    /*
+        Output the function metrics table
 
-    // preserve prefix of unprocessed characters to start of the buffer
-    std::copy(content.cbegin(), content.cend(), buffer);
+        @param[in] histograms Histograms of the function LOC, expressions, declarations, decisions, and complexity
+        @param[in] valueWidth Width of the values
+    */
+    void reportFunctionMetrics(const Histogram (&histograms)[FUNCTION_METRICS_COUNT], int valueWidth) {
 
-    // read the next block
-    auto bytesRead = archive_read_data(inputArchive, buffer + content.size(), BUFFER_SIZE - BLOCK_SIZE);
-    if (bytesRead < 0) {
-        /* ERROR */
-        return -1;
+        const char* const labels[] = {
+            "| LOC          | ",
+            "| Expressions  | ",
+            "| Declarations | ",
+            "| Decisions    | ",
+            "| Complexity   | ",
+        };
+        const int metricWidth = std::max(6, valueWidth);
+        std::cout << "\n## Function Metrics\n";
+        std::cout << "| Measure      | " << std::setw(metricWidth) << "Min" << " | " << std::setw(metricWidth) << "Median"
+                  << " | " << std::setw(metricWidth) << "P95" << " | " << std::setw(metricWidth) << "Max" << " |\n";
+        std::cout << "|:-------------|" << std::setfill('-');
+        for (int column = 0; column < 4; ++column)
+            std::cout << std::setw(metricWidth + 3) << ":|";
+        std::cout << '\n' << std::setfill(' ');
+        for (int metric = 0; metric < FUNCTION_METRICS_COUNT; ++metric) {
+            const Histogram& histogram = histograms[metric];
+            std::cout << labels[metric] << std::setw(metricWidth) << histogram.min()
+                      << " | " << std::setw(metricWidth) << histogram.percentile(50)
+                      << " | " << std::setw(metricWidth) << histogram.percentile(95)
+                      << " | " << std::setw(metricWidth) << histogram.max() << " |\n";
+        }
     }
-    // EOF
-    if (bytesRead == 0) {
-        archive_read_free(inputArchive);
+
+    /*
+        Output the queries table
+
+        @param[in] queryCounts Text and count of each query
+        @param[in] valueWidth Width of the values
+    */
+    void reportQueries(const std::vector<std::pair<std::string, long>>& queryCounts, int valueWidth) {
+
+        int queryWidth = static_cast<int>("Query"sv.size());
+        for (const auto& [text, count] : queryCounts)
+            queryWidth = std::max(queryWidth, static_cast<int>(text.size()) + 2);
+        std::cout << "\n## Queries\n";
+        std::cout << "| " << std::setw(queryWidth) << std::left << "Query" << std::right << " | " << std::setw(valueWidth + 3) << "Count |\n";
+        std::cout << "|:" << std::setw(queryWidth + 1) << std::setfill('-') << "" << "|-" << std::setw(valueWidth + 3) << ":|\n" << std::setfill(' ');
+        for (const auto& [text, count] : queryCounts) {
+            const std::string quoted = "`" + text + "`";
+            std::cout << "| " << std::setw(queryWidth) << std::left << quoted << std::right << " | " << std::setw(valueWidth) << count << " |\n";
+        }
     }
 
-    // set content to the start of the buffer
-    content = std::string_view(buffer, content.size() + bytesRead);
+    /*
+        Output the table of the most frequent identifiers
 
-    return bytesRead;
-}
+        @param[in] topIdentifiers Text and count of the most frequent identifiers
+        @param[in] valueWidth Width of the values
+    */
+    void reportIdentifiers(const std::vector<std::pair<std::string_view, long>>& topIdentifiers, int valueWidth) {
 
-// trace parsing
-#ifdef TRACE
-#undef TRACE
-#define HEADER(m) std::clog << "\033[1m" << std::setw(10) << std::left << m << "\u001b[0m" << '\t'
-#define TRACE0() ""
-#define TRACE1(l1, n1)                         "\033[1m" << l1 << "\u001b[0m" << "|" << "\u001b[31;1m" << n1 << "\u001b[0m" << "| "
-#define TRACE2(l1, n1, l2, n2)                 TRACE1(l1,n1)             << TRACE1(l2,n2)
-#define TRACE3(l1, n1, l2, n2, l3, n3)         TRACE2(l1,n1,l2,n2)       << TRACE1(l3,n3)
-#define TRACE4(l1, n1, l2, n2, l3, n3, l4, n4) TRACE3(l1,n1,l2,n2,l3,n3) << TRACE1(l4,n4)
-#define GET_TRACE(_2,_3,_4,_5,_6,_7,_8,_9,NAME,...) NAME
-#define TRACE(m,...) HEADER(m) << GET_TRACE(__VA_ARGS__, TRACE4, _UNUSED, TRACE3, _UNUSED, TRACE2, _UNUSED, TRACE1, TRACE0, TRACE0)(__VA_ARGS__) << '\n';
-#else
-#define TRACE(...)
-#endif
+        int identifierWidth = static_cast<int>("Identifier"sv.size());
+        for (const auto& [text, count] : topIdentifiers)
+            identifierWidth = std::max(identifierWidth, static_cast<int>(text.size()) + 2);
+        std::cout << "\n## Identifiers\n";
+        std::cout << "| " << std::setw(identifierWidth) << std::left << "Identifier" << std::right << " | " << std::setw(valueWidth + 3) << "Count |\n";
+        std::cout << "|:" << std::setw(identifierWidth + 1) << std::setfill('-') << "" << "|-" << std::setw(valueWidth + 3) << ":|\n" << std::setfill(' ');
+        for (const auto& [text, count] : topIdentifiers) {
+            const std::string quoted = "`" + std::string(text) + "`";
+            std::cout << "| " << std::setw(identifierWidth) << std::left << quoted << std::right << " | " << std::setw(valueWidth) << count << " |\n";
+        }
+    }
 
-int main(int argc, char* argv[]) {
+    /*
+        Output the table of the approximate most frequent identifiers
 
-    const auto startTime = std::chrono::steady_clock::now();
-    std::string url;
-    int textSize = 0;
-    int loc = 0;
-    int exprCount = 0;
-    int functionCount = 0;
-    int classCount = 0;
-    int unitCount = 0;
-    int declCount = 0;
-    int commentCount = 0;
-    long totalBytes = 0;
-    std::string_view content;
-    TRACE("START DOCUMENT");
-    int bytesRead = refillContent(content);
-    if (bytesRead < 0) {
-        std::cerr << "parser error : File input error\n";
-        return 1;
+        @param[in] topItems Text, count, and error of the approximate most frequent identifiers
+        @param[in] distinctSketch Sketch of the number of distinct identifiers
+        @param[in] valueWidth Width of the values
+    */
+    void reportApproximate(const std::vector<SpaceSaving::Item>& topItems, const HyperLogLog& distinctSketch, int valueWidth) {
+
+        int identifierWidth = static_cast<int>("Identifier"sv.size());
+        for (const auto& item : topItems)
+            identifierWidth = std::max(identifierWidth, static_cast<int>(item.key.size()) + 2);
+        std::cout << "\n## Approximate Identifiers\n";
+        std::cout << "Distinct: " << std::llround(distinctSketch.estimate()) << " (standard error " << distinctSketch.standardError() * 100 << "%)\n\n";
+        std::cout << "| " << std::setw(identifierWidth) << std::left << "Identifier" << std::right << " | " << std::setw(valueWidth + 2) << "Count |" << std::setw(valueWidth + 4) << "Error |\n";
+        std::cout << "|:" << std::setw(identifierWidth + 1) << std::setfill('-') << "" << "|-" << std::setw(valueWidth + 2) << ":|" << std::setw(valueWidth + 4) << ":|\n" << std::setfill(' ');
+        for (const auto& item : topItems) {
+            const std::string quoted = "`" + std::string(item.key) + "`";
+            std::cout << "| " << std::setw(identifierWidth) << std::left << quoted << std::right << " | " << std::setw(valueWidth) << item.count << " | " << std::setw(valueWidth) << item.error << " |\n";
+        }
     }
-    if (bytesRead == 0) {
-        std::cerr << "parser error : Empty file\n";
-        return 1;
+
+    /*
+        Output the table of the phase times to standard error. The rest of the
+        parse time, e.g., the loop itself, is other.
+
+        @param[in] phaseTimes Phase times of the parse
+        @param[in] valueWidth Width of the values
+    */
+    void reportPhaseTimes(const PhaseTimes& phaseTimes, int valueWidth) {
+
+        const double totalSeconds = phaseTimes.totalSeconds();
+        std::clog << "\n## Phases\n";
+        std::clog << "| Phase        | " << std::setw(valueWidth + 2) << "Count |" << "      Sec |      % |\n";
+        std::clog << "|:-------------|-" << std::setfill('-') << std::setw(valueWidth + 2) << ":|" << "---------:|-------:|\n" << std::setfill(' ');
+        const auto timeColumns = [&](double seconds) {
+            std::clog << " | " << std::fixed << std::setprecision(4) << std::setw(8) << seconds
+                      << " | " << std::setprecision(1) << std::setw(6) << (totalSeconds > 0 ? 100 * seconds / totalSeconds : 0.0)
+                      << " |\n" << std::defaultfloat << std::setprecision(3);
+        };
+        double otherSeconds = totalSeconds;
+        for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+            const double seconds = phaseTimes.seconds(static_cast<Phase>(phase));
+            otherSeconds -= seconds;
+            std::clog << "| " << std::setw(12) << std::left << PHASE_LABELS[phase] << std::right << " | "
+                      << std::setw(valueWidth) << phaseTimes.occurrences(static_cast<Phase>(phase));
+            timeColumns(seconds);
+        }
+        std::clog << "| Other        | " << std::setw(valueWidth) << "";
+        timeColumns(otherSeconds);
     }
-    totalBytes += bytesRead;
-    content.remove_prefix(content.find_first_not_of(WHITESPACE));
-    if (content[0] == '<' && content[1] == '?' && content[2] == 'x' && content[3] == 'm' && content[4] == 'l' && content[5] == ' ') {
-        // parse XML declaration
-        assert(content.compare(0, "<?xml "sv.size(), "<?xml "sv) == 0);
-        content.remove_prefix("<?xml"sv.size());
-        content.remove_prefix(content.find_first_not_of(WHITESPACE));
-        // parse required version
-        std::size_t nameEndPosition = content.find_first_of("= ");
-        const std::string_view attr(content.substr(0, nameEndPosition));
-        content.remove_prefix(nameEndPosition);
-        content.remove_prefix(content.find_first_not_of(WHITESPACE));
-        content.remove_prefix("="sv.size());
-        content.remove_prefix(content.find_first_not_of(WHITESPACE));
-        const char delimiter = content[0];
-        if (delimiter != '"' && delimiter != '\'') {
-            std::cerr << "parser error: Invalid start delimiter for version in XML declaration\n";
-            return 1;
+
+    /*
+        Output the tables of the token mix of the input to standard error
+
+        @param[in] profile Input profile of the parse
+        @param[in] valueWidth Width of the values
+    */
+    void reportInputProfile(const InputProfile& profile, int valueWidth) {
+
+        const auto percent = [](long part, long whole) {
+            return whole ? 100.0 * part / whole : 0.0;
+        };
+        std::clog << std::fixed << std::setprecision(1);
+
+        // bytes of each kind of token, with the attributes of start tags separately
+        const Histogram& attributesPerTag = profile.attributesPerTag();
+        long attributes = 0;
+        for (std::size_t count = 0; count < attributesPerTag.valueCounts().size(); ++count)
+            attributes += count * attributesPerTag.valueCounts()[count];
+        long totalBytes = profile.attributesBytes();
+        for (int phase = PROLOG_PHASE; phase < PHASE_COUNT; ++phase)
+            totalBytes += profile.bytes(static_cast<Phase>(phase));
+        std::clog << "\n## Input Profile\n";
+        std::clog << "| Token        | " << std::setw(valueWidth) << "Count" << " | " << std::setw(valueWidth + 2) << "Bytes |" << "      % |\n";
+        std::clog << "|:-------------|-" << std::setfill('-') << std::setw(valueWidth + 3) << ":|-" << std::setw(valueWidth + 2) << ":|"
+                  << "-------:|\n" << std::setfill(' ');
+        const auto tokenRow = [&](std::string_view label, long count, long bytes) {
+            std::clog << "| " << std::setw(12) << std::left << label << std::right << " | " << std::setw(valueWidth) << count
+                      << " | " << std::setw(valueWidth) << bytes << " | " << std::setw(6) << percent(bytes, totalBytes) << " |\n";
+        };
+        for (int phase = PROLOG_PHASE; phase < PHASE_COUNT; ++phase) {
+            tokenRow(PHASE_LABELS[phase], profile.count(static_cast<Phase>(phase)), profile.bytes(static_cast<Phase>(phase)));
+            if (phase == START_TAG_PHASE)
+                tokenRow("Attributes", attributes, profile.attributesBytes());
         }
-        content.remove_prefix("\""sv.size());
-        std::size_t valueEndPosition = content.find(delimiter);
-        if (valueEndPosition == content.npos) {
-            std::cerr << "parser error: Invalid end delimiter for version in XML declaration\n";
-            return 1;
+        const long textRuns = profile.count(CHARACTERS_PHASE);
+        std::clog << '\n' << textRuns << " text runs, " << (textRuns ? static_cast<double>(profile.bytes(CHARACTERS_PHASE)) / textRuns : 0.0)
+                  << " bytes average\n";
+
+        // text runs by length, in power-of-two buckets
+        int lastBucket = 0;
+        for (int bucket = 0; bucket < TEXT_RUN_BUCKETS; ++bucket) {
+            if (profile.textRunCount(bucket))
+                lastBucket = bucket;
         }
-        if (attr != "version"sv) {
-            std::cerr << "parser error: Missing required first attribute version in XML declaration\n";
-            return 1;
+        std::clog << "\n## Text Run Lengths\n";
+        std::clog << "| Length       | " << std::setw(valueWidth + 2) << "Runs |" << "      % | Text % |\n";
+        std::clog << "|:-------------|-" << std::setfill('-') << std::setw(valueWidth + 2) << ":|" << "-------:|-------:|\n" << std::setfill(' ');
+        for (int bucket = 0; bucket <= lastBucket; ++bucket) {
+            const long low = 1L << bucket;
+            const std::string length = low == 1 ? "1" : std::to_string(low) + "-" + std::to_string(2 * low - 1);
+            std::clog << "| " << std::setw(12) << std::left << length << std::right << " | " << std::setw(valueWidth) << profile.textRunCount(bucket)
+                      << " | " << std::setw(6) << percent(profile.textRunCount(bucket), textRuns)
+                      << " | " << std::setw(6) << percent(profile.textRunBytes(bucket), profile.bytes(CHARACTERS_PHASE)) << " |\n";
+        }
+
+        // start tags by number of attributes
+        std::clog << "\n## Attributes per Start Tag\n";
+        std::clog << "| Attributes   | " << std::setw(valueWidth + 2) << "Tags |" << "      % |\n";
+        std::clog << "|:-------------|-" << std::setfill('-') << std::setw(valueWidth + 2) << ":|" << "-------:|\n" << std::setfill(' ');
+        for (std::size_t count = 0; count < attributesPerTag.valueCounts().size(); ++count) {
+            const long tags = attributesPerTag.valueCounts()[count];
+            std::clog << "| " << std::setw(12) << std::left << count << std::right << " | " << std::setw(valueWidth) << tags
+                      << " | " << std::setw(6) << percent(tags, attributesPerTag.size()) << " |\n";
         }
-        [[maybe_unused]] const std::string_view version(content.substr(0, valueEndPosition));
-        content.remove_prefix(valueEndPosition);
-        content.remove_prefix("\""sv.size());
-        content.remove_prefix(content.find_first_not_of(WHITESPACE));
-        // parse optional encoding and standalone attributes
-        std::optional<std::string_view> encoding;
-        std::optional<std::string_view> standalone;
-        if (content[0] != '?') {
-            std::size_t nameEndPosition = content.find_first_of("= ");
-            if (nameEndPosition == content.npos) {
-                std::cerr << "parser error: Incomplete attribute in XML declaration\n";
+        std::clog << std::defaultfloat << std::setprecision(3);
+    }
+
+    /*
+        Mergeable results of a run
+
+        @param[in] collector Collector of the run
+        @param[in] options Analyses of the run
+        @param[in] totalBytes Size of the input
+        @return Facts, function metrics, and query counts
+    */
+    PartialResults partialResults(const FactsCollector& collector, const Options& options, long totalBytes) {
+
+        PartialResults results;
+        results.urls.push_back(collector.url);
+        results.totalBytes = totalBytes;
+        results.files = std::max(collector.facts.unitCount - 1, 1L);
+        results.facts = collector.facts;
+        const auto& metrics = collector.functionMetricsCollector;
+        results.functionMetrics = options.functionMetrics;
+        results.histograms[0] = metrics.locHistogram;
+        results.histograms[1] = metrics.exprHistogram;
+        results.histograms[2] = metrics.declHistogram;
+        results.histograms[3] = metrics.decisionHistogram;
+        results.histograms[4] = metrics.complexityHistogram;
+        for (int query = 0; query < collector.pathMatcher.size(); ++query)
+            results.queryCounts.emplace_back(collector.pathMatcher.text(query), collector.pathMatcher.count(query));
+
+        return results;
+    }
+
+    /*
+        Merge partial results files into the report of all of them. Errors are output to standard error.
+
+        @param[in] options Partial results filenames
+        @return Status
+        @retval 0 Success
+        @retval 1 Invalid partial results file
+    */
+    int mergePartials(const Options& options) {
+
+        const auto startTime = std::chrono::steady_clock::now();
+        PartialResults results;
+        for (const auto& path : options.files) {
+            PartialResults partial;
+            if (!loadPartialResults(path, partial)) {
+                std::cerr << "srcfacts: Invalid partial results file " << path << '\n';
                 return 1;
             }
-            const std::string_view attr2(content.substr(0, nameEndPosition));
-            content.remove_prefix(nameEndPosition);
-            content.remove_prefix(content.find_first_not_of(WHITESPACE));
-            assert(content.compare(0, "="sv.size(), "="sv) == 0);
-            content.remove_prefix("="sv.size());
-            content.remove_prefix(content.find_first_not_of(WHITESPACE));
-            char delimiter2 = content[0];
-            if (delimiter2 != '"' && delimiter2 != '\'') {
-                std::cerr << "parser error: Invalid end delimiter for attribute " << attr2 << " in XML declaration\n";
-                return 1;
+            results += partial;
+        }
+
+        std::string title;
+        for (const auto& url : results.urls)
+            title += (title.empty() ? "" : ", ") + url;
+        std::cout.imbue(std::locale{""});
+        const int valueWidth = reportValueWidth(results.totalBytes);
+        reportFacts(title, results.facts, results.files, valueWidth);
+        if (results.functionMetrics)
+            reportFunctionMetrics(results.histograms, valueWidth);
+        if (!results.queryCounts.empty())
+            reportQueries(results.queryCounts, valueWidth);
+        std::cout.flush();
+
+        const auto elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        std::clog.imbue(std::locale{""});
+        std::clog.precision(3);
+        std::clog << '\n' << options.files.size() << " partial results\n";
+        std::clog << results.totalBytes << " bytes\n";
+        std::clog << elapsedSeconds << " sec\n";
+        return 0;
+    }
+
+    /*
+        Output the title and the table of the estimated facts of a sample
+
+        @param[in] title Title, e.g., the archive url
+        @param[in] exactFacts Facts outside the child units
+        @param[in] sample Sampled child units
+        @param[in] valueWidth Width of the values
+    */
+    void reportEstimates(std::string_view title, const Facts& exactFacts, const UnitSample& sample, int valueWidth) {
+
+        std::cout << "# srcfacts: " << title << '\n';
+        std::cout << "| Measure      | " << std::setw(valueWidth + 3) << "Estimate | " << std::setw(valueWidth + 4) << "± 95% |\n";
+        std::cout << "|:-------------|-" << std::setfill('-') << std::setw(valueWidth + 3) << ":|-" << std::setw(valueWidth + 3) << ":|\n"
+                  << std::setfill(' ');
+        for (int column = 0; column < MEASURE_COUNT; ++column) {
+            const auto& measure = MEASURE_COLUMNS[column];
+            const Estimate estimate = sample.estimate(column);
+            long value = exactFacts.*measure.member + std::lround(estimate.value);
+            if (measure.member == &Facts::unitCount)
+                value = std::max(value - 1, 1L);
+            std::cout << "| " << std::setw(12) << std::left << measure.label << std::right << " | " << std::setw(valueWidth) << value
+                      << " | " << std::setw(valueWidth) << std::lround(estimate.margin) << " |\n";
+        }
+    }
+
+    /*
+        Query a fact store: the facts report of the archive, or of the units
+        under a path prefix, and optionally the top files by a measure
+
+        @param[in] options Store filename and query
+        @return Status
+        @retval 0 Success
+        @retval 1 Invalid store
+    */
+    int queryStore(const Options& options) {
+
+        const auto startTime = std::chrono::steady_clock::now();
+        FactStore store;
+        if (!store.open(options.files[0])) {
+            std::cerr << "srcfacts: Invalid fact store " << options.files[0] << '\n';
+            return 1;
+        }
+
+        // the whole archive includes the facts outside the child units
+        const std::string_view prefix(options.storePrefix);
+        Facts facts = prefix.empty() ? store.rootFacts() : Facts();
+        std::vector<std::size_t> units;
+        for (std::size_t unit = 0; unit < store.size(); ++unit) {
+            if (store.filename(unit).compare(0, prefix.size(), prefix) != 0)
+                continue;
+            units.push_back(unit);
+            facts += store.facts(unit);
+        }
+        std::cout.imbue(std::locale{""});
+        const int valueWidth = reportValueWidth(store.totalBytes());
+        if (prefix.empty())
+            reportFacts(store.url(), facts, std::max(facts.unitCount - 1, 1L), valueWidth);
+        else
+            reportFacts(std::string(store.url()) + " " + std::string(prefix), facts, static_cast<long>(units.size()), valueWidth);
+
+        if (options.storeTop) {
+            const int column = measureColumn(options.storeMeasure);
+            const auto top = std::min(units.size(), static_cast<std::size_t>(options.storeTop));
+            std::partial_sort(units.begin(), units.begin() + top, units.end(), [&](std::size_t lhs, std::size_t rhs) {
+                const long lhsValue = store.value(column, lhs);
+                const long rhsValue = store.value(column, rhs);
+                return lhsValue != rhsValue ? lhsValue > rhsValue : lhs < rhs;
+            });
+            units.resize(top);
+            int fileWidth = static_cast<int>("File"sv.size());
+            int languageWidth = static_cast<int>("Language"sv.size());
+            for (const auto unit : units) {
+                fileWidth = std::max(fileWidth, static_cast<int>(store.filename(unit).size()) + 2);
+                languageWidth = std::max(languageWidth, static_cast<int>(store.language(unit).size()));
             }
-            content.remove_prefix("\""sv.size());
-            std::size_t valueEndPosition = content.find(delimiter2);
-            if (valueEndPosition == content.npos) {
-                std::cerr << "parser error: Incomplete attribute " << attr2 << " in XML declaration\n";
-                return 1;
+            const std::string_view label(MEASURE_COLUMNS[column].label);
+            const int measureWidth = std::max(valueWidth, static_cast<int>(label.size()));
+            std::cout << "\n## Top Files by " << label << '\n';
+            std::cout << "| " << std::setw(fileWidth) << std::left << "File" << " | " << std::setw(languageWidth) << "Language" << std::right
+                      << " | " << std::setw(measureWidth) << label << " |\n";
+            std::cout << "|:" << std::setw(fileWidth + 1) << std::setfill('-') << "" << "|:" << std::setw(languageWidth + 1) << ""
+                      << "|-" << std::setw(measureWidth + 3) << ":|\n" << std::setfill(' ');
+            for (const auto unit : units) {
+                const std::string quoted = "`" + std::string(store.filename(unit)) + "`";
+                std::cout << "| " << std::setw(fileWidth) << std::left << quoted << " | " << std::setw(languageWidth) << store.language(unit) << std::right
+                          << " | " << std::setw(measureWidth) << store.value(column, unit) << " |\n";
             }
-            if (attr2 == "encoding"sv) {
-                encoding = content.substr(0, valueEndPosition);
-            } else if (attr2 == "standalone"sv) {
-                standalone = content.substr(0, valueEndPosition);
-            } else {
-                std::cerr << "parser error: Invalid attribute " << attr2 << " in XML declaration\n";
-                return 1;
+        }
+        std::cout.flush();
+
+        const auto elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        std::clog.imbue(std::locale{""});
+        std::clog.precision(3);
+        std::clog << '\n' << store.size() << " units in store\n";
+        std::clog << elapsedSeconds << " sec\n";
+        return 0;
+    }
+
+    /*
+        Output a difference of values, with a sign unless it is zero
+
+        @param[in] delta Difference
+        @param[in] width Width of the value
+    */
+    void reportDelta(long delta, int width) {
+
+        if (delta)
+            std::cout << std::showpos << std::setw(width) << delta << std::noshowpos;
+        else
+            std::cout << std::setw(width) << delta;
+    }
+
+    /*
+        Diff the facts of two archive files, parsing each in its own thread.
+        Units unchanged by hash attribute are parsed in at most one of the archives.
+        Errors are output to standard error.
+
+        @param[in] options Old and new archive filenames
+        @return Status
+        @retval 0 Success
+        @retval 1 Input or parse error
+    */
+    int diffArchives(const Options& options) {
+
+        const auto startTime = std::chrono::steady_clock::now();
+        FactDiff diff;
+        FactsCollector oldCollector(options);
+        FactsCollector newCollector(options);
+        FactsCollector* const collectors[] = { &oldCollector, &newCollector };
+        long totalBytes[] = { 0, 0 };
+        int status[] = { 0, 0 };
+        const auto parseArchive = [&](DiffSide side) {
+            FactsCollector& collector = *collectors[side];
+            collector.factDiff = &diff;
+            collector.diffSide = side;
+            InputSource input;
+            status[side] = input.open(options.files[side]) ? parseSrcML(input, collector) : 1;
+            totalBytes[side] = input.totalBytes();
+        };
+        std::thread oldThread(parseArchive, OLD_ARCHIVE);
+        parseArchive(NEW_ARCHIVE);
+        oldThread.join();
+        if (status[OLD_ARCHIVE] != 0 || status[NEW_ARCHIVE] != 0)
+            return 1;
+
+        // facts of the whole archives include the unchanged units skipped in each
+        const Facts oldFacts = oldCollector.facts + diff.skippedFacts(OLD_ARCHIVE);
+        const Facts newFacts = newCollector.facts + diff.skippedFacts(NEW_ARCHIVE);
+        std::cout.imbue(std::locale{""});
+        const int valueWidth = reportValueWidth(std::max(totalBytes[OLD_ARCHIVE], totalBytes[NEW_ARCHIVE]));
+        std::cout << "# srcfacts diff: " << oldCollector.url << " " << newCollector.url << '\n';
+        std::cout << "| Measure      | " << std::setw(valueWidth + 3) << "Old | " << std::setw(valueWidth + 3) << "New | "
+                  << std::setw(valueWidth + 3) << "Delta |\n";
+        std::cout << "|:-------------|-" << std::setfill('-') << std::setw(valueWidth + 3) << ":|-" << std::setw(valueWidth + 3) << ":|-"
+                  << std::setw(valueWidth + 3) << ":|\n" << std::setfill(' ');
+        for (const auto& column : MEASURE_COLUMNS) {
+            long oldValue = oldFacts.*column.member;
+            long newValue = newFacts.*column.member;
+            if (column.member == &Facts::unitCount) {
+                oldValue = std::max(oldValue - 1, 1L);
+                newValue = std::max(newValue - 1, 1L);
             }
-            content.remove_prefix(valueEndPosition + 1);
-            content.remove_prefix(content.find_first_not_of(WHITESPACE));
+            std::cout << "| " << std::setw(12) << std::left << column.label << std::right << " | " << std::setw(valueWidth) << oldValue
+                      << " | " << std::setw(valueWidth) << newValue << " | ";
+            reportDelta(newValue - oldValue, valueWidth);
+            std::cout << " |\n";
         }
-        if (content[0] != '?') {
-            std::size_t nameEndPosition = content.find_first_of("= ");
-            if (nameEndPosition == content.npos) {
-                std::cerr << "parser error: Incomplete attribute in XML declaration\n";
-                return 1;
+
+        const auto changes = diff.changes();
+        long changeCounts[] = { 0, 0, 0 };
+        for (const auto& change : changes)
+            ++changeCounts[static_cast<int>(change.change)];
+        const std::string_view changeLabels[] = { "Added", "Removed", "Changed" };
+        std::cout << "\n## Files\n";
+        std::cout << "| Change    | " << std::setw(valueWidth + 3) << "Files |\n";
+        std::cout << "|:----------|-" << std::setw(valueWidth + 3) << std::setfill('-') << ":|\n" << std::setfill(' ');
+        for (int change = 0; change < 3; ++change)
+            std::cout << "| " << std::setw(9) << std::left << changeLabels[change] << std::right << " | " << std::setw(valueWidth) << changeCounts[change] << " |\n";
+        std::cout << "| Unchanged | " << std::setw(valueWidth) << diff.unchangedCount() << " |\n";
+
+        // per-file deltas of each measure, except files
+        if (!changes.empty()) {
+            int fileWidth = static_cast<int>("File"sv.size());
+            Facts largest;
+            for (const auto& change : changes) {
+                fileWidth = std::max(fileWidth, static_cast<int>(change.filename.size()) + 2);
+                for (const auto& column : MEASURE_COLUMNS)
+                    largest.*column.member = std::max(largest.*column.member, std::abs(change.delta.*column.member));
             }
-            const std::string_view attr2(content.substr(0, nameEndPosition));
-            content.remove_prefix(nameEndPosition);
-            content.remove_prefix(content.find_first_not_of(WHITESPACE));
-            content.remove_prefix("="sv.size());
-            content.remove_prefix(content.find_first_not_of(WHITESPACE));
-            const char delimiter2 = content[0];
-            if (delimiter2 != '"' && delimiter2 != '\'') {
-                std::cerr << "parser error: Invalid end delimiter for attribute " << attr2 << " in XML declaration\n";
-                return 1;
+            int widths[MEASURE_COUNT];
+            for (int column = 0; column < MEASURE_COUNT; ++column)
+                widths[column] = std::max(static_cast<int>(MEASURE_COLUMNS[column].label.size()), reportValueWidth(largest.*MEASURE_COLUMNS[column].member) + 1);
+            const int filesColumn = measureColumn("files");
+            std::cout << "\n## Changed Files\n";
+            std::cout << "| " << std::setw(fileWidth) << std::left << "File" << " | Change " << std::right;
+            for (int column = 0; column < MEASURE_COUNT; ++column) {
+                if (column != filesColumn)
+                    std::cout << " | " << std::setw(widths[column]) << MEASURE_COLUMNS[column].label;
             }
-            content.remove_prefix("\""sv.size());
-            std::size_t valueEndPosition = content.find(delimiter2);
-            if (valueEndPosition == content.npos) {
-                std::cerr << "parser error: Incomplete attribute " << attr2 << " in XML declaration\n";
-                return 1;
+            std::cout << " |\n|:" << std::setfill('-') << std::setw(fileWidth + 1) << "" << "|:--------";
+            for (int column = 0; column < MEASURE_COUNT; ++column) {
+                if (column != filesColumn)
+                    std::cout << "|-" << std::setw(widths[column] + 1) << ":";
             }
-            if (!standalone && attr2 == "standalone"sv) {
-                standalone = content.substr(0, valueEndPosition);
-            } else {
-                std::cerr << "parser error: Invalid attribute " << attr2 << " in XML declaration\n";
-                return 1;
+            std::cout << "|\n" << std::setfill(' ');
+            for (const auto& change : changes) {
+                const std::string quoted = "`" + change.filename + "`";
+                std::cout << "| " << std::setw(fileWidth) << std::left << quoted << " | " << std::setw(7) << changeLabels[static_cast<int>(change.change)] << std::right;
+                for (int column = 0; column < MEASURE_COUNT; ++column) {
+                    if (column == filesColumn)
+                        continue;
+                    std::cout << " | ";
+                    reportDelta(change.delta.*MEASURE_COLUMNS[column].member, widths[column]);
+                }
+                std::cout << " |\n";
             }
-            // assert(content[valueEndPosition + 1] == '"');
-            content.remove_prefix(valueEndPosition + 1);
-            content.remove_prefix(content.find_first_not_of(WHITESPACE));
-        }
-        TRACE("XML DECLARATION", "version", version, "encoding", (encoding ? *encoding : ""), "standalone", (standalone ? *standalone : ""));
-        assert(content.compare(0, "?>"sv.size(), "?>"sv) == 0);
-        content.remove_prefix("?>"sv.size());
-        content.remove_prefix(content.find_first_not_of(WHITESPACE));
-    }
-    if (content[1] == '!' && content[0] == '<' && content[2] == 'D' && content[3] == 'O' && content[4] == 'C' && content[5] == 'T' && content[6] == 'Y' && content[7] == 'P' && content[8] == 'E' && content[9] == ' ') {
-        // parse DOCTYPE
-        assert(content.compare(0, "<!DOCTYPE "sv.size(), "<!DOCTYPE "sv) == 0);
-        content.remove_prefix("<!DOCTYPE"sv.size());
-        int depthAngleBrackets = 1;
-        bool inSingleQuote = false;
-        bool inDoubleQuote = false;
-        bool inComment = false;
-        std::size_t p = 0;
-        while ((p = content.find_first_of("<>'\"-"sv, p)) != content.npos) {
-            if (content.compare(p, "<!--"sv.size(), "<!--"sv) == 0) {
-                inComment = true;
-                p += "<!--"sv.size();
-                continue;
-            } else if (content.compare(p, "-->"sv.size(), "-->"sv) == 0) {
-                inComment = false;
-                p += "-->"sv.size();
+        }
+        std::cout.flush();
+
+        const auto elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        std::clog.imbue(std::locale{""});
+        std::clog.precision(3);
+        std::clog << '\n';
+        for (const auto side : { OLD_ARCHIVE, NEW_ARCHIVE }) {
+            std::clog << totalBytes[side] << " bytes in " << options.files[side] << ", "
+                      << collectors[side]->filteredUnits << " unchanged units skipped\n";
+        }
+        std::clog << elapsedSeconds << " sec\n";
+        return 0;
+    }
+
+    // uncompressed length of a block of child units when converting to a block-compressed archive
+    const long BLOCK_LENGTH = 1024 * 1024;
+
+    /*
+        Parse parts of the input split across threads, each with its own collector, and add their facts
+
+        @param[in] lengths Length of each part
+        @param[in] options Options, including the number of threads
+        @param[in, out] collector Collector of all parts with one thread, otherwise of the combined facts
+        @param[in] parseParts Parse a range of parts with a collector
+        @return Status
+        @retval 0 Success
+        @retval -1 Error in a part
+    */
+    int parseThreads(const std::vector<long>& lengths, const Options& options, FactsCollector& collector,
+                     const std::function<int(FactsCollector&, std::size_t, std::size_t)>& parseParts) {
+
+        // each thread parses a contiguous range of parts with about the same number of bytes
+        long totalLength = 0;
+        for (const auto length : lengths)
+            totalLength += length;
+        const int threadCount = std::max(1, std::min(options.threads, static_cast<int>(lengths.size())));
+        std::vector<std::size_t> bounds(threadCount + 1, lengths.size());
+        bounds[0] = 0;
+        long length = 0;
+        int thread = 1;
+        for (std::size_t i = 0; i < lengths.size() && thread < threadCount; ++i) {
+            if (length >= totalLength * thread / threadCount)
+                bounds[thread++] = i;
+            length += lengths[i];
+        }
+
+        if (threadCount == 1)
+            return parseParts(collector, 0, lengths.size());
+
+        std::vector<std::unique_ptr<FactsCollector>> collectors;
+        std::vector<int> statuses(threadCount, 0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t) {
+            collectors.push_back(std::make_unique<FactsCollector>(options));
+            threads.emplace_back([&, t]() {
+                statuses[t] = parseParts(*collectors[t], bounds[t], bounds[t + 1]);
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        for (int t = 0; t < threadCount; ++t) {
+            if (statuses[t] != 0)
+                return -1;
+            collector.facts += collectors[t]->facts;
+            collector.filteredUnits += collectors[t]->filteredUnits;
+            collector.filteredBytes += collectors[t]->filteredBytes;
+            collector.unitSample += collectors[t]->unitSample;
+        }
+
+        return 0;
+    }
+
+    /*
+        Parse the units of an indexed archive file, split across threads
+
+        @param[in] archive Contents of the archive file
+        @param[in] index Index of the archive file
+        @param[in] options Options, including the number of threads
+        @param[in, out] collector Collector of all units, or of only the facts with more than one thread
+        @return Status
+        @retval 0 Success
+        @retval -1 Invalid unit
+    */
+    int parseIndexed(std::string_view archive, const UnitIndex& index, const Options& options, FactsCollector& collector) {
+
+        // units of a language that is not selected are not read at all, and without filename globs
+        // neither are units not in the sample
+        const bool sampling = options.sampleFraction > 0 && options.includes.empty() && options.excludes.empty();
+        std::vector<const UnitIndex::Entry*> units;
+        std::vector<long> lengths;
+        for (const auto& unit : index.entries()) {
+            if (!collector.unitFilter.selectedLanguage(index.languages()[unit.language])) {
+                ++collector.filteredUnits;
+                collector.filteredBytes += unit.length;
                 continue;
             }
-            if (inComment) {
-                ++p;
+            if (sampling && !collector.unitSample.selected(&unit - index.entries().data())) {
+                collector.unitSample.skip();
                 continue;
             }
-            if (content[p] == '<' && !inSingleQuote && !inDoubleQuote) {
-                ++depthAngleBrackets;
-            } else if (content[p] == '>' && !inSingleQuote && !inDoubleQuote) {
-                --depthAngleBrackets;
-            } else if (content[p] == '\'') {
-                inSingleQuote = !inSingleQuote;
-            } else if (content[p] == '"') {
-                inDoubleQuote = !inDoubleQuote;
-            }
-            if (depthAngleBrackets == 0)
-                break;
-            ++p;
-        }
-        [[maybe_unused]] const std::string_view contents(content.substr(0, p));
-        TRACE("DOCTYPE", "contents", contents);
-        content.remove_prefix(p);
-        assert(content[0] == '>');
-        content.remove_prefix(">"sv.size());
-        content.remove_prefix(content.find_first_not_of(WHITESPACE));
-    }
-    int depth = 0;
-    bool doneReading = false;
-    while (true) {
-        if (doneReading) {
-            if (content.empty())
-                break;
-        } else if (content.size() < BLOCK_SIZE) {
-            // refill content preserving unprocessed
-            int bytesRead = refillContent(content);
-            if (bytesRead < 0) {
-                std::cerr << "parser error : File input error\n";
-                return 1;
-            }
-            if (bytesRead == 0) {
-                doneReading = true;
-            }
-            totalBytes += bytesRead;
-        }
-        if (content[0] == '&') {
-            // parse character entity references
-            std::string_view unescapedCharacter;
-            std::string_view escapedCharacter;
-            if (content[1] == 'l' && content[2] == 't' && content[3] == ';') {
-                unescapedCharacter = "<";
-                escapedCharacter = "&lt;"sv;
-            } else if (content[1] == 'g' && content[2] == 't' && content[3] == ';') {
-                unescapedCharacter = ">";
-                escapedCharacter = "&gt;"sv;
-            } else if (content[1] == 'a' && content[2] == 'm' && content[3] == 'p' && content[4] == ';') {
-                unescapedCharacter = "&";
-                escapedCharacter = "&amp;"sv;
-            } else {
-                unescapedCharacter = "&";
-                escapedCharacter = "&"sv;
-            }
-            assert(content.compare(0, escapedCharacter.size(), escapedCharacter) == 0);
-            content.remove_prefix(escapedCharacter.size());
-            [[maybe_unused]] const std::string_view characters(unescapedCharacter);
-            TRACE("CHARACTERS", "characters", characters);
-            ++textSize;
-        } else if (content[0] != '<') {
-            // parse character non-entity references
-            assert(content[0] != '<' && content[0] != '&');
-            std::size_t characterEndPosition = content.find_first_of("<&");
-            const std::string_view characters(content.substr(0, characterEndPosition));
-            TRACE("CHARACTERS", "characters", characters);
-            loc += static_cast<int>(std::count(characters.cbegin(), characters.cend(), '\n'));
-            textSize += static_cast<int>(characters.size());
-            content.remove_prefix(characters.size());
-        } else if (content[1] == '!' /* && content[0] == '<' */ && content[2] == '-' && content[3] == '-') {
-            // parse XML comment
-            assert(content.compare(0, "<!--"sv.size(), "<!--"sv) == 0);
-            content.remove_prefix("<!--"sv.size());
-            std::size_t tagEndPosition = content.find("-->"sv);
-            if (tagEndPosition == content.npos) {
-                // refill content preserving unprocessed
-                int bytesRead = refillContent(content);
-                if (bytesRead < 0) {
-                    std::cerr << "parser error : File input error\n";
-                    return 1;
-                }
-                if (bytesRead == 0) {
-                    doneReading = true;
-                }
-                totalBytes += bytesRead;
-                tagEndPosition = content.find("-->"sv);
-                if (tagEndPosition == content.npos) {
-                    std::cerr << "parser error : Unterminated XML comment\n";
-                    return 1;
+            units.push_back(&unit);
+            lengths.push_back(unit.length);
+        }
+
+        // thread collectors only collect facts, so only this collector needs the root
+        collector.replayRoot(index);
+        collector.facts += index.rootFacts;
+
+        return parseThreads(lengths, options, collector, [&](FactsCollector& unitsCollector, std::size_t first, std::size_t last) {
+            InputSource input;
+            for (std::size_t i = first; i < last; ++i) {
+                const std::string_view unit(archive.substr(units[i]->offset, units[i]->length));
+                if (unit.compare(0, "<unit"sv.size(), "<unit"sv) != 0) {
+                    std::cerr << "srcfacts: Index does not match the input at byte " << units[i]->offset << '\n';
+                    return -1;
                 }
+                input.openMemory(unit);
+                unitsCollector.nextUnitNumber = units[i] - index.entries().data();
+                if (parseSrcML(input, unitsCollector, 1) != 0)
+                    return -1;
             }
-            [[maybe_unused]] const std::string_view comment(content.substr(0, tagEndPosition));
-            TRACE("COMMENT", "content", comment);
-            content.remove_prefix(tagEndPosition);
-            content.remove_prefix("-->"sv.size());
-        } else if (content[1] == '!' /* && content[0] == '<' */ && content[2] == '[' && content[3] == 'C' && content[4] == 'D' &&
-                   content[5] == 'A' && content[6] == 'T' && content[7] == 'A' && content[8] == '[') {
-            // parse CDATA
-            content.remove_prefix("<![CDATA["sv.size());
-            std::size_t tagEndPosition = content.find("]]>"sv);
-            if (tagEndPosition == content.npos) {
-                // refill content preserving unprocessed
-                int bytesRead = refillContent(content);
-                if (bytesRead < 0) {
-                    std::cerr << "parser error : File input error\n";
-                    return 1;
-                }
-                if (bytesRead == 0) {
-                    doneReading = true;
-                }
-                totalBytes += bytesRead;
-                tagEndPosition = content.find("]]>"sv);
-                if (tagEndPosition == content.npos) {
-                    std::cerr << "parser error : Unterminated CDATA\n";
-                    return 1;
+            return 0;
+        });
+    }
+
+    /*
+        Parse the blocks of a block-compressed archive file, decompressed and parsed in threads
+
+        @param[in] archive Contents of the archive file
+        @param[in] blocks Blocks of the archive file
+        @param[in] options Options, including the number of threads
+        @param[in, out] collector Collector of the facts
+        @return Status
+        @retval 0 Success
+        @retval -1 Invalid block
+    */
+    int parseBlocks(std::string_view archive, const std::vector<Block>& blocks, const Options& options, FactsCollector& collector) {
+
+        // the first and last blocks, the start and end of the root unit, are a document without child units
+        std::string document;
+        std::string content;
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            if (blocks.size() > 2 && i != 0 && i != blocks.size() - 1)
+                continue;
+            if (!inflateBlock(archive, blocks[i], content)) {
+                std::cerr << "srcfacts: Invalid compressed block at byte " << blocks[i].offset << '\n';
+                return -1;
+            }
+            document += content;
+        }
+        InputSource input;
+        input.openMemory(document);
+        if (parseSrcML(input, collector) != 0)
+            return -1;
+        if (blocks.size() <= 2)
+            return 0;
+
+        std::vector<long> lengths;
+        for (std::size_t i = 1; i < blocks.size() - 1; ++i)
+            lengths.push_back(blocks[i].length);
+
+        return parseThreads(lengths, options, collector, [&](FactsCollector& blocksCollector, std::size_t first, std::size_t last) {
+            InputSource input;
+            std::string content;
+            for (std::size_t i = first + 1; i < last + 1; ++i) {
+                if (!inflateBlock(archive, blocks[i], content)) {
+                    std::cerr << "srcfacts: Invalid compressed block at byte " << blocks[i].offset << '\n';
+                    return -1;
                 }
+                input.openMemory(content);
+                if (parseSrcML(input, blocksCollector, 1) != 0)
+                    return -1;
             }
-            const std::string_view characters(content.substr(0, tagEndPosition));
-            TRACE("CDATA", "characters", characters);
-            textSize += static_cast<int>(characters.size());
-            loc += static_cast<int>(std::count(characters.cbegin(), characters.cend(), '\n'));
-            content.remove_prefix(tagEndPosition);
-            content.remove_prefix("]]>"sv.size());
-        } else if (content[1] == '?' /* && content[0] == '<' */) {
-            // parse processing instruction
-            assert(content.compare(0, "<?"sv.size(), "<?"sv) == 0);
-            content.remove_prefix("<?"sv.size());
-            std::size_t tagEndPosition = content.find("?>"sv);
-            if (tagEndPosition == content.npos) {
-                std::cerr << "parser error: Incomplete XML declaration\n";
-                return 1;
+            return 0;
+        });
+    }
+
+    /*
+        Convert an archive file, e.g., a .xml.gz file, to a block-compressed archive file.
+        Errors are output to standard error.
+
+        @param[in] inputPath Archive filename
+        @param[in] outputPath Block-compressed archive filename
+        @return Whether the archive file was converted
+    */
+    bool convertArchive(const std::string& inputPath, const std::string& outputPath) {
+
+        // child unit boundaries, from the unit index of a parse
+        Options options;
+        options.command = "convert";
+        FactsCollector collector(options);
+        {
+            InputSource input;
+            if (!input.open(inputPath) || parseSrcML(input, collector) != 0)
+                return false;
+        }
+        const auto& units = collector.unitIndex.entries();
+
+        // each block starts at a child unit, and the first block is the start of the root unit
+        std::vector<long> blockStarts;
+        for (const auto& unit : units) {
+            if (blockStarts.empty() || unit.offset - blockStarts.back() >= BLOCK_LENGTH)
+                blockStarts.push_back(unit.offset);
+        }
+
+        BlockWriter writer;
+        if (!writer.open(outputPath)) {
+            std::cerr << "srcfacts: Unable to create " << outputPath << '\n';
+            return false;
+        }
+        const auto writeBlock = [&](std::string_view block) {
+            // an empty block is the end marker
+            if (block.empty() || writer.write(block))
+                return true;
+            std::cerr << "srcfacts: Unable to write " << outputPath << '\n';
+            return false;
+        };
+        InputSource input;
+        if (!input.open(inputPath))
+            return false;
+        std::string block;
+        long blockOffset = 0;
+        std::size_t nextBlock = 0;
+        std::string_view content;
+        int bytesRead = 0;
+        while ((bytesRead = refillContent(input, content)) > 0) {
+            while (nextBlock < blockStarts.size() && blockStarts[nextBlock] <= input.totalBytes()) {
+                const long blockEnd = blockStarts[nextBlock] - (input.totalBytes() - static_cast<long>(content.size()));
+                block.append(content.substr(0, blockEnd));
+                if (!writeBlock(block))
+                    return false;
+                block.clear();
+                content.remove_prefix(blockEnd);
+                blockOffset = blockStarts[nextBlock++];
             }
-            std::size_t nameEndPosition = content.find_first_of(NAMEEND);
-            if (nameEndPosition == content.npos) {
-                std::cerr << "parser error : Unterminated processing instruction\n";
+            block.append(content);
+            content = std::string_view();
+        }
+        if (bytesRead < 0) {
+            std::cerr << "srcfacts: Input error in " << inputPath << '\n';
+            return false;
+        }
+
+        // the last block is the end tag of the root unit, after any whitespace following the last child unit
+        std::size_t tailStart = block.size();
+        if (!units.empty())
+            tailStart = std::min(block.size(), block.find_first_not_of(" \n\t\r", units.back().offset + units.back().length - blockOffset));
+        if (!writeBlock(std::string_view(block).substr(0, tailStart)) || !writeBlock(std::string_view(block).substr(tailStart)))
+            return false;
+        if (!writer.close()) {
+            std::cerr << "srcfacts: Unable to write " << outputPath << '\n';
+            return false;
+        }
+
+        std::clog << units.size() << " units in " << blockStarts.size() + 1 + (tailStart < block.size()) << " blocks\n";
+        return true;
+    }
+
+    /*
+        Compile a srcML file to a token stream file. Errors are output to standard error.
+
+        @param[in] inputPath srcML filename
+        @param[in] outputPath Token stream filename
+        @return Whether the srcML file was compiled
+    */
+    bool compileTokens(const std::string& inputPath, const std::string& outputPath) {
+
+        TokenWriter writer;
+        if (!writer.open(outputPath)) {
+            std::cerr << "srcfacts: Unable to create " << outputPath << '\n';
+            return false;
+        }
+        InputSource input;
+        if (!input.open(inputPath) || parseSrcML(input, writer) != 0)
+            return false;
+        if (!writer.close(input.totalBytes())) {
+            std::cerr << "srcfacts: Unable to write " << outputPath << '\n';
+            return false;
+        }
+
+        std::clog << input.totalBytes() << " bytes compiled to " << writer.size() << " bytes\n";
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+
+    const auto startTime = std::chrono::steady_clock::now();
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+    if (options.command == "convert")
+        return convertArchive(options.files[0], options.files[1]) ? 0 : 1;
+    if (options.command == "compile")
+        return compileTokens(options.files[0], options.files[1]) ? 0 : 1;
+    if (options.command == "query")
+        return queryStore(options);
+    if (options.command == "diff")
+        return diffArchives(options);
+    if (options.command == "merge")
+        return mergePartials(options);
+#ifndef COUNT_ALLOCATIONS
+    if (options.checkAllocations) {
+        std::cerr << "srcfacts: --check-allocations requires the counting allocator, the CMake option COUNT_ALLOCATIONS\n";
+        return 1;
+    }
+#endif
+    FactsCollector collector(options);
+    const bool caching = !options.cachePath.empty();
+    if (caching && !collector.factCache.load(options.cachePath))
+        std::cerr << "srcfacts: Ignoring invalid cache file " << options.cachePath << '\n';
+    long totalBytes = 0;
+    bool parsed = false;
+    if (!options.indexPath.empty()) {
+        // an index is only used for the same unchanged file
+        FileStamp stamp;
+        UnitIndex index;
+        MappedFile archive;
+        if (fileStamp(0, stamp) && index.load(options.indexPath, stamp) && archive.open(0)) {
+            if (parseIndexed(archive.data(), index, options, collector) != 0)
                 return 1;
-            }
-            [[maybe_unused]] const std::string_view target(content.substr(0, nameEndPosition));
-            [[maybe_unused]] const std::string_view data(content.substr(nameEndPosition, tagEndPosition - nameEndPosition));
-            TRACE("PI", "target", target, "data", data);
-            content.remove_prefix(tagEndPosition);
-            assert(content.compare(0, "?>"sv.size(), "?>"sv) == 0);
-            content.remove_prefix("?>"sv.size());
-        } else if (content[1] == '/' /* && content[0] == '<' */) {
-            // parse end tag
-            assert(content.compare(0, "</"sv.size(), "</"sv) == 0);
-            content.remove_prefix("</"sv.size());
-            if (content[0] == ':') {
-                std::cerr << "parser error : Invalid end tag name\n";
+            totalBytes = stamp.size;
+            parsed = true;
+            std::clog << index.entries().size() << " units from index\n";
+        } else {
+            std::cerr << "srcfacts: Ignoring stale or invalid index " << options.indexPath << '\n';
+        }
+    }
+    if (!parsed && options.threads > 1) {
+        // blocks of a block-compressed archive file are decompressed and parsed in the threads
+        MappedFile archive;
+        std::vector<Block> blocks;
+        if (archive.open(0) && readBlocks(archive.data(), blocks)) {
+            if (parseBlocks(archive.data(), blocks, options, collector) != 0)
                 return 1;
-            }
-            std::size_t nameEndPosition = content.find_first_of(NAMEEND);
-            if (nameEndPosition == content.size()) {
-                std::cerr << "parser error : Unterminated end tag '" << content.substr(0, nameEndPosition) << "'\n";
+            for (const auto& block : blocks)
+                totalBytes += block.length;
+            parsed = true;
+            std::clog << blocks.size() << " compressed blocks\n";
+        } else if (options.indexPath.empty()) {
+            std::cerr << "srcfacts: --threads requires --index or a block-compressed archive file as standard input\n";
+            return 1;
+        }
+    }
+    if (!parsed) {
+        // a token stream file from compile is used directly
+        MappedFile tokens;
+        if (tokens.open(0) && isTokenStream(tokens.data())) {
+            if (!options.checkpointPath.empty()) {
+                std::cerr << "srcfacts: --checkpoint requires srcML input\n";
                 return 1;
             }
-            size_t colonPosition = 0;
-            if (content[nameEndPosition] == ':') {
-                colonPosition = nameEndPosition;
-                nameEndPosition = content.find_first_of(NAMEEND, nameEndPosition + 1);
-            }
-            const std::string_view qName(content.substr(0, nameEndPosition));
-            if (qName.empty()) {
-                std::cerr << "parser error: EndTag: invalid element name\n";
+            const std::string_view parseOption = options.checkAllocations ? "--check-allocations"sv : instrumentationOption(options);
+            if (!parseOption.empty()) {
+                std::cerr << "srcfacts: " << parseOption << " requires srcML input\n";
                 return 1;
             }
-            [[maybe_unused]] const std::string_view prefix(qName.substr(0, colonPosition));
-            [[maybe_unused]] const std::string_view localName(qName.substr(colonPosition ? colonPosition + 1 : 0));
-            TRACE("END TAG", "qName", qName, "prefix", prefix, "localName", localName);
-            content.remove_prefix(nameEndPosition);
-            content.remove_prefix(content.find_first_not_of(WHITESPACE));
-            assert(content.compare(0, ">"sv.size(), ">"sv) == 0);
-            content.remove_prefix(">"sv.size());
-            --depth;
-            if (depth == 0)
-                break;
-        } else if (content[0] == '<') {
-            // parse start tag
-            assert(content.compare(0, "<"sv.size(), "<"sv) == 0);
-            content.remove_prefix("<"sv.size());
-            if (content[0] == ':') {
-                std::cerr << "parser error : Invalid start tag name\n";
+            if (parseTokens(tokens.data(), collector, totalBytes) != 0)
                 return 1;
-            }
-            std::size_t nameEndPosition = content.find_first_of(NAMEEND);
-            if (nameEndPosition == content.size()) {
-                std::cerr << "parser error : Unterminated start tag '" << content.substr(0, nameEndPosition) << "'\n";
+            parsed = true;
+        }
+    }
+    PhaseTimes phaseTimes;
+    PerfCounters perfCounters;
+    bool counting = false;
+    InputProfile inputProfile;
+    ParseTrace parseTrace;
+    Progress progress;
+    if (!parsed) {
+        InputSource input;
+        if (!input.open())
+            return 1;
+        if (options.phaseTimes)
+            input.setPhaseTimes(&phaseTimes);
+        if (options.profileInput)
+            input.setProfile(&inputProfile);
+        if (!options.tracePath.empty()) {
+            if (!parseTrace.start(options.tracePath)) {
+                std::cerr << "srcfacts: Unable to create trace file " << options.tracePath << '\n';
                 return 1;
             }
-            size_t colonPosition = 0;
-            if (content[nameEndPosition] == ':') {
-                colonPosition = nameEndPosition;
-                nameEndPosition = content.find_first_of(NAMEEND, nameEndPosition + 1);
+            input.setTrace(&parseTrace);
+        }
+        if (options.progress) {
+            input.setProgress(&progress);
+            collector.progress = &progress;
+        }
+        if (options.perfCounters) {
+            // the run continues without counters when perf events are not permitted or not supported
+            counting = perfCounters.open();
+            if (counting)
+                input.setPerfCounters(&perfCounters);
+            std::string unavailable;
+            for (int counter = 0; counter < COUNTER_COUNT; ++counter) {
+                if (!perfCounters.available(static_cast<Counter>(counter)))
+                    unavailable += (unavailable.empty() ? "" : ", ") + std::string(COUNTER_LABELS[counter]);
             }
-            const std::string_view qName(content.substr(0, nameEndPosition));
-            if (qName.empty()) {
-                std::cerr << "parser error: StartTag: invalid element name\n";
+            if (!unavailable.empty())
+                std::cerr << "srcfacts: No performance counters for " << unavailable << ", " << perfCounters.error() << '\n';
+        }
+
+        // a resumed run skips the input before the checkpoint, and parses the rest as child units of the root
+        int baseDepth = 0;
+        CheckpointWriter checkpointWriter;
+        const bool checkpointing = !options.checkpointPath.empty();
+        if (checkpointing) {
+            // a checkpoint is checked against the identity of the input, so a pipe cannot be resumed
+            if (!fileStamp(0, collector.checkpointStamp)) {
+                std::cerr << "srcfacts: --checkpoint requires a regular file as standard input\n";
                 return 1;
             }
-            [[maybe_unused]] const std::string_view prefix(qName.substr(0, colonPosition));
-            const std::string_view localName(qName.substr(colonPosition ? colonPosition + 1 : 0, nameEndPosition));
-            TRACE("START TAG", "qName", qName, "prefix", prefix, "localName", localName);
-            bool inEscape = localName == "escape"sv;
-            if (localName == "expr"sv) {
-                ++exprCount;
-            } else if (localName == "decl"sv) {
-                ++declCount;
-            } else if (localName == "comment"sv) {
-                ++commentCount;
-            } else if (localName == "function"sv) {
-                ++functionCount;
-            } else if (localName == "unit"sv) {
-                ++unitCount;
-            } else if (localName == "class"sv) {
-                ++classCount;
-            }
-            content.remove_prefix(nameEndPosition);
-            content.remove_prefix(content.find_first_not_of(WHITESPACE));
-            while (xmlNameMask[content[0]]) {
-                if (content[0] == 'x' && content[1] == 'm' && content[2] == 'l' && content[3] == 'n' && content[4] == 's' && (content[5] == ':' || content[5] == '=')) {
-                    // parse XML namespace
-                    assert(content.compare(0, "xmlns"sv.size(), "xmlns"sv) == 0);
-                    content.remove_prefix("xmlns"sv.size());
-                    std::size_t nameEndPosition = content.find('=');
-                    if (nameEndPosition == content.npos) {
-                        std::cerr << "parser error : incomplete namespace\n";
-                        return 1;
-                    }
-                    std::size_t prefixSize = 0;
-                    if (content[0] == ':') {
-                        content.remove_prefix(":"sv.size());
-                        --nameEndPosition;
-                        prefixSize = nameEndPosition;
-                    }
-                    [[maybe_unused]] const std::string_view prefix(content.substr(0, prefixSize));
-                    content.remove_prefix(nameEndPosition);
-                    content.remove_prefix("="sv.size());
-                    content.remove_prefix(content.find_first_not_of(WHITESPACE));
-                    if (content.empty()) {
-                        std::cerr << "parser error : incomplete namespace\n";
-                        return 1;
-                    }
-                    const char delimiter = content[0];
-                    if (delimiter != '"' && delimiter != '\'') {
-                        std::cerr << "parser error : incomplete namespace\n";
-                        return 1;
-                    }
-                    content.remove_prefix("\""sv.size());
-                    std::size_t valueEndPosition = content.find(delimiter);
-                    if (valueEndPosition == content.npos) {
-                        std::cerr << "parser error : incomplete namespace\n";
-                        return 1;
-                    }
-                    [[maybe_unused]] const std::string_view uri(content.substr(0, valueEndPosition));
-                    TRACE("NAMESPACE", "prefix", prefix, "uri", uri);
-                    content.remove_prefix(valueEndPosition);
-                    assert(content.compare(0, "\""sv.size(), "\""sv) == 0);
-                    content.remove_prefix("\""sv.size());
-                    content.remove_prefix(content.find_first_not_of(WHITESPACE));
-                } else {
-                    // parse attribute
-                    std::size_t nameEndPosition = content.find_first_of(NAMEEND);
-                    if (nameEndPosition == content.size()) {
-                        std::cerr << "parser error : Empty attribute name" << '\n';
-                        return 1;
-                    }
-                    size_t colonPosition = 0;
-                    if (content[nameEndPosition] == ':') {
-                        colonPosition = nameEndPosition;
-                        nameEndPosition = content.find_first_of(NAMEEND, nameEndPosition + 1);
-                    }
-                    const std::string_view qName(content.substr(0, nameEndPosition));
-                    [[maybe_unused]] const std::string_view prefix(qName.substr(0, colonPosition));
-                    const std::string_view localName(qName.substr(colonPosition ? colonPosition + 1 : 0));
-                    content.remove_prefix(nameEndPosition);
-                    content.remove_prefix(content.find_first_not_of(WHITESPACE));
-                    if (content.empty()) {
-                        std::cerr << "parser error : attribute " << qName << " incomplete attribute\n";
-                        return 1;
-                    }
-                    if (content[0] != '=') {
-                        std::cerr << "parser error : attribute " << qName << " missing =\n";
-                        return 1;
-                    }
-                    content.remove_prefix("="sv.size());
-                    content.remove_prefix(content.find_first_not_of(WHITESPACE));
-                    const char delimiter = content[0];
-                    if (delimiter != '"' && delimiter != '\'') {
-                        std::cerr << "parser error : attribute " << qName << " missing delimiter\n";
-                        return 1;
-                    }
-                    content.remove_prefix("\""sv.size());
-                    std::size_t valueEndPosition = content.find(delimiter);
-                    if (valueEndPosition == content.npos) {
-                        std::cerr << "parser error : attribute " << qName << " missing delimiter\n";
-                        return 1;
-                    }
-                    const std::string_view value(content.substr(0, valueEndPosition));
-                    if (localName == "url"sv)
-                        url = value;
-                    TRACE("ATTRIBUTE", "qname", qName, "prefix", prefix, "localName", localName, "value", value);
-                    // convert special srcML escaped element to characters
-                    if (inEscape && localName == "char"sv /* && inUnit */) {
-                        // use strtol() instead of atoi() since strtol() understands hex encoding of '0x0?'
-                        [[maybe_unused]] char escapeValue = (char)strtol(value.data(), NULL, 0);
-                    }
-                    content.remove_prefix(valueEndPosition);
-                    content.remove_prefix("\""sv.size());
-                    content.remove_prefix(content.find_first_not_of(WHITESPACE));
+            Checkpoint checkpoint;
+            if (options.resume && loadCheckpoint(options.checkpointPath, checkpoint)) {
+                if (!(checkpoint.stamp == collector.checkpointStamp)) {
+                    std::cerr << "srcfacts: Checkpoint " << options.checkpointPath << " is of another input\n";
+                    return 1;
                 }
+                if (!input.skip(checkpoint.offset)) {
+                    std::cerr << "srcfacts: Input is shorter than the checkpoint\n";
+                    return 1;
+                }
+                collector.restore(checkpoint);
+                baseDepth = checkpoint.depth;
+                std::clog << "Resumed at byte " << checkpoint.offset << '\n';
+            } else if (options.resume) {
+                std::clog << "No checkpoint to resume, starting from the beginning\n";
             }
-            if (content[0] == '>') {
-                content.remove_prefix(">"sv.size());
-                ++depth;
-            } else if (content[0] == '/' && content[1] == '>') {
-                assert(content.compare(0, "/>"sv.size(), "/>") == 0);
-                content.remove_prefix("/>"sv.size());
-                TRACE("END TAG", "qName", qName, "prefix", prefix, "localName", localName);
-                if (depth == 0)
-                    break;
-            }
-        } else {
-            std::cerr << "parser error : invalid XML document\n";
+            checkpointWriter.start(options.checkpointPath);
+            collector.checkpointWriter = &checkpointWriter;
+            collector.interruptAfterCheckpoint = std::getenv("SRCFACTS_INTERRUPT_AFTER_CHECKPOINT") != nullptr;
+        }
+        if (options.progress) {
+            // the ETA is only known for a file
+            FileStamp stamp;
+            progress.start(fileStamp(0, stamp) ? stamp.size : 0);
+        }
+        phaseTimes.start();
+        if (counting)
+            perfCounters.start();
+#ifdef COUNT_ALLOCATIONS
+        // libarchive set up its buffers when the input was opened, and read the first block for the format
+        const AllocationCounts allocationsBefore = allocationCounts();
+#endif
+        const int status = parseSrcML(input, collector, baseDepth);
+#ifdef COUNT_ALLOCATIONS
+        const AllocationCounts allocationsAfter = allocationCounts();
+#endif
+        progress.stop();
+        // a trace of a failed parse is kept, since it shows where the parse failed
+        if (!options.tracePath.empty() && !parseTrace.stop())
+            std::cerr << "srcfacts: Unable to write trace file " << options.tracePath << '\n';
+        if (status != 0)
+            return 1;
+#ifdef COUNT_ALLOCATIONS
+        if (options.checkAllocations && allocationsAfter.allocations != allocationsBefore.allocations) {
+            std::cerr << "srcfacts: " << allocationsAfter.allocations - allocationsBefore.allocations << " heap allocations of "
+                      << allocationsAfter.bytes - allocationsBefore.bytes << " bytes in the parse\n";
             return 1;
         }
+#endif
+        if (counting)
+            perfCounters.stop();
+        phaseTimes.stop();
+        totalBytes = input.totalBytes();
+
+        // a complete run needs no checkpoint
+        if (checkpointing) {
+            if (!checkpointWriter.stop())
+                std::cerr << "srcfacts: Unable to write checkpoint file " << options.checkpointPath << '\n';
+            std::remove(options.checkpointPath.c_str());
+        }
     }
-    content.remove_prefix(content.find_first_not_of(WHITESPACE) == content.npos ? content.size() : content.find_first_not_of(WHITESPACE));
-    while (!content.empty() && content[0] == '<' && content[1] == '!' && content[2] == '-' && content[3] == '-') {
-        // parse XML comment
-        assert(content.compare(0, "<!--"sv.size(), "<!--"sv) == 0);
-        content.remove_prefix("<!--"sv.size());
-        std::size_t tagEndPosition = content.find("-->"sv);
-        if (tagEndPosition == content.npos) {
-            // refill content preserving unprocessed
-            int bytesRead = refillContent(content);
-            if (bytesRead < 0) {
-                std::cerr << "parser error : File input error\n";
-                return 1;
-            }
-            if (bytesRead == 0) {
-                doneReading = true;
-            }
-            totalBytes += bytesRead;
-            tagEndPosition = content.find("-->"sv);
-            if (tagEndPosition == content.npos) {
-                std::cerr << "parser error : Unterminated XML comment\n";
-                return 1;
-            }
+    if (!options.writeIndexPath.empty()) {
+        // offsets are into the uncompressed input, so are only useful when that is the file
+        FileStamp stamp;
+        if (!fileStamp(0, stamp) || stamp.size != totalBytes) {
+            std::cerr << "srcfacts: --write-index requires an uncompressed srcML file as standard input\n";
+        } else {
+            collector.finishIndex();
+            if (!collector.unitIndex.save(options.writeIndexPath, stamp))
+                std::cerr << "srcfacts: Unable to save index file " << options.writeIndexPath << '\n';
         }
-        [[maybe_unused]] const std::string_view comment(content.substr(0, tagEndPosition));
-        TRACE("COMMENT", "content", comment);
-        content.remove_prefix(tagEndPosition);
-        assert(content.compare(0, "-->"sv.size(), "-->"sv) == 0);
-        content.remove_prefix("-->"sv.size());
-        content.remove_prefix(content.find_first_not_of(WHITESPACE) == content.npos ? content.size() : content.find_first_not_of(WHITESPACE));
     }
-    if (!content.empty()) {
-        std::cerr << "parser error : extra content at end of document\n";
-        return 1;
+    if (!options.writeStorePath.empty()) {
+        collector.finishStore();
+        if (!collector.factStore.save(options.writeStorePath, collector.url, totalBytes))
+            std::cerr << "srcfacts: Unable to save fact store " << options.writeStorePath << '\n';
     }
-    TRACE("END DOCUMENT");
+    const Facts& facts = collector.facts;
+    const bool queries = !options.queries.empty();
+    const bool identifiers = options.identifierTop > 0;
+    const bool approximate = options.approximateTop > 0;
     const auto finishTime = std::chrono::steady_clock::now();
     const auto elapsedSeconds = std::chrono::duration_cast<std::chrono::duration<double>>(finishTime - startTime).count();
-    const double MLOCPerSecond = loc / elapsedSeconds / 1000000;
-    int files = std::max(unitCount - 1, 1);
+    const double MLOCPerSecond = facts.loc / elapsedSeconds / 1000000;
+    const PartialResults results = partialResults(collector, options, totalBytes);
+    if (!options.writePartialPath.empty() && !savePartialResults(options.writePartialPath, results))
+        std::cerr << "srcfacts: Unable to save partial results " << options.writePartialPath << '\n';
     std::cout.imbue(std::locale{""});
-    int valueWidth = std::max(5, static_cast<int>(log10(totalBytes) * 1.3 + 1));
-    std::cout << "# srcfacts: " << url << '\n';
-    std::cout << "| Measure      | " << std::setw(valueWidth + 3) << "Value |\n";
-    std::cout << "|:-------------|-" << std::setw(valueWidth + 3) << std::setfill('-') << ":|\n" << std::setfill(' ');
-    std::cout << "| Characters   | " << std::setw(valueWidth) << textSize      << " |\n";
-    std::cout << "| LOC          | " << std::setw(valueWidth) << loc           << " |\n";
-    std::cout << "| Files        | " << std::setw(valueWidth) << files         << " |\n";
-    std::cout << "| Classes      | " << std::setw(valueWidth) << classCount    << " |\n";
-    std::cout << "| Functions    | " << std::setw(valueWidth) << functionCount << " |\n";
-    std::cout << "| Declarations | " << std::setw(valueWidth) << declCount     << " |\n";
-    std::cout << "| Expressions  | " << std::setw(valueWidth) << exprCount     << " |\n";
-    std::cout << "| Comments     | " << std::setw(valueWidth) << commentCount  << " |\n";
+    const int valueWidth = reportValueWidth(totalBytes);
+    if (options.sampleFraction > 0)
+        reportEstimates(collector.url, facts - collector.unitSample.sampledFacts(), collector.unitSample, valueWidth);
+    else
+        reportFacts(collector.url, facts, results.files, valueWidth);
+    if (options.functionMetrics)
+        reportFunctionMetrics(results.histograms, valueWidth);
+    if (queries)
+        reportQueries(results.queryCounts, valueWidth);
+    if (identifiers)
+        reportIdentifiers(collector.identifierTable.top(options.identifierTop), valueWidth);
+    if (approximate)
+        reportApproximate(collector.topKSketch.top(options.approximateTop), collector.distinctSketch, valueWidth);
     std::cout.flush();
     std::clog.imbue(std::locale{""});
     std::clog.precision(3);
@@ -648,5 +1073,59 @@ int main(int argc, char* argv[]) {
     std::clog << totalBytes  << " bytes\n";
     std::clog << elapsedSeconds << " sec\n";
     std::clog << MLOCPerSecond << " MLOC/sec\n";
+    if (counting) {
+        for (int counter = 0; counter < COUNTER_COUNT; ++counter) {
+            if (!perfCounters.available(static_cast<Counter>(counter)))
+                continue;
+            const auto value = perfCounters.value(static_cast<Counter>(counter));
+            const auto inputValue = perfCounters.inputValue(static_cast<Counter>(counter));
+            std::clog << value << ' ' << COUNTER_LABELS[counter] << " (" << (value ? 100.0 * inputValue / value : 0.0) << "% input)\n";
+        }
+        if (perfCounters.available(CYCLES_COUNTER) && perfCounters.available(INSTRUCTIONS_COUNTER) && perfCounters.value(CYCLES_COUNTER))
+            std::clog << static_cast<double>(perfCounters.value(INSTRUCTIONS_COUNTER)) / perfCounters.value(CYCLES_COUNTER) << " IPC\n";
+    }
+    if (options.memoryUsage) {
+        std::clog << peakResidentBytes() / (1024.0 * 1024.0) << " MB peak RSS\n";
+#ifdef COUNT_ALLOCATIONS
+        const AllocationCounts counts = allocationCounts();
+        std::clog << counts.allocations << " heap allocations\n";
+        std::clog << counts.bytes / (1024.0 * 1024.0) << " MB allocated\n";
+#endif
+    }
+    if (options.phaseTimes)
+        reportPhaseTimes(phaseTimes, valueWidth);
+    if (options.profileInput)
+        reportInputProfile(inputProfile, valueWidth);
+    if (caching) {
+        if (!collector.factCache.save(options.cachePath))
+            std::cerr << "srcfacts: Unable to save cache file " << options.cachePath << '\n';
+        std::clog << collector.cacheHits << " of " << collector.cacheUnits << " units from cache ("
+                  << (collector.cacheUnits ? 100.0 * collector.cacheHits / collector.cacheUnits : 0.0) << "%)\n";
+        // estimate the time saved from the parse rate, when some units were parsed
+        const double parseSeconds = elapsedSeconds - collector.cacheSkipSeconds;
+        const long parsedBytes = totalBytes - collector.cacheSkippedBytes;
+        if (collector.cacheHits < collector.cacheUnits && parsedBytes > 0 && parseSeconds > 0)
+            std::clog << collector.cacheSkippedBytes * parseSeconds / parsedBytes - collector.cacheSkipSeconds << " sec saved by cache\n";
+    }
+    if (options.sampleFraction > 0) {
+        const UnitSample& sample = collector.unitSample;
+        std::clog << sample.size() << " of " << sample.population() << " units sampled ("
+                  << (sample.population() ? 100.0 * sample.size() / sample.population() : 0.0) << "%)\n";
+    }
+    if (!options.includes.empty() || !options.excludes.empty() || !options.languages.empty()) {
+        std::clog << collector.filteredUnits << " units skipped by filter\n";
+        std::clog << collector.filteredBytes << " bytes skipped by filter\n";
+    }
+    if (identifiers) {
+        std::clog << collector.identifierTable.total() << " identifiers\n";
+        std::clog << collector.identifierTable.size() << " distinct identifiers\n";
+        std::clog << collector.identifierTable.load() << " identifier table load\n";
+        std::clog << collector.identifierTable.memoryUsage() / (1024.0 * 1024.0) << " MB identifier table\n";
+    }
+    if (approximate) {
+        std::clog << collector.topKSketch.total() << " approximate identifiers\n";
+        std::clog << collector.topKSketch.errorBound() << " top-k count error bound\n";
+        std::clog << (collector.topKSketch.memoryUsage() + collector.distinctSketch.memoryUsage()) / (1024.0 * 1024.0) << " MB sketches\n";
+    }
     return 0;
 }
@@ -0,0 +1,451 @@
+/*
+    syntheticArchive.cpp
+
+    Deterministic synthetic srcML archives for benchmarks.
+*/
+
+#include "syntheticArchive.hpp"
+#include <algorithm>
+#include <charconv>
+#include <numeric>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    // root start tag, followed by the url attribute and '>'
+    const std::string_view ROOT_START = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+                                        "<unit xmlns=\"http://www.srcML.org/srcML/src\" xmlns:cpp=\"http://www.srcML.org/srcML/cpp\""
+                                        " xmlns:pos=\"http://www.srcML.org/srcML/position\" revision=\"1.0.0\""sv;
+
+    // words of text and comments
+    const std::string_view WORDS[] = {
+        "the", "input", "value", "of", "each", "buffer", "is", "read", "into", "memory",
+        "and", "parsed", "for", "a", "count", "when", "unit", "element", "with", "error",
+    };
+
+    // names of identifiers
+    const std::string_view NAMES[] = {
+        "i", "n", "count", "value", "size", "result", "data", "index", "total", "first", "last", "node",
+    };
+
+    // operators, some with entity references
+    const std::string_view OPERATORS[] = { "=", "+", "-", "*", "==", "!=", "+=", "&lt;", "&gt;", "&amp;&amp;" };
+
+    // maximum depth of nested blocks
+    const int MAX_NESTING = 24;
+
+    /*
+        Deterministic random numbers, splitmix64, so that archives are the
+        same on any platform and standard library
+    */
+    class Random {
+    public:
+
+        /*
+            @param[in] seed Seed
+        */
+        explicit Random(std::uint64_t seed)
+            : state(seed) {
+        }
+
+        /*
+            @return Next random number
+        */
+        std::uint64_t next() {
+
+            std::uint64_t value = (state += 0x9e3779b97f4a7c15);
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+            return value ^ (value >> 31);
+        }
+
+        /*
+            @param[in] bound Upper bound, greater than 0
+            @return Random number from 0 to bound - 1
+        */
+        int below(int bound) {
+
+            return static_cast<int>(next() % static_cast<std::uint64_t>(bound));
+        }
+
+        /*
+            @param[in] low Lowest number
+            @param[in] high Highest number
+            @return Random number from low to high
+        */
+        int between(int low, int high) {
+
+            return low + below(high - low + 1);
+        }
+
+    private:
+        std::uint64_t state;
+    };
+
+    /*
+        Generator of the child units of an archive
+    */
+    class Generator {
+    public:
+
+        /*
+            @param[in] mix Mix of the content
+            @param[in] seed Seed of the content
+        */
+        Generator(const SyntheticMix& mix, std::uint64_t seed)
+            : mix(mix), random(seed), totalWeight(std::accumulate(std::begin(mix.weights), std::end(mix.weights), 0)) {
+        }
+
+        /*
+            Append the next child unit
+
+            @param[in, out] out Archive
+            @param[in] size Approximate size of the unit
+        */
+        void unit(std::string& out, long size) {
+
+            const std::size_t start = out.size();
+            out += "<unit revision=\"1.0.0\" language=\"C++\" filename=\"src/file";
+            number(out, unitNumber++);
+            out += ".cpp\" hash=\"";
+            for (int i = 0; i < 40; ++i)
+                out += "0123456789abcdef"[random.below(16)];
+            out += "\">";
+            line = 1;
+            do {
+                function(out);
+            } while (static_cast<long>(out.size() - start) < size);
+            out += "</unit>\n\n";
+        }
+
+    private:
+
+        /*
+            Append a function of random statements
+
+            @param[in, out] out Archive
+        */
+        void function(std::string& out) {
+
+            out += "<function><type><name>void</name></type> <name>f";
+            number(out, functionNumber++);
+            out += "</name><parameter_list>()</parameter_list> <block>{<block_content>\n";
+            ++line;
+            for (int statements = random.between(4, 16); statements > 0; --statements)
+                statement(out);
+            out += "</block_content>}</block></function>\n\n";
+            line += 2;
+        }
+
+        /*
+            Append a statement of a kind of content chosen by the weights of the mix
+
+            @param[in, out] out Archive
+        */
+        void statement(std::string& out) {
+
+            int choice = random.below(totalWeight);
+            int kind = 0;
+            while (choice >= mix.weights[kind])
+                choice -= mix.weights[kind++];
+
+            out += "    ";
+            switch (kind) {
+            case TEXT_CONTENT:
+                // long string literal
+                out += "<expr_stmt><expr><call><name>log</name><argument_list>(<argument><expr><literal type=\"string\">\"";
+                words(out, random.between(20, 60));
+                out += "\"</literal></expr></argument>)</argument_list></call></expr>;</expr_stmt>\n";
+                break;
+            case TAG_CONTENT:
+                // many short elements
+                out += "<expr_stmt><expr>";
+                name(out);
+                for (int terms = random.between(6, 16); terms > 0; --terms) {
+                    out += " <operator>";
+                    out += OPERATORS[random.below(7)];
+                    out += "</operator> ";
+                    if (random.below(4) == 0) {
+                        out += "<literal type=\"number\">";
+                        number(out, random.below(1000));
+                        out += "</literal>";
+                    } else {
+                        name(out);
+                    }
+                }
+                out += "</expr>;</expr_stmt>\n";
+                break;
+            case NESTING_CONTENT: {
+                // nested if statements, one per line
+                const int depth = random.between(MAX_NESTING / 3, MAX_NESTING);
+                for (int level = 0; level < depth; ++level) {
+                    out += "<if_stmt><if>if <condition>(<expr>";
+                    name(out);
+                    out += "</expr>)</condition> <block>{<block_content>\n";
+                }
+                out += "<break>break;</break>\n";
+                for (int level = 0; level < depth; ++level)
+                    out += "</block_content>}</block></if></if_stmt>\n";
+                line += 2 * depth;
+                break;
+            }
+            case COMMENT_CONTENT: {
+                // long block comment
+                out += "<comment type=\"block\">/*\n";
+                const int lines = random.between(5, 30);
+                for (int i = 0; i < lines; ++i) {
+                    out += "     * ";
+                    words(out, random.between(6, 14));
+                    out += '\n';
+                }
+                out += "     */</comment>\n";
+                line += lines + 1;
+                break;
+            }
+            case ATTRIBUTE_CONTENT:
+                // declaration with positions on every element
+                out += "<decl_stmt><decl><type><name";
+                position(out, 4, 3);
+                out += ">int</name></type> <name";
+                position(out, 8, random.between(1, 8));
+                out += ">";
+                out += NAMES[random.below(std::size(NAMES))];
+                out += "</name> <init>= <expr><literal type=\"number\" role=\"initializer\"";
+                position(out, 16, 2);
+                out += ">";
+                number(out, random.below(100000));
+                out += "</literal></expr></init></decl>;</decl_stmt>\n";
+                break;
+            case CDATA_CONTENT:
+                // raw string in a CDATA section
+                out += "<expr_stmt><expr><literal type=\"string\"><![CDATA[R\"(<";
+                words(out, random.between(8, 24));
+                out += "> & \"";
+                words(out, random.between(4, 12));
+                out += "\")\"]]></literal></expr>;</expr_stmt>\n";
+                break;
+            case ENTITY_CONTENT:
+                // comparisons and logical operators, all entity references
+                out += "<expr_stmt><expr>";
+                name(out);
+                for (int terms = random.between(4, 12); terms > 0; --terms) {
+                    out += " <operator>";
+                    out += OPERATORS[random.between(7, 9)];
+                    out += "</operator> ";
+                    name(out);
+                }
+                out += "</expr>;</expr_stmt>\n";
+                break;
+            }
+            ++line;
+        }
+
+        /*
+            Append a name element of a random identifier
+
+            @param[in, out] out Archive
+        */
+        void name(std::string& out) {
+
+            out += "<name>";
+            out += NAMES[random.below(std::size(NAMES))];
+            out += "</name>";
+        }
+
+        /*
+            Append random words separated by spaces
+
+            @param[in, out] out Archive
+            @param[in] count Number of words
+        */
+        void words(std::string& out, int count) {
+
+            for (int i = 0; i < count; ++i) {
+                if (i)
+                    out += ' ';
+                out += WORDS[random.below(std::size(WORDS))];
+            }
+        }
+
+        /*
+            Append position attributes
+
+            @param[in, out] out Archive
+            @param[in] column Start column
+            @param[in] length Length of the element
+        */
+        void position(std::string& out, int column, int length) {
+
+            out += " pos:start=\"";
+            number(out, line);
+            out += ':';
+            number(out, column);
+            out += "\" pos:end=\"";
+            number(out, line);
+            out += ':';
+            number(out, column + length - 1);
+            out += '"';
+        }
+
+        /*
+            Append a number in decimal
+
+            @param[in, out] out Archive
+            @param[in] value Number
+        */
+        static void number(std::string& out, long value) {
+
+            char digits[24];
+            const auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+            out.append(digits, result.ptr);
+        }
+
+        const SyntheticMix& mix;
+        Random random;
+        const int totalWeight;
+        long unitNumber = 1;
+        long functionNumber = 1;
+        long line = 1;
+    };
+
+    /*
+        @param[in] random Random numbers
+        @return Approximate size of the next unit
+    */
+    long unitSize(Random& random) {
+
+        return random.between(2000, 40000);
+    }
+
+    /*
+        Generate the archive a unit at a time
+
+        @param[in] mix Mix of the content
+        @param[in] size Approximate size of the archive in bytes
+        @param[in] seed Seed of the content
+        @param[in, out] out Archive so far
+        @param[in] output Called with the archive so far, which it may clear
+    */
+    template <class Output>
+    void generate(const SyntheticMix& mix, long size, std::uint64_t seed, std::string& out, Output output) {
+
+        Generator generator(mix, seed);
+        Random sizes(~seed);
+        long total = 0;
+        out += ROOT_START;
+        out += " url=\"synthetic-";
+        out += mix.name;
+        out += "\">\n\n";
+        while (total + static_cast<long>(out.size()) < size) {
+            generator.unit(out, std::min(unitSize(sizes), size - total - static_cast<long>(out.size())));
+            total += out.size();
+            output(out);
+            total -= out.size();
+        }
+        out += "</unit>\n";
+        output(out);
+    }
+}
+
+/*
+    Predefined mixes: for each kind of content, a mix that is mostly that
+    kind, and a mix of all kinds
+
+    @return Predefined mixes
+*/
+std::vector<SyntheticMix> syntheticMixes() {
+
+    std::vector<SyntheticMix> mixes;
+    for (int kind = 0; kind < SYNTHETIC_CONTENT_COUNT; ++kind) {
+        SyntheticMix mix;
+        mix.name = SYNTHETIC_CONTENT_NAMES[kind];
+        std::fill(std::begin(mix.weights), std::end(mix.weights), 1);
+        mix.weights[kind] = 24;
+        mixes.push_back(mix);
+    }
+    SyntheticMix mixed;
+    mixed.name = "mixed";
+    std::fill(std::begin(mixed.weights), std::end(mixed.weights), 1);
+    mixes.push_back(mixed);
+
+    return mixes;
+}
+
+/*
+    Parse a mix, either the name of a predefined mix, e.g., "cdata", or the
+    weights of the kinds of content, e.g., "text:3,entities:1"
+
+    @param[in] specification Mix specification
+    @param[out] mix Mix
+    @return Whether the specification is valid
+*/
+bool parseSyntheticMix(std::string_view specification, SyntheticMix& mix) {
+
+    for (const auto& predefined : syntheticMixes()) {
+        if (predefined.name == specification) {
+            mix = predefined;
+            return true;
+        }
+    }
+
+    mix = SyntheticMix{};
+    mix.name = specification;
+    while (!specification.empty()) {
+        const std::string_view item = specification.substr(0, specification.find(','));
+        specification.remove_prefix(std::min(item.size() + 1, specification.size()));
+        const std::size_t colon = item.find(':');
+        if (colon == item.npos)
+            return false;
+        const std::string_view kindName = item.substr(0, colon);
+        const auto kind = std::find(std::begin(SYNTHETIC_CONTENT_NAMES), std::end(SYNTHETIC_CONTENT_NAMES), kindName);
+        if (kind == std::end(SYNTHETIC_CONTENT_NAMES))
+            return false;
+        int weight = 0;
+        const std::string_view weightText = item.substr(colon + 1);
+        const auto result = std::from_chars(weightText.data(), weightText.data() + weightText.size(), weight);
+        if (result.ec != std::errc{} || result.ptr != weightText.data() + weightText.size() || weight < 0)
+            return false;
+        mix.weights[kind - std::begin(SYNTHETIC_CONTENT_NAMES)] = weight;
+    }
+
+    return std::accumulate(std::begin(mix.weights), std::end(mix.weights), 0) > 0;
+}
+
+/*
+    Generate an archive in memory
+
+    @param[in] mix Mix of the content
+    @param[in] size Approximate size of the archive in bytes
+    @param[in] seed Seed of the content
+    @return Archive
+*/
+std::string syntheticArchive(const SyntheticMix& mix, long size, std::uint64_t seed) {
+
+    std::string archive;
+    archive.reserve(size + size / 16);
+    generate(mix, size, seed, archive, [](std::string&) {});
+
+    return archive;
+}
+
+/*
+    Write an archive a unit at a time, e.g., larger than memory
+
+    @param[in, out] out Output stream
+    @param[in] mix Mix of the content
+    @param[in] size Approximate size of the archive in bytes
+    @param[in] seed Seed of the content
+    @return Whether the archive was written
+*/
+bool writeSyntheticArchive(std::ostream& out, const SyntheticMix& mix, long size, std::uint64_t seed) {
+
+    std::string buffer;
+    generate(mix, size, seed, buffer, [&out](std::string& units) {
+        out.write(units.data(), units.size());
+        units.clear();
+    });
+
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,79 @@
+/*
+    syntheticArchive.hpp
+
+    Deterministic synthetic srcML archives for benchmarks, of any size and
+    with a configurable mix of content. The same mix, size, and seed always
+    produce the same archive, on any platform.
+
+    Each child unit is a C++ file of functions whose statements are
+    fragments of seven kinds of content, chosen at random in proportion to
+    the weights of the mix: text-heavy string literals, tag-heavy
+    expressions, deeply nested blocks, long block comments, elements with
+    many attributes, CDATA sections, and entity references.
+*/
+
+#ifndef INCLUDED_SYNTHETICARCHIVE_HPP
+#define INCLUDED_SYNTHETICARCHIVE_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// kinds of content
+enum SyntheticContent { TEXT_CONTENT, TAG_CONTENT, NESTING_CONTENT, COMMENT_CONTENT, ATTRIBUTE_CONTENT, CDATA_CONTENT, ENTITY_CONTENT };
+
+inline constexpr int SYNTHETIC_CONTENT_COUNT = 7;
+
+// names of the kinds of content in a mix specification
+inline constexpr std::string_view SYNTHETIC_CONTENT_NAMES[SYNTHETIC_CONTENT_COUNT] = {
+    "text", "tags", "nesting", "comments", "attributes", "cdata", "entities"
+};
+
+// relative weights of the kinds of content
+struct SyntheticMix {
+    std::string name;
+    int weights[SYNTHETIC_CONTENT_COUNT] = {};
+};
+
+/*
+    Predefined mixes: for each kind of content, a mix that is mostly that
+    kind, and a mix of all kinds
+
+    @return Predefined mixes
+*/
+[[nodiscard]] std::vector<SyntheticMix> syntheticMixes();
+
+/*
+    Parse a mix, either the name of a predefined mix, e.g., "cdata", or the
+    weights of the kinds of content, e.g., "text:3,entities:1"
+
+    @param[in] specification Mix specification
+    @param[out] mix Mix
+    @return Whether the specification is valid
+*/
+[[nodiscard]] bool parseSyntheticMix(std::string_view specification, SyntheticMix& mix);
+
+/*
+    Generate an archive in memory
+
+    @param[in] mix Mix of the content
+    @param[in] size Approximate size of the archive in bytes
+    @param[in] seed Seed of the content
+    @return Archive
+*/
+[[nodiscard]] std::string syntheticArchive(const SyntheticMix& mix, long size, std::uint64_t seed);
+
+/*
+    Write an archive a unit at a time, e.g., larger than memory
+
+    @param[in, out] out Output stream
+    @param[in] mix Mix of the content
+    @param[in] size Approximate size of the archive in bytes
+    @param[in] seed Seed of the content
+    @return Whether the archive was written
+*/
+[[nodiscard]] bool writeSyntheticArchive(std::ostream& out, const SyntheticMix& mix, long size, std::uint64_t seed);
+
+#endif
@@ -0,0 +1,47 @@
+# @file checkpointResume.cmake
+#
+# A run that is interrupted after a checkpoint, and then resumed from it,
+# has the same report as a complete run. A pipe cannot be checkpointed,
+# since a checkpoint is checked against the identity of the input file.
+#
+# Usage: cmake -DSRCFACTS=program -DINPUT=file.xml -DWORK_DIR=dir -P checkpointResume.cmake
+
+set(CHECKPOINT ${WORK_DIR}/checkpoint_resume.checkpoint)
+file(REMOVE ${CHECKPOINT})
+# checkpoints after the first child unit past each 1 KB of input
+set(OPTIONS --checkpoint=${CHECKPOINT} --checkpoint-interval=1024)
+
+execute_process(COMMAND ${SRCFACTS} INPUT_FILE ${INPUT}
+                RESULT_VARIABLE STATUS OUTPUT_VARIABLE EXPECTED ERROR_VARIABLE ERRORS)
+if(NOT STATUS EQUAL 0)
+    message(FATAL_ERROR "srcfacts failed: ${ERRORS}")
+endif()
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E env SRCFACTS_INTERRUPT_AFTER_CHECKPOINT=1 ${SRCFACTS} ${OPTIONS}
+                INPUT_FILE ${INPUT} RESULT_VARIABLE STATUS OUTPUT_QUIET ERROR_QUIET)
+if(STATUS EQUAL 0 OR NOT EXISTS ${CHECKPOINT})
+    message(FATAL_ERROR "srcfacts did not leave a checkpoint when interrupted")
+endif()
+
+execute_process(COMMAND ${SRCFACTS} ${OPTIONS} --resume INPUT_FILE ${INPUT}
+                RESULT_VARIABLE STATUS OUTPUT_VARIABLE ACTUAL ERROR_VARIABLE ERRORS)
+if(NOT STATUS EQUAL 0)
+    message(FATAL_ERROR "srcfacts --resume failed: ${ERRORS}")
+endif()
+if(NOT ERRORS MATCHES "Resumed at byte [1-9]")
+    message(FATAL_ERROR "srcfacts --resume did not resume from the checkpoint: ${ERRORS}")
+endif()
+if(NOT EXPECTED STREQUAL ACTUAL)
+    message(FATAL_ERROR "srcfacts --resume report differs:\n${EXPECTED}\nvs\n${ACTUAL}")
+endif()
+if(EXISTS ${CHECKPOINT})
+    message(FATAL_ERROR "srcfacts --resume did not remove the checkpoint of the complete run")
+endif()
+
+# a pipe
+execute_process(COMMAND ${CMAKE_COMMAND} -E cat ${INPUT}
+                COMMAND ${SRCFACTS} ${OPTIONS} --resume
+                RESULT_VARIABLE STATUS OUTPUT_QUIET ERROR_VARIABLE ERRORS)
+if(STATUS EQUAL 0 OR NOT ERRORS MATCHES "requires a regular file")
+    message(FATAL_ERROR "srcfacts --resume of a pipe is not an error: ${ERRORS}")
+endif()
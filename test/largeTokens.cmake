@@ -0,0 +1,42 @@
+# @file largeTokens.cmake
+#
+# A start tag or comment that fits in the input buffer is parsed, even
+# across a refill, and one larger than the buffer is an explicit error,
+# not an early end of the input.
+#
+# Usage: cmake -DSRCFACTS=program -DWORK_DIR=dir -P largeTokens.cmake
+
+set(ROOT "<unit xmlns=\"http://www.srcML.org/srcML/src\">")
+
+# name, size of the token content, and whether it fits in the 1 MB buffer
+set(CASES
+    "attribute|900000|1"
+    "attribute|1100000|0"
+    "comment|900000|1"
+    "comment|1100000|0"
+)
+foreach(CASE IN LISTS CASES)
+    string(REPLACE "|" ";" CASE ${CASE})
+    list(GET CASE 0 TOKEN)
+    list(GET CASE 1 SIZE)
+    list(GET CASE 2 FITS)
+    string(REPEAT "x" ${SIZE} TEXT)
+    # the text before the token ends the first block of the buffer within the token
+    string(REPEAT "y" 1000000 BEFORE)
+    if(TOKEN STREQUAL "attribute")
+        set(CONTENT "${ROOT}${BEFORE}<unit a=\"${TEXT}\"/></unit>\n")
+    else()
+        set(CONTENT "${ROOT}${BEFORE}<!--${TEXT}--></unit>\n")
+    endif()
+    set(INPUT ${WORK_DIR}/large_${TOKEN}_${SIZE}.xml)
+    file(WRITE ${INPUT} "${CONTENT}")
+
+    execute_process(COMMAND ${SRCFACTS} INPUT_FILE ${INPUT}
+                    RESULT_VARIABLE STATUS OUTPUT_QUIET ERROR_VARIABLE ERRORS)
+    if(FITS AND NOT STATUS EQUAL 0)
+        message(FATAL_ERROR "srcfacts failed on a ${TOKEN} of ${SIZE} bytes: ${ERRORS}")
+    endif()
+    if(NOT FITS AND NOT ERRORS MATCHES "Token larger than the input buffer")
+        message(FATAL_ERROR "srcfacts error for a ${TOKEN} of ${SIZE} bytes is not for a large token: ${ERRORS}")
+    endif()
+endforeach()
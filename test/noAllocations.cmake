@@ -0,0 +1,18 @@
+# @file noAllocations.cmake
+#
+# The parse of a srcML file for the default facts makes no heap
+# allocations once the collector is set up, and the report is the same
+# as from a regular run.
+#
+# Usage: cmake -DSRCFACTS=program -DINPUT=file.xml -P noAllocations.cmake
+
+execute_process(COMMAND ${SRCFACTS} INPUT_FILE ${INPUT}
+                RESULT_VARIABLE EXPECTED_STATUS OUTPUT_VARIABLE EXPECTED ERROR_QUIET)
+execute_process(COMMAND ${SRCFACTS} --check-allocations INPUT_FILE ${INPUT}
+                RESULT_VARIABLE ACTUAL_STATUS OUTPUT_VARIABLE ACTUAL ERROR_VARIABLE ERRORS)
+if(NOT EXPECTED_STATUS EQUAL 0 OR NOT ACTUAL_STATUS EQUAL 0)
+    message(FATAL_ERROR "srcfacts --check-allocations failed: ${ERRORS}")
+endif()
+if(NOT EXPECTED STREQUAL ACTUAL)
+    message(FATAL_ERROR "srcfacts --check-allocations report differs\nExpected:\n${EXPECTED}\nActual:\n${ACTUAL}")
+endif()
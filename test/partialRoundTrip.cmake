@@ -0,0 +1,34 @@
+# @file partialRoundTrip.cmake
+#
+# Round trip of the results of a run through a partial results file. The
+# merge of the partial results must produce the same report as the run.
+#
+# Usage: cmake -DSRCFACTS=program -DINPUT=file.xml -DWORK_DIR=dir -P partialRoundTrip.cmake
+
+get_filename_component(NAME ${INPUT} NAME_WE)
+set(PARTIAL ${WORK_DIR}/${NAME}.partial)
+
+# option sets, with options separated by '|'
+set(OPTION_SETS
+    ""
+    "--function-metrics"
+    "--query=//function|--query=/unit/unit[@language=\"Java\"]|--function-metrics"
+    "--language=Java|--exclude=**/*.cpp"
+)
+foreach(OPTION_SET IN LISTS OPTION_SETS)
+    string(REPLACE "|" ";" OPTIONS "${OPTION_SET}")
+    file(REMOVE ${PARTIAL})
+    execute_process(COMMAND ${SRCFACTS} ${OPTIONS} --write-partial=${PARTIAL} INPUT_FILE ${INPUT}
+                    RESULT_VARIABLE EXPECTED_STATUS OUTPUT_VARIABLE EXPECTED ERROR_VARIABLE ERRORS)
+    if(NOT EXPECTED_STATUS EQUAL 0 OR NOT EXISTS ${PARTIAL})
+        message(FATAL_ERROR "srcfacts ${OPTION_SET} --write-partial failed: ${ERRORS}")
+    endif()
+    execute_process(COMMAND ${SRCFACTS} merge ${PARTIAL}
+                    RESULT_VARIABLE ACTUAL_STATUS OUTPUT_VARIABLE ACTUAL ERROR_VARIABLE ERRORS)
+    if(NOT ACTUAL_STATUS EQUAL 0)
+        message(FATAL_ERROR "srcfacts merge failed: ${ERRORS}")
+    endif()
+    if(NOT EXPECTED STREQUAL ACTUAL)
+        message(FATAL_ERROR "srcfacts ${OPTION_SET} report differs for the merged partial results\nExpected:\n${EXPECTED}\nActual:\n${ACTUAL}")
+    endif()
+endforeach()
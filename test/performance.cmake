@@ -0,0 +1,110 @@
+# @file performance.cmake
+#
+# Performance regression test on a synthetic archive. The report must be
+# the same as the golden report, and the median throughput of the runs
+# must not drop more than the tolerance below the baseline of this
+# machine. The throughput is from the time that srcfacts reports, so it
+# does not include the startup of the process. The first run on a machine,
+# or a run with the environment variable SRCFACTS_UPDATE_BASELINE set,
+# records the throughput as the baseline instead.
+#
+# The baseline file has a line for each mix with its throughput in MB/sec.
+#
+# Usage: cmake -DSRCFACTS=program -DSRCFACTS_BENCH=program -DMIX=mix -DGOLDEN=file.md -DBASELINE=file
+#              -DTOLERANCE=percent -DWORK_DIR=dir -P performance.cmake
+
+# the golden reports are of archives of this size
+set(SIZE 16M)
+set(REPEAT 5)
+
+set(INPUT ${WORK_DIR}/performance_${MIX}.xml)
+if(NOT EXISTS ${INPUT})
+    execute_process(COMMAND ${SRCFACTS_BENCH} --output=${INPUT} --mix=${MIX} --size=${SIZE}
+                    RESULT_VARIABLE STATUS ERROR_VARIABLE ERRORS)
+    if(NOT STATUS EQUAL 0)
+        file(REMOVE ${INPUT})
+        message(FATAL_ERROR "srcfacts_bench --output of mix ${MIX} failed: ${ERRORS}")
+    endif()
+endif()
+file(SIZE ${INPUT} INPUT_BYTES)
+file(READ ${GOLDEN} EXPECTED)
+
+# Microseconds of the "sec" line of srcfacts, the time of the parse without the startup of the
+# process, in the C locale. CMake only has integer arithmetic, so the shortest form of the seconds,
+# e.g., 0.0123 or 1.23e-05, is scaled by powers of ten.
+function(parse_microseconds ERRORS RESULT)
+    if(NOT ERRORS MATCHES "\n([0-9]+)(\\.([0-9]+))?(e([-+][0-9]+))? sec\n")
+        message(FATAL_ERROR "srcfacts on mix ${MIX} has no time:\n${ERRORS}")
+    endif()
+    set(DIGITS "${CMAKE_MATCH_1}${CMAKE_MATCH_3}")
+    string(LENGTH "${CMAKE_MATCH_3}" FRACTION_LENGTH)
+    set(EXPONENT 0)
+    if(CMAKE_MATCH_5)
+        string(REGEX REPLACE "^\\+?(-?)0*([0-9]+)$" "\\1\\2" EXPONENT ${CMAKE_MATCH_5})
+    endif()
+    string(REGEX REPLACE "^0*([0-9]+)$" "\\1" VALUE ${DIGITS})
+    math(EXPR SCALE "${EXPONENT} + 6 - ${FRACTION_LENGTH}")
+    while(SCALE GREATER 0)
+        math(EXPR VALUE "${VALUE} * 10")
+        math(EXPR SCALE "${SCALE} - 1")
+    endwhile()
+    while(SCALE LESS 0)
+        math(EXPR VALUE "${VALUE} / 10")
+        math(EXPR SCALE "${SCALE} + 1")
+    endwhile()
+    if(VALUE EQUAL 0)
+        set(VALUE 1)
+    endif()
+    set(${RESULT} ${VALUE} PARENT_SCOPE)
+endfunction()
+
+# the report and time are in the C locale, so they have no digit grouping
+set(MICROSECONDS)
+foreach(RUN RANGE 1 ${REPEAT})
+    execute_process(COMMAND ${CMAKE_COMMAND} -E env LC_ALL=C ${SRCFACTS} INPUT_FILE ${INPUT}
+                    RESULT_VARIABLE STATUS OUTPUT_VARIABLE ACTUAL ERROR_VARIABLE ERRORS)
+    if(NOT STATUS EQUAL 0)
+        message(FATAL_ERROR "srcfacts on mix ${MIX} failed: ${ERRORS}")
+    endif()
+    if(NOT EXPECTED STREQUAL ACTUAL)
+        message(FATAL_ERROR "srcfacts report for mix ${MIX} differs from ${GOLDEN}\nExpected:\n${EXPECTED}\nActual:\n${ACTUAL}")
+    endif()
+    parse_microseconds("${ERRORS}" RUN_MICROSECONDS)
+    list(APPEND MICROSECONDS ${RUN_MICROSECONDS})
+endforeach()
+
+# median throughput in tenths of MB/sec, since CMake only has integer arithmetic
+list(SORT MICROSECONDS COMPARE NATURAL)
+math(EXPR MEDIAN_INDEX "${REPEAT} / 2")
+list(GET MICROSECONDS ${MEDIAN_INDEX} MEDIAN_MICROSECONDS)
+math(EXPR THROUGHPUT "${INPUT_BYTES} * 10 / ${MEDIAN_MICROSECONDS}")
+math(EXPR THROUGHPUT_WHOLE "${THROUGHPUT} / 10")
+math(EXPR THROUGHPUT_TENTHS "${THROUGHPUT} % 10")
+set(THROUGHPUT_TEXT "${THROUGHPUT_WHOLE}.${THROUGHPUT_TENTHS}")
+
+set(BASELINE_LINES)
+if(EXISTS ${BASELINE})
+    file(STRINGS ${BASELINE} BASELINE_LINES)
+endif()
+set(BASELINE_TEXT)
+foreach(LINE IN LISTS BASELINE_LINES)
+    if(LINE MATCHES "^${MIX} ([0-9]+\\.[0-9])$")
+        set(BASELINE_TEXT ${CMAKE_MATCH_1})
+    endif()
+endforeach()
+
+if(NOT BASELINE_TEXT OR DEFINED ENV{SRCFACTS_UPDATE_BASELINE})
+    list(FILTER BASELINE_LINES EXCLUDE REGEX "^${MIX} ")
+    list(APPEND BASELINE_LINES "${MIX} ${THROUGHPUT_TEXT}")
+    list(JOIN BASELINE_LINES "\n" BASELINE_CONTENTS)
+    file(WRITE ${BASELINE} "${BASELINE_CONTENTS}\n")
+    message(STATUS "Baseline of mix ${MIX} is ${THROUGHPUT_TEXT} MB/sec in ${BASELINE}")
+    return()
+endif()
+
+string(REPLACE "." "" BASELINE_THROUGHPUT ${BASELINE_TEXT})
+math(EXPR MINIMUM_THROUGHPUT "${BASELINE_THROUGHPUT} * (100 - ${TOLERANCE}) / 100")
+if(THROUGHPUT LESS MINIMUM_THROUGHPUT)
+    message(FATAL_ERROR "Throughput of mix ${MIX} is ${THROUGHPUT_TEXT} MB/sec, more than ${TOLERANCE}% below the baseline of ${BASELINE_TEXT} MB/sec in ${BASELINE}")
+endif()
+message(STATUS "Throughput of mix ${MIX} is ${THROUGHPUT_TEXT} MB/sec, baseline ${BASELINE_TEXT} MB/sec")
@@ -0,0 +1,37 @@
+# @file queryCounts.cmake
+#
+# The counts of path queries on the demo input are the counts of the
+# elements in it, including prefixed steps, which only match elements
+# with that prefix.
+#
+# Usage: cmake -DSRCFACTS=program -DINPUT=demo.xml -P queryCounts.cmake
+
+# query and its count in the demo input, separated by '|'
+set(QUERY_COUNTS
+    "//cpp:include|16"
+    "//include|16"
+    "//src:include|0"
+    "//cpp:define|9"
+    "//function|2"
+)
+
+set(ARGUMENTS)
+foreach(QUERY_COUNT IN LISTS QUERY_COUNTS)
+    string(REPLACE "|" ";" QUERY_COUNT ${QUERY_COUNT})
+    list(GET QUERY_COUNT 0 QUERY)
+    list(APPEND ARGUMENTS --query=${QUERY})
+endforeach()
+execute_process(COMMAND ${SRCFACTS} ${ARGUMENTS} INPUT_FILE ${INPUT}
+                RESULT_VARIABLE STATUS OUTPUT_VARIABLE REPORT ERROR_VARIABLE ERRORS)
+if(NOT STATUS EQUAL 0)
+    message(FATAL_ERROR "srcfacts failed: ${ERRORS}")
+endif()
+
+foreach(QUERY_COUNT IN LISTS QUERY_COUNTS)
+    string(REPLACE "|" ";" QUERY_COUNT ${QUERY_COUNT})
+    list(GET QUERY_COUNT 0 QUERY)
+    list(GET QUERY_COUNT 1 COUNT)
+    if(NOT REPORT MATCHES "\\| `${QUERY}` +\\| +${COUNT} \\|")
+        message(FATAL_ERROR "srcfacts count of ${QUERY} is not ${COUNT}:\n${REPORT}")
+    endif()
+endforeach()
@@ -0,0 +1,33 @@
+# @file skipIncomplete.cmake
+#
+# A truncated child unit that is skipped, here as a cached unit, is an
+# error that names the skipped element, even when the skip refills the
+# input buffer, e.g., for a start tag longer than the buffer.
+#
+# Usage: cmake -DSRCFACTS=program -DWORK_DIR=dir -P skipIncomplete.cmake
+
+set(CACHE_FILE ${WORK_DIR}/skip_incomplete.cache)
+file(REMOVE ${CACHE_FILE})
+
+# cache the facts of the complete unit
+set(COMPLETE ${WORK_DIR}/skip_complete.xml)
+file(WRITE ${COMPLETE} "<unit xmlns=\"http://www.srcML.org/srcML/src\">\n<unit hash=\"1234\" filename=\"skipped.c\"><name>x</name></unit>\n</unit>\n")
+execute_process(COMMAND ${SRCFACTS} --cache=${CACHE_FILE} INPUT_FILE ${COMPLETE}
+                RESULT_VARIABLE STATUS OUTPUT_QUIET ERROR_QUIET)
+if(NOT STATUS EQUAL 0)
+    message(FATAL_ERROR "srcfacts failed to cache the complete unit")
+endif()
+
+# the same unit with an attribute value longer than the input buffer, and no end tags
+string(REPEAT "x" 2000000 VALUE)
+set(INPUT ${WORK_DIR}/skip_incomplete.xml)
+file(WRITE ${INPUT} "<unit xmlns=\"http://www.srcML.org/srcML/src\">\n<unit hash=\"1234\" filename=\"skipped.c\"><name a=\"${VALUE}\">x")
+
+execute_process(COMMAND ${SRCFACTS} --cache=${CACHE_FILE} INPUT_FILE ${INPUT}
+                RESULT_VARIABLE STATUS OUTPUT_QUIET ERROR_VARIABLE ERRORS)
+if(STATUS EQUAL 0)
+    message(FATAL_ERROR "srcfacts succeeded on a truncated skipped unit")
+endif()
+if(NOT ERRORS MATCHES "Incomplete element 'unit'")
+    message(FATAL_ERROR "srcfacts error for a truncated skipped unit does not name the unit: ${ERRORS}")
+endif()
@@ -0,0 +1,43 @@
+# @file tokenRoundTrip.cmake
+#
+# Round trip of a srcML file through a compiled token stream. The report
+# from the token stream must be the same as the report from the srcML file
+# for each set of options, including with a cache, where cached units are
+# skipped in the token stream.
+#
+# Usage: cmake -DSRCFACTS=program -DINPUT=file.xml -DWORK_DIR=dir -P tokenRoundTrip.cmake
+
+get_filename_component(NAME ${INPUT} NAME_WE)
+set(TOKENS ${WORK_DIR}/${NAME}.tokens)
+set(CACHE_FILE ${WORK_DIR}/${NAME}.tokens.cache)
+file(REMOVE ${CACHE_FILE})
+
+execute_process(COMMAND ${SRCFACTS} compile ${INPUT} ${TOKENS}
+                RESULT_VARIABLE STATUS ERROR_VARIABLE ERRORS)
+if(NOT STATUS EQUAL 0)
+    message(FATAL_ERROR "compile of ${INPUT} failed: ${ERRORS}")
+endif()
+
+# option sets, with options separated by '|'
+set(OPTION_SETS
+    ""
+    "--function-metrics|--query=//function|--query=/unit/unit[@language=\"Java\"]|--query=//cpp:include|--identifiers=15"
+    "--approx=10|--topk-counters=50|--hll-precision=10|--capture=//call/name"
+    "--identifiers|--capture=//decl/type"
+    "--language=Java|--exclude=**/*.cpp"
+    "--cache=${CACHE_FILE}"
+    "--cache=${CACHE_FILE}"
+)
+foreach(OPTION_SET IN LISTS OPTION_SETS)
+    string(REPLACE "|" ";" OPTIONS "${OPTION_SET}")
+    execute_process(COMMAND ${SRCFACTS} ${OPTIONS} INPUT_FILE ${INPUT}
+                    RESULT_VARIABLE EXPECTED_STATUS OUTPUT_VARIABLE EXPECTED ERROR_QUIET)
+    execute_process(COMMAND ${SRCFACTS} ${OPTIONS} INPUT_FILE ${TOKENS}
+                    RESULT_VARIABLE ACTUAL_STATUS OUTPUT_VARIABLE ACTUAL ERROR_VARIABLE ERRORS)
+    if(NOT EXPECTED_STATUS EQUAL 0 OR NOT ACTUAL_STATUS EQUAL 0)
+        message(FATAL_ERROR "srcfacts ${OPTION_SET} failed: ${ERRORS}")
+    endif()
+    if(NOT EXPECTED STREQUAL ACTUAL)
+        message(FATAL_ERROR "srcfacts ${OPTION_SET} report differs for the token stream\nExpected:\n${EXPECTED}\nActual:\n${ACTUAL}")
+    endif()
+endforeach()
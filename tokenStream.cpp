@@ -0,0 +1,421 @@
+/*
+    tokenStream.cpp
+
+    Compiled srcML: a compact binary stream of the parse events.
+*/
+
+#include "tokenStream.hpp"
+#include "factsCollector.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    constexpr auto MAGIC = "SRCFACTS-TOKENS\n"sv;
+    const std::uint64_t VERSION = 1;
+
+    // size of the output buffer before it is written
+    const std::size_t BUFFER_LIMIT = 1024 * 1024;
+
+    // tokens, each followed by its varint fields
+    enum Token : char {
+        // newlines, length, characters
+        TEXT = 1,
+        // element name number, attribute count, name and value number of each attribute
+        START,
+        EMPTY,
+        END,
+        // length, characters of the next string number
+        DEFINE,
+        // size of the srcML document
+        FINISH,
+    };
+
+    /*
+        Append an unsigned LEB128 varint
+
+        @param[in, out] out Output
+        @param[in] value Value to append
+    */
+    void appendVarint(std::string& out, std::uint64_t value) {
+
+        while (value >= 0x80) {
+            out += static_cast<char>(value | 0x80);
+            value >>= 7;
+        }
+        out += static_cast<char>(value);
+    }
+
+    /*
+        Read an unsigned LEB128 varint
+
+        @param[in, out] position Position in the token stream
+        @param[in] end End of the token stream
+        @param[out] value Value read
+        @return Whether the value was read
+    */
+    inline bool readVarint(const char*& position, const char* end, std::uint64_t& value) {
+
+        value = 0;
+        for (int shift = 0; position < end && shift < 64; shift += 7) {
+            const auto byte = static_cast<unsigned char>(*position++);
+            value |= std::uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+
+        return false;
+    }
+
+    /*
+        Read a string, a varint length and the characters
+
+        @param[in, out] position Position in the token stream
+        @param[in] end End of the token stream
+        @param[out] value String read
+        @return Whether the string was read
+    */
+    inline bool readString(const char*& position, const char* end, std::string_view& value) {
+
+        std::uint64_t length = 0;
+        if (!readVarint(position, end, length) || length > static_cast<std::uint64_t>(end - position))
+            return false;
+        value = std::string_view(position, length);
+        position += length;
+
+        return true;
+    }
+
+    /*
+        Skip the tokens of the content and end tag of the current element,
+        defining the strings on the way
+
+        @param[in, out] position Position in the token stream
+        @param[in] end End of the token stream
+        @param[in, out] strings Dictionary
+        @return Whether the end tag of the element was found
+    */
+    bool skipTokens(const char*& position, const char* end, std::vector<std::string_view>& strings) {
+
+        int depth = 1;
+        std::uint64_t value = 0;
+        std::string_view characters;
+        while (position < end) {
+            switch (*position++) {
+            case TEXT:
+                if (!readVarint(position, end, value) || !readString(position, end, characters))
+                    return false;
+                break;
+            case START:
+            case EMPTY: {
+                const bool empty = position[-1] == EMPTY;
+                std::uint64_t count = 0;
+                if (!readVarint(position, end, value) || !readVarint(position, end, count))
+                    return false;
+                for (std::uint64_t i = 0; i < 2 * count; ++i) {
+                    if (!readVarint(position, end, value))
+                        return false;
+                }
+                if (!empty)
+                    ++depth;
+                break;
+            }
+            case END:
+                if (--depth == 0)
+                    return true;
+                break;
+            case DEFINE:
+                if (!readString(position, end, characters))
+                    return false;
+                strings.push_back(characters);
+                break;
+            default:
+                return false;
+            }
+        }
+
+        return false;
+    }
+}
+
+/*
+    Create a token stream file
+
+    @param[in] path Filename
+    @return Whether the file was created
+*/
+bool TokenWriter::open(const std::string& path) {
+
+    out.open(path, std::ios::binary | std::ios::trunc);
+    buffer.reserve(BUFFER_LIMIT + BUFFER_LIMIT / 4);
+    buffer += MAGIC;
+    appendVarint(buffer, VERSION);
+
+    return static_cast<bool>(out);
+}
+
+/*
+    Start tag name, before any attributes
+
+    @param[in] depth Number of open ancestor elements
+    @param[in] prefix Element namespace prefix
+    @param[in] localName Element local name
+*/
+void TokenWriter::startElement(int /* depth */, std::string_view prefix, std::string_view localName) {
+
+    writeText();
+    qName.assign(prefix);
+    if (!prefix.empty())
+        qName += ':';
+    qName += localName;
+    elementNumber = stringNumber(qName);
+    attributes.clear();
+}
+
+/*
+    Attribute of the current start tag
+
+    @param[in] localName Attribute local name
+    @param[in] value Attribute value
+*/
+void TokenWriter::attribute(std::string_view localName, std::string_view value) {
+
+    const std::size_t nameNumber = stringNumber(localName);
+    attributes.emplace_back(nameNumber, stringNumber(value));
+}
+
+/*
+    End of the current start tag, '>'
+
+    @return Whether to skip the element, which is never
+*/
+bool TokenWriter::endStartTag() {
+
+    writeStartTag(START);
+
+    return false;
+}
+
+/*
+    End of the current start tag of an empty element, '/>'
+*/
+void TokenWriter::endEmptyElement() {
+
+    writeStartTag(EMPTY);
+}
+
+/*
+    End tag
+
+    @param[in] depth Number of open ancestor elements
+*/
+void TokenWriter::endElement(int /* depth */) {
+
+    writeText();
+    buffer += END;
+    flush();
+}
+
+/*
+    Write the end token and close the file
+
+    @param[in] totalBytes Size of the srcML document
+    @return Whether the file is complete
+*/
+bool TokenWriter::close(long totalBytes) {
+
+    writeText();
+    buffer += FINISH;
+    appendVarint(buffer, totalBytes);
+    flush(true);
+    out.close();
+
+    return static_cast<bool>(out);
+}
+
+/*
+    Number of a string in the dictionary, defining it if it is new
+
+    @param[in] value String
+    @return Number of the string
+*/
+std::size_t TokenWriter::stringNumber(std::string_view value) {
+
+    const auto [position, inserted] = dictionary.try_emplace(std::string(value), dictionary.size());
+    if (inserted) {
+        buffer += DEFINE;
+        appendVarint(buffer, value.size());
+        buffer += value;
+    }
+
+    return position->second;
+}
+
+/*
+    Write any pending character data as a text token
+*/
+void TokenWriter::writeText() {
+
+    if (text.empty())
+        return;
+    buffer += TEXT;
+    appendVarint(buffer, std::count(text.cbegin(), text.cend(), '\n'));
+    appendVarint(buffer, text.size());
+    buffer += text;
+    text.clear();
+}
+
+/*
+    Write the current start tag
+
+    @param[in] token Start or empty element token
+*/
+void TokenWriter::writeStartTag(char token) {
+
+    buffer += token;
+    appendVarint(buffer, elementNumber);
+    appendVarint(buffer, attributes.size());
+    for (const auto& [nameNumber, valueNumber] : attributes) {
+        appendVarint(buffer, nameNumber);
+        appendVarint(buffer, valueNumber);
+    }
+    flush();
+}
+
+/*
+    Write the buffer to the file when it is full, or when forced
+
+    @param[in] force Whether to write the buffer regardless of its size
+*/
+void TokenWriter::flush(bool force) {
+
+    if (!force && buffer.size() < BUFFER_LIMIT)
+        return;
+    out.write(buffer.data(), buffer.size());
+    bytesWritten += static_cast<long>(buffer.size());
+    buffer.clear();
+}
+
+/*
+    @param[in] data Contents of a file
+    @return Whether the file is a token stream
+*/
+bool isTokenStream(std::string_view data) {
+
+    return data.compare(0, MAGIC.size(), MAGIC) == 0;
+}
+
+/*
+    Pass the parse events of a token stream to a collector. Errors are
+    output to standard error.
+
+    @param[in] data Token stream
+    @param[in, out] collector Collector of the parse events
+    @param[out] totalBytes Size of the compiled srcML document
+    @return Status
+    @retval 0 Success
+    @retval -1 Invalid token stream
+*/
+int parseTokens(std::string_view data, FactsCollector& collector, long& totalBytes) {
+
+    const char* position = data.data() + MAGIC.size();
+    const char* const end = data.data() + data.size();
+    std::uint64_t value = 0;
+    if (!isTokenStream(data) || !readVarint(position, end, value) || value != VERSION) {
+        std::cerr << "srcfacts: Unsupported token stream version\n";
+        return -1;
+    }
+
+    // dictionary strings, and for element names the prefix, local name, and ID of the local name
+    struct ElementName {
+        std::string_view prefix;
+        std::string_view localName;
+        int id = -1;
+    };
+    std::vector<std::string_view> strings;
+    std::vector<ElementName> elementNames;
+    std::string_view characters;
+    int depth = 0;
+    while (position < end) {
+        const long offset = static_cast<long>(position - data.data());
+        switch (*position++) {
+        case TEXT: {
+            std::uint64_t newlines = 0;
+            if (!readVarint(position, end, newlines) || !readString(position, end, characters))
+                break;
+            collector.characters(characters, static_cast<long>(newlines));
+            continue;
+        }
+        case START:
+        case EMPTY: {
+            const bool empty = position[-1] == EMPTY;
+            std::uint64_t count = 0;
+            if (!readVarint(position, end, value) || value >= strings.size() || !readVarint(position, end, count))
+                break;
+            if (elementNames.size() < strings.size())
+                elementNames.resize(strings.size());
+            auto& name = elementNames[value];
+            if (name.id < 0) {
+                const std::string_view qName(strings[value]);
+                const std::size_t colonPosition = qName.find(':');
+                name.prefix = qName.substr(0, colonPosition == qName.npos ? 0 : colonPosition);
+                name.localName = qName.substr(colonPosition == qName.npos ? 0 : colonPosition + 1);
+                name.id = collector.elementIds.intern(name.localName);
+            }
+            collector.startElement(depth, name.prefix, name.localName, name.id);
+            if (depth == 1)
+                collector.childStart(offset);
+            std::uint64_t i = 0;
+            for (std::uint64_t nameNumber = 0; i < count; ++i) {
+                if (!readVarint(position, end, nameNumber) || nameNumber >= strings.size() ||
+                    !readVarint(position, end, value) || value >= strings.size())
+                    break;
+                collector.attribute(strings[nameNumber], strings[value]);
+            }
+            if (i < count)
+                break;
+            if (empty) {
+                collector.endEmptyElement();
+            } else if (collector.endStartTag()) {
+                const char* const skipStart = position;
+                if (!skipTokens(position, end, strings))
+                    break;
+                collector.skippedElement(static_cast<long>(position - skipStart));
+            } else {
+                ++depth;
+                continue;
+            }
+            if (depth == 1)
+                collector.childEnd(static_cast<long>(position - data.data()));
+            continue;
+        }
+        case END:
+            if (depth == 0)
+                break;
+            --depth;
+            collector.endElement(depth);
+            if (depth == 1)
+                collector.childEnd(static_cast<long>(position - data.data()));
+            continue;
+        case DEFINE:
+            if (!readString(position, end, characters))
+                break;
+            strings.push_back(characters);
+            continue;
+        case FINISH:
+            if (!readVarint(position, end, value) || position != end || depth != 0)
+                break;
+            totalBytes = static_cast<long>(value);
+            return 0;
+        }
+        std::cerr << "srcfacts: Invalid token stream at byte " << offset << '\n';
+        return -1;
+    }
+
+    std::cerr << "srcfacts: Incomplete token stream\n";
+    return -1;
+}
@@ -0,0 +1,172 @@
+/*
+    tokenStream.hpp
+
+    Compiled srcML: a compact binary stream of the parse events, so that
+    repeated analyses of the same srcML skip XML parsing. A TokenWriter
+    receives the parse events from the parser, and parseTokens() passes the
+    events in a token stream, e.g., a memory-mapped file, to a collector.
+
+    Integers are unsigned LEB128 varints. Element names and attribute
+    names and values are strings in a dictionary, defined by a token before
+    their first use and then referenced by their number. Adjacent
+    character data is a single text token with its number of newlines.
+*/
+
+#ifndef INCLUDED_TOKENSTREAM_HPP
+#define INCLUDED_TOKENSTREAM_HPP
+
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class FactsCollector;
+
+class TokenWriter {
+public:
+
+    /*
+        Create a token stream file
+
+        @param[in] path Filename
+        @return Whether the file was created
+    */
+    [[nodiscard]] bool open(const std::string& path);
+
+    /*
+        Character data, with entity references already converted
+
+        @param[in] characters Characters
+    */
+    void characters(std::string_view characters) {
+        text += characters;
+    }
+
+    /*
+        Start tag name, before any attributes
+
+        @param[in] depth Number of open ancestor elements
+        @param[in] prefix Element namespace prefix
+        @param[in] localName Element local name
+    */
+    void startElement(int depth, std::string_view prefix, std::string_view localName);
+
+    /*
+        Attribute of the current start tag
+
+        @param[in] localName Attribute local name
+        @param[in] value Attribute value
+    */
+    void attribute(std::string_view localName, std::string_view value);
+
+    /*
+        End of the current start tag, '>'
+
+        @return Whether to skip the element, which is never
+    */
+    [[nodiscard]] bool endStartTag();
+
+    /*
+        End of the current start tag of an empty element, '/>'
+    */
+    void endEmptyElement();
+
+    /*
+        Skipped element, which does not occur
+    */
+    void skippedElement(long) {}
+
+    /*
+        Start tag of a child of the root element, which has no token
+    */
+    void childStart(long) {}
+
+    /*
+        End of a child of the root element, which has no token
+    */
+    void childEnd(long) {}
+
+    /*
+        End tag
+
+        @param[in] depth Number of open ancestor elements
+    */
+    void endElement(int depth);
+
+    /*
+        Write the end token and close the file
+
+        @param[in] totalBytes Size of the srcML document
+        @return Whether the file is complete
+    */
+    [[nodiscard]] bool close(long totalBytes);
+
+    /*
+        @return Bytes written
+    */
+    [[nodiscard]] long size() const {
+        return bytesWritten;
+    }
+
+private:
+
+    /*
+        Number of a string in the dictionary, defining it if it is new
+
+        @param[in] value String
+        @return Number of the string
+    */
+    std::size_t stringNumber(std::string_view value);
+
+    /*
+        Write any pending character data as a text token
+    */
+    void writeText();
+
+    /*
+        Write the current start tag
+
+        @param[in] token Start or empty element token
+    */
+    void writeStartTag(char token);
+
+    /*
+        Write the buffer to the file when it is full, or when forced
+
+        @param[in] force Whether to write the buffer regardless of its size
+    */
+    void flush(bool force = false);
+
+    std::ofstream out;
+    std::string buffer;
+    long bytesWritten = 0;
+    std::unordered_map<std::string, std::size_t> dictionary;
+    std::string qName;
+    std::string text;
+    // current start tag
+    std::size_t elementNumber = 0;
+    std::vector<std::pair<std::size_t, std::size_t>> attributes;
+};
+
+/*
+    @param[in] data Contents of a file
+    @return Whether the file is a token stream
+*/
+[[nodiscard]] bool isTokenStream(std::string_view data);
+
+/*
+    Pass the parse events of a token stream to a collector. Errors are
+    output to standard error.
+
+    @param[in] data Token stream
+    @param[in, out] collector Collector of the parse events
+    @param[out] totalBytes Size of the compiled srcML document
+    @return Status
+    @retval 0 Success
+    @retval -1 Invalid token stream
+*/
+[[nodiscard]] int parseTokens(std::string_view data, FactsCollector& collector, long& totalBytes);
+
+#endif
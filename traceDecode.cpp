@@ -0,0 +1,217 @@
+/*
+    traceDecode.cpp
+
+    Decoder of a binary parse trace from srcfacts --trace. Outputs each
+    parse event on a separate line, with the text of the event from the
+    same srcML input that was traced.
+
+    Usage: srcfacts_trace TRACE_FILE < INPUT
+
+    The input is read through libarchive, so it can be compressed, as for
+    srcfacts.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include "refillContent.hpp"
+#include "parseTrace.hpp"
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    constexpr auto NAMEEND = "> /\":=\n\t\r"sv;
+
+    // input of the text of the events, which are in the order of the input
+    class EventText {
+    public:
+
+        /*
+            @param[in, out] input Input that was traced
+        */
+        explicit EventText(InputSource& input) : input(input) {}
+
+        /*
+            Text of an event from the input
+
+            @param[in] event Event
+            @param[out] text Text of the event
+            @return Whether the text is in the input
+        */
+        [[nodiscard]] bool text(const TraceEvent& event, std::string_view& text) {
+
+            const long offset = event.offset();
+            if (offset < start())
+                return false;
+            // discard the content before the text, then read until all of it is in the content
+            while (offset + static_cast<long>(event.length) > input.totalBytes()) {
+                content.remove_prefix(std::min(static_cast<long>(content.size()), offset - start()));
+                if (refillContent(input, content) <= 0)
+                    return false;
+            }
+            content.remove_prefix(offset - start());
+            text = content.substr(0, event.length);
+
+            return true;
+        }
+
+    private:
+
+        /*
+            @return Offset of the content in the input
+        */
+        [[nodiscard]] long start() const {
+            return input.totalBytes() - static_cast<long>(content.size());
+        }
+
+        InputSource& input;
+        std::string_view content;
+    };
+
+    /*
+        Output the header of an event
+
+        @param[in] type Type of event
+    */
+    void header(TraceEventType type) {
+
+        std::cout << "\033[1m" << std::setw(10) << std::left << TRACE_EVENT_HEADERS[type] << "\u001b[0m" << '\t';
+    }
+
+    /*
+        Output a labeled field of an event
+
+        @param[in] label Label of the field
+        @param[in] value Value of the field
+    */
+    void field(std::string_view label, std::string_view value) {
+
+        std::cout << "\033[1m" << label << "\u001b[0m" << "|" << "\u001b[31;1m" << value << "\u001b[0m" << "| ";
+    }
+
+    /*
+        Output the qName, prefix, and local name fields
+
+        @param[in] qName Qualified name
+        @param[in] qNameLabel Label of the qName
+    */
+    void nameFields(std::string_view qName, std::string_view qNameLabel = "qName"sv) {
+
+        const std::size_t colonPosition = qName.find(':');
+        field(qNameLabel, qName);
+        field("prefix"sv, colonPosition == qName.npos ? ""sv : qName.substr(0, colonPosition));
+        field("localName"sv, colonPosition == qName.npos ? qName : qName.substr(colonPosition + 1));
+    }
+
+    /*
+        @param[in] declaration XML declaration
+        @param[in] name Attribute name
+        @return Value of the attribute, or empty if not present
+    */
+    std::string_view declarationAttribute(std::string_view declaration, std::string_view name) {
+
+        const std::size_t namePosition = declaration.find(name);
+        if (namePosition == declaration.npos)
+            return ""sv;
+        const std::size_t valueStart = declaration.find_first_of("\"'"sv, namePosition);
+        if (valueStart == declaration.npos)
+            return ""sv;
+        const std::size_t valueEnd = declaration.find(declaration[valueStart], valueStart + 1);
+
+        return declaration.substr(valueStart + 1, valueEnd - valueStart - 1);
+    }
+
+    /*
+        @param[in] reference Character entity reference, or an unescaped '&'
+        @return Character of the reference
+    */
+    std::string_view unescape(std::string_view reference) {
+
+        if (reference == "&lt;"sv)
+            return "<"sv;
+        if (reference == "&gt;"sv)
+            return ">"sv;
+
+        return "&"sv;
+    }
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc != 2) {
+        std::cerr << "Usage: srcfacts_trace TRACE_FILE < INPUT\n";
+        return 1;
+    }
+    TraceReader trace;
+    if (!trace.open(argv[1])) {
+        std::cerr << "srcfacts_trace: Invalid trace file " << argv[1] << '\n';
+        return 1;
+    }
+    InputSource input;
+    if (!input.open())
+        return 1;
+    EventText eventText(input);
+
+    TraceEvent event;
+    while (trace.next(event)) {
+        const TraceEventType type = event.type();
+        if (type >= TRACE_EVENT_TYPES) {
+            std::cerr << "srcfacts_trace: Invalid event in trace file\n";
+            return 1;
+        }
+        std::string_view text;
+        if (!eventText.text(event, text)) {
+            std::cerr << "srcfacts_trace: Input is not the traced input\n";
+            return 1;
+        }
+        const std::string_view name = trace.name(event.name);
+        header(type);
+        switch (type) {
+        case XML_DECLARATION_EVENT:
+            field("version"sv, declarationAttribute(text, "version"sv));
+            field("encoding"sv, declarationAttribute(text, "encoding"sv));
+            field("standalone"sv, declarationAttribute(text, "standalone"sv));
+            break;
+        case DOCTYPE_EVENT:
+            field("contents"sv, text);
+            break;
+        case CHARACTERS_EVENT:
+            field("characters"sv, !text.empty() && text[0] == '&' ? unescape(text) : text);
+            break;
+        case COMMENT_EVENT:
+            field("content"sv, text);
+            break;
+        case CDATA_EVENT:
+            field("characters"sv, text);
+            break;
+        case PI_EVENT: {
+            const std::size_t nameEndPosition = std::min(text.find_first_of(NAMEEND), text.size());
+            field("target"sv, text.substr(0, nameEndPosition));
+            field("data"sv, text.substr(nameEndPosition));
+            break;
+        }
+        case START_TAG_EVENT:
+        case END_TAG_EVENT:
+        case SKIP_ELEMENT_EVENT:
+            nameFields(name);
+            break;
+        case NAMESPACE_EVENT:
+            field("prefix"sv, name);
+            field("uri"sv, text);
+            break;
+        case ATTRIBUTE_EVENT:
+            nameFields(name, "qname"sv);
+            field("value"sv, text);
+            break;
+        default:
+            break;
+        }
+        std::cout << '\n';
+    }
+
+    return 0;
+}
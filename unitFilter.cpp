@@ -0,0 +1,119 @@
+/*
+    unitFilter.cpp
+
+    Selection of the child units of a srcML archive by the filename and
+    language attributes of the unit start tag.
+*/
+
+#include "unitFilter.hpp"
+#include <algorithm>
+#include <cctype>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    /*
+        @param[in] lhs String
+        @param[in] rhs String
+        @return Whether the strings are equal ignoring ASCII case
+    */
+    bool equalIgnoreCase(std::string_view lhs, std::string_view rhs) {
+
+        return lhs.size() == rhs.size() && std::equal(lhs.cbegin(), lhs.cend(), rhs.cbegin(), [](char l, char r) {
+            return std::tolower(static_cast<unsigned char>(l)) == std::tolower(static_cast<unsigned char>(r));
+        });
+    }
+}
+
+/*
+    Match a path against a glob
+
+    @param[in] glob Glob pattern
+    @param[in] path Path
+    @return Whether the whole path matches
+*/
+bool globMatch(std::string_view glob, std::string_view path) {
+
+    while (!glob.empty()) {
+        if (glob.compare(0, "**"sv.size(), "**"sv) == 0) {
+            glob.remove_prefix("**"sv.size());
+            if (!glob.empty() && glob[0] == '/') {
+                // zero or more directories
+                glob.remove_prefix("/"sv.size());
+                std::size_t position = 0;
+                while (!globMatch(glob, path.substr(position))) {
+                    position = path.find('/', position);
+                    if (position == path.npos)
+                        return false;
+                    ++position;
+                }
+                return true;
+            }
+            for (std::size_t position = 0; position <= path.size(); ++position) {
+                if (globMatch(glob, path.substr(position)))
+                    return true;
+            }
+            return false;
+        } else if (glob[0] == '*') {
+            glob.remove_prefix("*"sv.size());
+            for (std::size_t position = 0; position <= path.size(); ++position) {
+                if (globMatch(glob, path.substr(position)))
+                    return true;
+                if (position < path.size() && path[position] == '/')
+                    break;
+            }
+            return false;
+        } else if (glob[0] == '?') {
+            if (path.empty() || path[0] == '/')
+                return false;
+        } else if (path.empty() || glob[0] != path[0]) {
+            return false;
+        }
+        glob.remove_prefix(1);
+        path.remove_prefix(1);
+    }
+
+    return path.empty();
+}
+
+/*
+    @param[in] includes Filename globs of units to include
+    @param[in] excludes Filename globs of units to exclude
+    @param[in] languages Languages of units to include, case insensitive
+*/
+UnitFilter::UnitFilter(const std::vector<std::string>& includes, const std::vector<std::string>& excludes,
+                       const std::vector<std::string>& languages)
+    : includes(includes), excludes(excludes), languages(languages) {}
+
+/*
+    @param[in] filename Unit filename attribute
+    @param[in] language Unit language attribute
+    @return Whether the unit is selected
+*/
+bool UnitFilter::selected(std::string_view filename, std::string_view language) const {
+
+    if (!selectedLanguage(language))
+        return false;
+
+    if (!includes.empty() && std::none_of(includes.cbegin(), includes.cend(), [&](const std::string& glob) {
+            return globMatch(glob, filename);
+        }))
+        return false;
+
+    return std::none_of(excludes.cbegin(), excludes.cend(), [&](const std::string& glob) {
+        return globMatch(glob, filename);
+    });
+}
+
+/*
+    @param[in] language Unit language attribute
+    @return Whether a unit of this language can be selected
+*/
+bool UnitFilter::selectedLanguage(std::string_view language) const {
+
+    return languages.empty() || std::any_of(languages.cbegin(), languages.cend(), [&](const std::string& selected) {
+        return equalIgnoreCase(selected, language);
+    });
+}
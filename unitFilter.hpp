@@ -0,0 +1,71 @@
+/*
+    unitFilter.hpp
+
+    Selection of the child units of a srcML archive by the filename and
+    language attributes of the unit start tag.
+
+    Filename globs:
+    * '*' matches any characters except '/'
+    * '**' matches any characters, and '**' followed by '/' matches zero or
+      more directories
+    * '?' matches any one character except '/'
+
+    A unit is selected when its filename matches an include glob, or there
+    are no include globs, its filename matches no exclude glob, and its
+    language is one of the languages, or there are no languages.
+*/
+
+#ifndef INCLUDED_UNITFILTER_HPP
+#define INCLUDED_UNITFILTER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+    Match a path against a glob
+
+    @param[in] glob Glob pattern
+    @param[in] path Path
+    @return Whether the whole path matches
+*/
+[[nodiscard]] bool globMatch(std::string_view glob, std::string_view path);
+
+class UnitFilter {
+public:
+
+    /*
+        @param[in] includes Filename globs of units to include
+        @param[in] excludes Filename globs of units to exclude
+        @param[in] languages Languages of units to include, case insensitive
+    */
+    UnitFilter(const std::vector<std::string>& includes, const std::vector<std::string>& excludes,
+               const std::vector<std::string>& languages);
+
+    /*
+        @return Whether all units are selected
+    */
+    [[nodiscard]] bool empty() const {
+        return includes.empty() && excludes.empty() && languages.empty();
+    }
+
+    /*
+        @param[in] filename Unit filename attribute
+        @param[in] language Unit language attribute
+        @return Whether the unit is selected
+    */
+    [[nodiscard]] bool selected(std::string_view filename, std::string_view language) const;
+
+    /*
+        @param[in] language Unit language attribute
+        @return Whether a unit of this language can be selected
+    */
+    [[nodiscard]] bool selectedLanguage(std::string_view language) const;
+
+private:
+    std::vector<std::string> includes;
+    std::vector<std::string> excludes;
+    std::vector<std::string> languages;
+};
+
+#endif
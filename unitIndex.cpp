@@ -0,0 +1,195 @@
+/*
+    unitIndex.cpp
+
+    Index of the child units of an uncompressed srcML archive file.
+*/
+
+#include "unitIndex.hpp"
+#include "binaryIO.hpp"
+#include "hashBytes.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// provides literal string operator""sv
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+    constexpr auto MAGIC = "SRCFACTS-INDEX\n"sv;
+    const std::uint64_t VERSION = 1;
+
+    // bytes hashed at each end of the archive file
+    const long SAMPLE_SIZE = 64 * 1024;
+}
+
+/*
+    Identity of an open regular file
+
+    @param[in] fd File descriptor
+    @param[out] stamp Size, modification time, and sample hash of the file
+    @return Whether the file is a regular file that was read
+*/
+bool fileStamp(int fd, FileStamp& stamp) {
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+        return false;
+    stamp.size = status.st_size;
+    stamp.modified = status.st_mtime;
+
+    // hash the start and the end of the file, without changing the file offset
+    std::string sample(std::min(stamp.size, 2 * SAMPLE_SIZE), ' ');
+    const long headSize = std::min(stamp.size, SAMPLE_SIZE);
+    const long tailSize = static_cast<long>(sample.size()) - headSize;
+    if (pread(fd, sample.data(), headSize, 0) != headSize ||
+        pread(fd, sample.data() + headSize, tailSize, stamp.size - tailSize) != tailSize)
+        return false;
+    stamp.sampleHash = hashBytes(sample);
+
+    return true;
+}
+
+/*
+    Add a child unit
+
+    @param[in] offset Byte offset of the unit start tag
+    @param[in] length Length through the unit end tag
+    @param[in] filename Unit filename attribute
+    @param[in] language Unit language attribute
+    @param[in] hash Unit hash attribute
+*/
+void UnitIndex::add(long offset, long length, std::string_view filename, std::string_view language, std::string_view hash) {
+
+    // few languages, so a linear search
+    const auto found = std::find(languageNames.cbegin(), languageNames.cend(), language);
+    const int languageIndex = static_cast<int>(std::distance(languageNames.cbegin(), found));
+    if (found == languageNames.cend())
+        languageNames.emplace_back(language);
+
+    units.push_back({ offset, length, hashBytes(filename), languageIndex, std::string(hash) });
+}
+
+/*
+    Save the index of an archive file
+
+    @param[in] path Index filename
+    @param[in] stamp Identity of the archive file
+    @return Whether the index was saved
+*/
+bool UnitIndex::save(const std::string& path, const FileStamp& stamp) const {
+
+    std::ostringstream contents;
+    contents.write(MAGIC.data(), MAGIC.size());
+    writeInteger(contents, VERSION);
+    writeInteger(contents, stamp.size);
+    writeInteger(contents, stamp.modified);
+    writeInteger(contents, stamp.sampleHash);
+    writeString(contents, rootName);
+    writeInteger(contents, rootAttributes.size());
+    for (const auto& [name, value] : rootAttributes) {
+        writeString(contents, name);
+        writeString(contents, value);
+    }
+    writeFacts(contents, rootFacts);
+    writeInteger(contents, languageNames.size());
+    for (const auto& language : languageNames)
+        writeString(contents, language);
+    writeInteger(contents, units.size());
+    for (const auto& unit : units) {
+        writeInteger(contents, unit.offset);
+        writeInteger(contents, unit.length);
+        writeInteger(contents, unit.filenameHash);
+        writeInteger(contents, unit.language);
+        writeString(contents, unit.hash);
+    }
+    const std::string data(contents.str());
+
+    // write to a temporary file so an interrupted save does not leave a partial index
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), data.size());
+        writeInteger(out, hashBytes(data));
+        if (!out)
+            return false;
+    }
+
+    return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
+
+/*
+    Load the index of an archive file
+
+    @param[in] path Index filename
+    @param[in] stamp Identity of the archive file
+    @return Whether a valid index of this archive file was loaded
+    @retval false Missing, invalid, or stale index
+*/
+bool UnitIndex::load(const std::string& path, const FileStamp& stamp) {
+
+    std::string data;
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            return false;
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // checksum of the index contents
+    if (data.size() < MAGIC.size() + sizeof(std::uint64_t))
+        return false;
+    std::istringstream checksumIn(data.substr(data.size() - sizeof(std::uint64_t)));
+    std::uint64_t checksum = 0;
+    data.resize(data.size() - sizeof(std::uint64_t));
+    if (!readInteger(checksumIn, checksum) || checksum != hashBytes(data))
+        return false;
+
+    std::istringstream in(data);
+    std::string magic(MAGIC.size(), ' ');
+    std::uint64_t version = 0;
+    FileStamp indexedStamp;
+    if (!in.read(magic.data(), magic.size()) || magic != MAGIC || !readInteger(in, version) || version != VERSION ||
+        !readInteger(in, indexedStamp.size) || !readInteger(in, indexedStamp.modified) || !readInteger(in, indexedStamp.sampleHash))
+        return false;
+    if (!(indexedStamp == stamp))
+        return false;
+
+    std::uint64_t attributeCount = 0;
+    if (!readString(in, rootName) || !readInteger(in, attributeCount) || attributeCount > 1024)
+        return false;
+    rootAttributes.resize(attributeCount);
+    for (auto& [name, value] : rootAttributes) {
+        if (!readString(in, name) || !readString(in, value))
+            return false;
+    }
+    std::uint64_t languageCount = 0;
+    if (!readFacts(in, rootFacts) || !readInteger(in, languageCount))
+        return false;
+    languageNames.resize(languageCount);
+    for (auto& language : languageNames) {
+        if (!readString(in, language))
+            return false;
+    }
+
+    std::uint64_t unitCount = 0;
+    if (!readInteger(in, unitCount))
+        return false;
+    units.resize(unitCount);
+    for (auto& unit : units) {
+        long language = 0;
+        if (!readInteger(in, unit.offset) || !readInteger(in, unit.length) || !readInteger(in, unit.filenameHash) ||
+            !readInteger(in, language) || !readString(in, unit.hash))
+            return false;
+        if (unit.offset < 0 || unit.length <= 0 || unit.offset + unit.length > stamp.size ||
+            language < 0 || language >= static_cast<long>(languageNames.size()))
+            return false;
+        unit.language = static_cast<int>(language);
+    }
+
+    return true;
+}
@@ -0,0 +1,115 @@
+/*
+    unitIndex.hpp
+
+    Index of the child units of an uncompressed srcML archive file, with
+    one entry per unit: byte offset, length, filename hash, language, and
+    unit hash attribute. With the index, the units of the mapped file can
+    be parsed directly, in any order or split across threads, without
+    scanning for unit boundaries.
+
+    The index records the size, modification time, and a checksum of
+    samples of the archive file, and a checksum of the index itself, so an
+    index of another or a changed file is not used.
+*/
+
+#ifndef INCLUDED_UNITINDEX_HPP
+#define INCLUDED_UNITINDEX_HPP
+
+#include "facts.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// identity of an archive file
+struct FileStamp {
+    long size = 0;
+    long modified = 0;
+    // hash of the start and end of the file
+    std::uint64_t sampleHash = 0;
+
+    bool operator==(const FileStamp& other) const {
+        return size == other.size && modified == other.modified && sampleHash == other.sampleHash;
+    }
+};
+
+/*
+    Identity of an open regular file
+
+    @param[in] fd File descriptor
+    @param[out] stamp Size, modification time, and sample hash of the file
+    @return Whether the file is a regular file that was read
+*/
+[[nodiscard]] bool fileStamp(int fd, FileStamp& stamp);
+
+class UnitIndex {
+public:
+
+    struct Entry {
+        // byte offset of the unit start tag, and length through the unit end tag
+        long offset = 0;
+        long length = 0;
+        std::uint64_t filenameHash = 0;
+        // index into languages()
+        int language = 0;
+        std::string hash;
+    };
+
+    /*
+        Add a child unit
+
+        @param[in] offset Byte offset of the unit start tag
+        @param[in] length Length through the unit end tag
+        @param[in] filename Unit filename attribute
+        @param[in] language Unit language attribute
+        @param[in] hash Unit hash attribute
+    */
+    void add(long offset, long length, std::string_view filename, std::string_view language, std::string_view hash);
+
+    /*
+        Save the index of an archive file
+
+        @param[in] path Index filename
+        @param[in] stamp Identity of the archive file
+        @return Whether the index was saved
+    */
+    [[nodiscard]] bool save(const std::string& path, const FileStamp& stamp) const;
+
+    /*
+        Load the index of an archive file
+
+        @param[in] path Index filename
+        @param[in] stamp Identity of the archive file
+        @return Whether a valid index of this archive file was loaded
+        @retval false Missing, invalid, or stale index
+    */
+    [[nodiscard]] bool load(const std::string& path, const FileStamp& stamp);
+
+    /*
+        @return Units in archive order
+    */
+    [[nodiscard]] const std::vector<Entry>& entries() const {
+        return units;
+    }
+
+    /*
+        @return Languages of the units
+    */
+    [[nodiscard]] const std::vector<std::string>& languages() const {
+        return languageNames;
+    }
+
+    // start tag of the root unit, replayed before parsing units so that paths from the root match
+    std::string rootName;
+    std::vector<std::pair<std::string, std::string>> rootAttributes;
+
+    // facts of the archive outside the child units, i.e., the root unit and text between units
+    Facts rootFacts;
+
+private:
+    std::vector<Entry> units;
+    std::vector<std::string> languageNames;
+};
+
+#endif
@@ -0,0 +1,106 @@
+/*
+    unitSample.cpp
+
+    Random sample of the child units of a srcML archive for approximate
+    facts.
+*/
+
+#include "unitSample.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+    // normal quantile of a two-sided 95% confidence interval
+    const double Z_95 = 1.959964;
+
+    /*
+        Mix the bits of a value, from splitmix64
+
+        @param[in] value Value
+        @return Hash of the value
+    */
+    std::uint64_t mix(std::uint64_t value) {
+
+        value += 0x9e3779b97f4a7c15;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+        return value ^ (value >> 31);
+    }
+}
+
+/*
+    @param[in] fraction Expected fraction of the units in the sample, 0 to 1
+    @param[in] seed Seed of the selection
+*/
+UnitSample::UnitSample(double fraction, std::uint64_t seed)
+    : threshold(fraction >= 1 ? std::numeric_limits<std::uint64_t>::max()
+                              : static_cast<std::uint64_t>(fraction * 18446744073709551616.0)),
+      seed(mix(seed)) {
+}
+
+/*
+    @param[in] unitNumber Position of the child unit in the archive
+    @return Whether the unit is in the sample
+*/
+bool UnitSample::selected(long unitNumber) const {
+
+    return mix(seed ^ static_cast<std::uint64_t>(unitNumber)) <= threshold;
+}
+
+/*
+    Add a sampled unit
+
+    @param[in] unitFacts Facts of the unit
+*/
+void UnitSample::add(const Facts& unitFacts) {
+
+    ++sampledUnits;
+    facts += unitFacts;
+    for (int column = 0; column < MEASURE_COUNT; ++column) {
+        const double value = static_cast<double>(unitFacts.*MEASURE_COLUMNS[column].member);
+        squares[column] += value * value;
+    }
+}
+
+/*
+    Combine with a sample of other units of the same archive
+
+    @param[in] other Sample of other units
+    @return This sample
+*/
+UnitSample& UnitSample::operator+=(const UnitSample& other) {
+
+    sampledUnits += other.sampledUnits;
+    skippedUnits += other.skippedUnits;
+    facts += other.facts;
+    for (int column = 0; column < MEASURE_COUNT; ++column)
+        squares[column] += other.squares[column];
+
+    return *this;
+}
+
+/*
+    Estimate of a measure over all the units, without the facts outside the units
+
+    @param[in] column Measure column
+    @return Estimate of the total of the measure
+*/
+Estimate UnitSample::estimate(int column) const {
+
+    if (sampledUnits == 0)
+        return Estimate();
+
+    // total is the population times the sample mean, with the variance of a sample without replacement
+    const double n = static_cast<double>(sampledUnits);
+    const double N = static_cast<double>(population());
+    const double sum = static_cast<double>(facts.*MEASURE_COLUMNS[column].member);
+    const double mean = sum / n;
+    const double variance = sampledUnits > 1 ? std::max(0.0, (squares[column] - sum * mean) / (n - 1)) : 0.0;
+    Estimate estimate;
+    estimate.value = N * mean;
+    estimate.margin = Z_95 * N * std::sqrt((1 - n / N) * variance / n);
+
+    return estimate;
+}
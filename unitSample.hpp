@@ -0,0 +1,106 @@
+/*
+    unitSample.hpp
+
+    Random sample of the child units of a srcML archive for approximate
+    facts. Whether a unit is in the sample depends only on the seed and the
+    position of the unit in the archive, so it is decided at the unit start
+    tag, or before reading the unit when there is a unit index, and the same
+    units are sampled in every run with the same seed.
+
+    Each measure of the whole archive is estimated from the mean over the
+    sampled units, with a 95% confidence interval from the variance over
+    the sampled units, including the finite population correction. Facts
+    outside the child units are always collected, so are exact.
+*/
+
+#ifndef INCLUDED_UNITSAMPLE_HPP
+#define INCLUDED_UNITSAMPLE_HPP
+
+#include "facts.hpp"
+#include "factStore.hpp"
+#include <cstdint>
+
+// estimate of a measure
+struct Estimate {
+    double value = 0;
+    // half-width of the 95% confidence interval
+    double margin = 0;
+};
+
+class UnitSample {
+public:
+
+    /*
+        @param[in] fraction Expected fraction of the units in the sample, 0 to 1
+        @param[in] seed Seed of the selection
+    */
+    UnitSample(double fraction, std::uint64_t seed);
+
+    /*
+        @param[in] unitNumber Position of the child unit in the archive
+        @return Whether the unit is in the sample
+    */
+    [[nodiscard]] bool selected(long unitNumber) const;
+
+    /*
+        Add a sampled unit
+
+        @param[in] unitFacts Facts of the unit
+    */
+    void add(const Facts& unitFacts);
+
+    /*
+        Count a unit that is not in the sample
+    */
+    void skip() {
+        ++skippedUnits;
+    }
+
+    /*
+        Combine with a sample of other units of the same archive
+
+        @param[in] other Sample of other units
+        @return This sample
+    */
+    UnitSample& operator+=(const UnitSample& other);
+
+    /*
+        @return Number of sampled units
+    */
+    [[nodiscard]] long size() const {
+        return sampledUnits;
+    }
+
+    /*
+        @return Number of units, sampled or not
+    */
+    [[nodiscard]] long population() const {
+        return sampledUnits + skippedUnits;
+    }
+
+    /*
+        @return Facts of the sampled units
+    */
+    [[nodiscard]] const Facts& sampledFacts() const {
+        return facts;
+    }
+
+    /*
+        Estimate of a measure over all the units, without the facts outside the units
+
+        @param[in] column Measure column
+        @return Estimate of the total of the measure
+    */
+    [[nodiscard]] Estimate estimate(int column) const;
+
+private:
+    std::uint64_t threshold;
+    std::uint64_t seed;
+    long sampledUnits = 0;
+    long skippedUnits = 0;
+    Facts facts;
+    // sum of the squares of each measure of the sampled units
+    double squares[MEASURE_COUNT] = {};
+};
+
+#endif